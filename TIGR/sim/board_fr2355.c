@@ -0,0 +1,138 @@
+// board_fr2355.c
+// MSP430FR2355 LaunchPad model for the TIGR host simulator
+//
+// MCLK = DCOCLKDIV / DIVM, SMCLK = MCLK / DIVS, DCOCLKDIV = 32768 Hz x
+// (FLLN + 1) with the FLL taken as locked (reset: 1 MHz)
+// Current: 142 uA/MHz active from FRAM, 1.4 uA in LPM3 (datasheet typicals)
+// Vectors: TIMER0_B0 (software RTC tick) > TIMER3_B0 (band holdoff) >
+//          PORT2 (detector bands) > PORT3 (card detect)
+// Bands: 4 = P2.1, 3 = P2.2, 2 = P2.3, 1 = P2.4
+// SD card: eUSCI_B0 SPI, CS = P1.0 (shared with LED1), card detect = P3.7
+
+#include "msp430.h"
+#include "sim.h"
+#include "sim_hal.h"
+
+extern void ISRP2(void);
+extern void Card_Detect_ISR(void);
+extern void Timer_B0_ISR(void);
+extern void Holdoff_ISR(void);
+
+#define TLV_CAL_30C     2000            // CALADC_15V_30C
+#define TLV_CAL_85C     2400            // CALADC_15V_85C
+
+const char* sim_board_name = "MSP430FR2355";
+const double sim_board_active_ua_mhz = 142.0;
+const double sim_board_sleep_ua = 1.4;
+
+static unsigned char tb0_ccifg = 0;
+static unsigned long long tb0_next_aclk = 0;
+
+// Timer_B0 CCR0 in up mode from ACLK
+static void tb0_tick(void* arg) {
+    unsigned long period = sim_reg_TB0CCR0 + 1;
+
+    (void)arg;
+    if ((sim_reg_TB0CTL & 0x0030) == MC__UP && (sim_reg_TB0CCTL0 & CCIE)) {
+        tb0_ccifg = 1;
+    }
+    if (period < 2) {
+        period = 328;                   // Not configured yet: poll at ~10 ms
+    }
+    tb0_next_aclk += period;
+    sim_schedule((tb0_next_aclk * SIM_TICK_HZ) / SIM_ACLK_HZ, tb0_tick, 0);
+}
+
+void sim_board_reset(void) {
+    sim_reg_CSCTL1 = DCORSEL_1;
+    sim_reg_CSCTL2 = FLLD_1 | 31;
+    sim_reg_P3IN = BIT7;                // No card until one is inserted
+    tb0_ccifg = 0;
+    tb0_next_aclk = 328;
+    sim_schedule((tb0_next_aclk * SIM_TICK_HZ) / SIM_ACLK_HZ, tb0_tick, 0);
+}
+
+unsigned long sim_board_mclk_hz(void) {
+    unsigned long dcoclkdiv = SIM_ACLK_HZ * ((sim_reg_CSCTL2 & FLLN) + 1);
+
+    return dcoclkdiv >> (sim_reg_CSCTL5 & DIVM);
+}
+
+unsigned long sim_board_smclk_hz(void) {
+    return sim_board_mclk_hz() >> ((sim_reg_CSCTL5 & DIVS) >> 4);
+}
+
+sim_vector_t sim_board_pending(void) {
+    if (tb0_ccifg) {
+        tb0_ccifg = 0;                  // CCR0 flag clears when serviced
+        return Timer_B0_ISR;
+    }
+    if ((sim_reg_TB3CCTL0 & CCIE) && (sim_reg_TB3CCTL0 & CCIFG)) {
+        sim_reg_TB3CCTL0 &= ~CCIFG;     // CCR0 flag clears when serviced
+        return Holdoff_ISR;
+    }
+    if (sim_reg_P2IFG & sim_reg_P2IE & 0xFF) {
+        return ISRP2;
+    }
+    if (sim_reg_P3IFG & sim_reg_P3IE & 0xFF) {
+        return Card_Detect_ISR;
+    }
+    return 0;
+}
+
+sim_vector_t sim_board_port2_vector(void) {
+    return ISRP2;
+}
+
+unsigned int sim_board_band_bit(unsigned char band) {
+    return 1u << (5 - band);
+}
+
+int sim_board_cs_selected(void) {
+    return !(sim_reg_P1OUT & BIT0);
+}
+
+unsigned int sim_board_spi_divider(void) {
+    unsigned int br = sim_reg_UCB0BRW & 0xFFFF;
+    return br ? br : 1;
+}
+
+// A12 = temperature sensor (1.5 V ref), A13 = 1.5 V ref against AVCC
+unsigned int sim_board_adc(unsigned int channel) {
+    long value;
+
+    if (channel == 12) {
+        value = TLV_CAL_30C + ((long)sim_temperature_c - 30) * (TLV_CAL_85C - TLV_CAL_30C) / 55;
+    } else if (channel == 13) {
+        value = (1500L * 4096L) / (long)(sim_avcc_mv ? sim_avcc_mv : 1);
+    } else {
+        value = 0;
+    }
+    if (value < 0) value = 0;
+    if (value > 4095) value = 4095;
+    return (unsigned int)value;
+}
+
+// Card-detect switch closes to ground with a card inserted (P3.7); the
+// edge selected in P3IES sets the flag
+void sim_board_card_detect(int inserted) {
+    unsigned int was = sim_reg_P3IN & BIT7;
+
+    if (inserted) {
+        sim_reg_P3IN &= ~BIT7;
+    } else {
+        sim_reg_P3IN |= BIT7;
+    }
+    if (was != (sim_reg_P3IN & BIT7) && !(sim_reg_P3IES & BIT7) == !inserted) {
+        sim_reg_P3IFG |= BIT7;
+    }
+    sim_service();
+}
+
+unsigned int sim_tlv_word(unsigned int address) {
+    switch (address) {
+        case 0x1A1A: return TLV_CAL_30C;
+        case 0x1A1C: return TLV_CAL_85C;
+        default:     return 0xFFFF;
+    }
+}
@@ -0,0 +1,206 @@
+// board_fr6989.c
+// MSP430FR6989 LaunchPad model for the TIGR host simulator
+//
+// MCLK = DCO / DIVM, SMCLK = DCO / DIVS, DCO from DCORSEL/DCOFSEL
+// (reset: 8 MHz DCO, MCLK = SMCLK = 1 MHz)
+// Current: 100 uA/MHz active from FRAM, 0.9 uA in LPM3 (datasheet typicals)
+// Vectors: TIMER0_A0 (band holdoff) > USCI_A1 > PORT1 (card detect) >
+//          PORT2 (detector bands) > RTC
+// Bands: 4 = P2.4, 3 = P2.3, 2 = P2.2, 1 = P2.1
+// SD card: eUSCI_B0 SPI, CS = P1.3, card detect = P1.5
+// RTC_C calendar in BCD, ready interrupt once per second
+
+#include "msp430.h"
+#include "sim.h"
+#include "sim_hal.h"
+
+extern void ISRP2(void);
+extern void Card_Detect_ISR(void);
+extern void RTC_ISR(void);
+extern void USCI_A1_ISR(void);
+extern void Holdoff_ISR(void);
+
+#define TLV_CAL_30C     2400            // CAL_ADC_12T30 (1.2 V ref)
+#define TLV_CAL_85C     2900            // CAL_ADC_12T85
+
+const char* sim_board_name = "MSP430FR6989";
+const double sim_board_active_ua_mhz = 100.0;
+const double sim_board_sleep_ua = 0.9;
+
+// DCO frequency in kHz by DCOFSEL, low and high range (DCORSEL)
+static const unsigned int dco_khz[2][8] = {
+    { 1000, 2670, 3330, 4000, 5330, 6670, 8000, 8000 },
+    { 1000, 5330, 6670, 8000, 16000, 21000, 24000, 24000 },
+};
+
+static unsigned long long rtc_next_aclk = 0;
+
+static unsigned int bcd_inc(unsigned int bcd) {
+    bcd++;
+    if ((bcd & 0x0F) > 9) {
+        bcd += 6;
+    }
+    if ((bcd & 0xF0) > 0x90) {
+        bcd += 0x60;
+    }
+    if ((bcd & 0xF00) > 0x900) {
+        bcd += 0x600;
+    }
+    return bcd;
+}
+
+static unsigned int days_in_month(unsigned int month_bcd, unsigned int year_bcd) {
+    static const unsigned char days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    unsigned int month = (month_bcd >> 4) * 10 + (month_bcd & 0xF);
+    unsigned int year = ((year_bcd >> 12) & 0xF) * 1000 + ((year_bcd >> 8) & 0xF) * 100 +
+                        ((year_bcd >> 4) & 0xF) * 10 + (year_bcd & 0xF);
+
+    if (month < 1 || month > 12) {
+        return 31;
+    }
+    if (month == 2 && ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0)) {
+        return 29;
+    }
+    return days[month - 1];
+}
+
+static void rtc_second(void* arg) {
+    unsigned int day;
+
+    (void)arg;
+    if (!(sim_reg_RTCCTL13 & RTCHOLD)) {
+        sim_reg_RTCSEC = bcd_inc(sim_reg_RTCSEC);
+        if (sim_reg_RTCSEC >= 0x60) {
+            sim_reg_RTCSEC = 0;
+            sim_reg_RTCMIN = bcd_inc(sim_reg_RTCMIN);
+        }
+        if (sim_reg_RTCMIN >= 0x60) {
+            sim_reg_RTCMIN = 0;
+            sim_reg_RTCHOUR = bcd_inc(sim_reg_RTCHOUR);
+        }
+        if (sim_reg_RTCHOUR >= 0x24) {
+            sim_reg_RTCHOUR = 0;
+            sim_reg_RTCDOW = (sim_reg_RTCDOW + 1) % 7;
+            sim_reg_RTCDAY = bcd_inc(sim_reg_RTCDAY);
+        }
+        day = (sim_reg_RTCDAY >> 4) * 10 + (sim_reg_RTCDAY & 0xF);
+        if (day > days_in_month(sim_reg_RTCMON, sim_reg_RTCYEAR)) {
+            sim_reg_RTCDAY = 1;
+            sim_reg_RTCMON = bcd_inc(sim_reg_RTCMON);
+        }
+        if (sim_reg_RTCMON > 0x12) {
+            sim_reg_RTCMON = 1;
+            sim_reg_RTCYEAR = bcd_inc(sim_reg_RTCYEAR);
+        }
+        sim_reg_RTCCTL0 |= RTCRDYIFG;   // Firmware may poll it before RTC_ISR runs
+    }
+    rtc_next_aclk += SIM_ACLK_HZ;
+    sim_schedule((rtc_next_aclk * SIM_TICK_HZ) / SIM_ACLK_HZ, rtc_second, 0);
+}
+
+void sim_board_reset(void) {
+    sim_reg_CSCTL1 = DCOFSEL_6;
+    sim_reg_CSCTL2 = SELS__DCOCLK | SELM__DCOCLK;
+    sim_reg_CSCTL3 = DIVS__8 | DIVM__8;
+    sim_reg_P1IN = BIT5;                // No card until one is inserted
+    rtc_next_aclk = SIM_ACLK_HZ;
+    sim_schedule((rtc_next_aclk * SIM_TICK_HZ) / SIM_ACLK_HZ, rtc_second, 0);
+}
+
+static unsigned long dco_hz(void) {
+    return 1000UL * dco_khz[(sim_reg_CSCTL1 & DCORSEL) ? 1 : 0][(sim_reg_CSCTL1 & DCOFSEL) >> 1];
+}
+
+unsigned long sim_board_mclk_hz(void) {
+    return dco_hz() >> (sim_reg_CSCTL3 & DIVM);
+}
+
+unsigned long sim_board_smclk_hz(void) {
+    return dco_hz() >> ((sim_reg_CSCTL3 & DIVS) >> 4);
+}
+
+unsigned int sim_rtc_iv(void) {
+    sim_advance(1);
+    if ((sim_reg_RTCCTL0 & RTCRDYIFG) && (sim_reg_RTCCTL0 & RTCRDYIE)) {
+        sim_reg_RTCCTL0 &= ~RTCRDYIFG;
+        return RTCIV__RTCRDYIFG;
+    }
+    return RTCIV__NONE;
+}
+
+sim_vector_t sim_board_pending(void) {
+    if ((sim_reg_TA0CCTL0 & CCIE) && (sim_reg_TA0CCTL0 & CCIFG)) {
+        sim_reg_TA0CCTL0 &= ~CCIFG;     // CCR0 flag clears when serviced
+        return Holdoff_ISR;
+    }
+    if (sim_reg_UCA1IFG & sim_reg_UCA1IE & (UCRXIFG | UCTXIFG)) {
+        return USCI_A1_ISR;
+    }
+    if (sim_reg_P1IFG & sim_reg_P1IE & 0xFF) {
+        return Card_Detect_ISR;
+    }
+    if (sim_reg_P2IFG & sim_reg_P2IE & 0xFF) {
+        return ISRP2;
+    }
+    if ((sim_reg_RTCCTL0 & RTCRDYIFG) && (sim_reg_RTCCTL0 & RTCRDYIE)) {
+        return RTC_ISR;
+    }
+    return 0;
+}
+
+sim_vector_t sim_board_port2_vector(void) {
+    return ISRP2;
+}
+
+unsigned int sim_board_band_bit(unsigned char band) {
+    return 1u << band;
+}
+
+int sim_board_cs_selected(void) {
+    return !(sim_reg_P1OUT & BIT3);
+}
+
+unsigned int sim_board_spi_divider(void) {
+    unsigned int br = sim_reg_UCB0BRW & 0xFFFF;
+    return br ? br : 1;
+}
+
+// A30 = temperature sensor (1.2 V ref), A31 = AVCC/2 (2.0 V ref)
+unsigned int sim_board_adc(unsigned int channel) {
+    long value;
+
+    if (channel == 30) {
+        value = TLV_CAL_30C + ((long)sim_temperature_c - 30) * (TLV_CAL_85C - TLV_CAL_30C) / 55;
+    } else if (channel == 31) {
+        value = ((long)sim_avcc_mv * 4096L) / 4000L;
+    } else {
+        value = 0;
+    }
+    if (value < 0) value = 0;
+    if (value > 4095) value = 4095;
+    return (unsigned int)value;
+}
+
+// Card-detect switch closes to ground with a card inserted (P1.5); the
+// edge selected in P1IES sets the flag
+void sim_board_card_detect(int inserted) {
+    unsigned int was = sim_reg_P1IN & BIT5;
+
+    if (inserted) {
+        sim_reg_P1IN &= ~BIT5;
+    } else {
+        sim_reg_P1IN |= BIT5;
+    }
+    if (was != (sim_reg_P1IN & BIT5) && !(sim_reg_P1IES & BIT5) == !inserted) {
+        sim_reg_P1IFG |= BIT5;
+    }
+    sim_service();
+}
+
+unsigned int sim_tlv_word(unsigned int address) {
+    switch (address) {
+        case 0x1A1A: return TLV_CAL_30C;
+        case 0x1A1C: return TLV_CAL_85C;
+        default:     return 0xFFFF;
+    }
+}
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""
+TIGR Clock Scaling Energy Report
+Builds each board with the clock manager in its three modes and runs the
+same Poisson load with an emulated consumer card, then prints the supply
+current and the energy per flushed sector (CPU and card while the card is
+clocked, see sim.h) next to the dead-time figures.
+
+    scaled   idle clock for interrupts, boost for flushes (default build)
+    idle     everything at the idle clock (-DCLOCK_BOOST_ENABLE=0)
+    boost    everything at the boost clock (-DCLOCK_IDLE_DIV=1)
+
+Usage:
+    python3 clock_energy.py                  # 20 Hz for 60 s
+    python3 clock_energy.py --rate 200 --seconds 30
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+from stress_bench import HERE, SIM_COLUMNS
+
+MODES = (("scaled", ""), ("idle", "-DCLOCK_BOOST_ENABLE=0"), ("boost", "-DCLOCK_IDLE_DIV=1"))
+
+
+def build(board, mode, defs):
+    build_dir = os.path.join("build", "energy", mode)
+    result = subprocess.run(["make", "-s", "-C", HERE, f"BUILD={build_dir}", f"FW_DEFS={defs}",
+                             os.path.join(build_dir, f"tigr_sim_{board}")],
+                            capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.exit(f"build of {board} {mode} failed:\n{result.stderr}")
+    return os.path.join(HERE, build_dir, f"tigr_sim_{board}")
+
+
+def run(binary, rate, seconds):
+    with tempfile.TemporaryDirectory() as tmp:
+        out = subprocess.run([binary, "--report", "--rate", str(rate), "--seconds", str(seconds),
+                              "--seed", "1", "--sd-busy", "consumer",
+                              "--sd", os.path.join(tmp, "card.img")],
+                             check=True, capture_output=True, text=True).stdout
+    return dict(zip(SIM_COLUMNS, out.strip().splitlines()[-1].split(",")))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TIGR clock scaling energy report")
+    parser.add_argument('--rate', type=float, default=20.0, help="muon rate in Hz")
+    parser.add_argument('--seconds', type=float, default=60.0, help="measurement window")
+    args = parser.parse_args()
+
+    print(f"{'board':<8} {'mode':<7} {'sectors':>7} {'uJ/sector':>10} {'avg uA':>8} "
+          f"{'masked %':>9} {'latency us':>11}")
+    for board in ("fr2355", "fr6989"):
+        for mode, defs in MODES:
+            row = run(build(board, mode, defs), args.rate, args.seconds)
+            print(f"{board:<8} {mode:<7} {row['sectors']:>7} {float(row['sector_uj']):10.1f} "
+                  f"{float(row['avg_ua']):8.1f} {float(row['masked_pct']):9.3f} "
+                  f"{float(row['worst_latency_us']):11.1f}", flush=True)
+
+
+if __name__ == '__main__':
+    main()
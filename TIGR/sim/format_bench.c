@@ -0,0 +1,90 @@
+// format_bench.c
+// Host timing of the event-line formatter against the legacy one
+//
+// Linked with the host simulator's firmware objects and the reference
+// copy of the old formatter (isa/legacy_format.c), this formats the same
+// lines through format_event() and legacy_format_event() and prints the
+// host time per line of each. The ratio is only a lower bound for the
+// MSP430: the host divides by 10 with a multiply, where the MSP430 calls a
+// software division for every digit. The cycle counts come from the ISA
+// harness (make profile).
+//
+//   make format          both formatters, 1000000 lines each
+//   build/format_bench_fr6989 [LINES]
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tigr_config.h"
+#include "sd_utils.h"
+
+char* legacy_format_event(char* dst, unsigned int muon_number, unsigned char band,
+                          const RtcTime* time);
+
+typedef char* (*Formatter)(char* dst, unsigned int muon_number, unsigned char band,
+                           const RtcTime* time);
+
+// Two seconds before a year rollover, as in the ISA harness
+static const RtcTime sample_time = { 0x2025, 0x12, 0x31, 0x23, 0x59, 0x58 };
+
+static char line[64];
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Best of 20 passes, in ns per line. Muon numbers 10000-59999 keep the
+// legacy formatter on its five-digit (slowest) case.
+static double time_lines(Formatter format, unsigned long lines) {
+    double best = 0.0;
+    double start;
+    double ns;
+    unsigned long i;
+    int pass;
+
+    for (pass = 0; pass < 20; pass++) {
+        start = now_ns();
+        for (i = 0; i < lines; i++) {
+            format(line, 10000 + (unsigned int)(i % 50000), (unsigned char)(1 + (i & 3)),
+                   &sample_time);
+        }
+        ns = (now_ns() - start) / lines;
+        if (pass == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    unsigned long lines = argc > 1 ? strtoul(argv[1], 0, 0) : 1000000UL;
+    char expect[64];
+    double fast;
+    double legacy;
+
+    if (lines == 0) {
+        fprintf(stderr, "usage: %s [LINES]\n", argv[0]);
+        return 2;
+    }
+    // Both must write the same line
+    memset(expect, 0, sizeof(expect));
+    memset(line, 0, sizeof(line));
+    legacy_format_event(expect, 54321, 3, &sample_time);
+    format_event(line, 54321, 3, &sample_time);
+    if (memcmp(expect, line, sizeof(line)) != 0) {
+        fprintf(stderr, "formatters differ:\n%s%s", expect, line);
+        return 1;
+    }
+
+    fast = time_lines(format_event, lines);
+    legacy = time_lines(legacy_format_event, lines);
+    printf("format_event          %7.1f ns/line\n", fast);
+    printf("format_event(legacy)  %7.1f ns/line\n", legacy);
+    printf("host speedup          %7.1fx (MSP430: see make profile)\n", legacy / fast);
+    return 0;
+}
@@ -0,0 +1,411 @@
+// msp430.h
+// Host simulator stand-in for the TI device header
+//
+// Peripheral registers become accessor expressions into simulator storage
+// (see msp430_sim.c). Every access lets the simulator deliver pending
+// interrupts, the way the CPU would between instructions. Registers with
+// side effects (timer counters, ADC results, UART TX/IV, RTC IV, P2IV) map to
+// dedicated accessor functions. Bit definitions use the TI values.
+//
+// Select the device the same way the TI header does:
+//   -D__MSP430FR2355__  or  -D__MSP430FR6989__
+
+#ifndef _TIGR_SIM_MSP430_H
+#define _TIGR_SIM_MSP430_H
+
+#if !defined(__MSP430FR2355__) && !defined(__MSP430FR6989__)
+#error "Define __MSP430FR2355__ or __MSP430FR6989__ for the host simulator"
+#endif
+
+//-----------------------------------------------------------------------------
+// Register storage
+//-----------------------------------------------------------------------------
+#define SIM_REGISTERS(X) \
+    X(WDTCTL) X(PM5CTL0) X(SFRIFG1) X(SYSRSTIV) X(SYSCFG0) \
+    X(P1DIR) X(P1OUT) X(P1IN) X(P1REN) X(P1SEL0) X(P1SEL1) X(P1IE) X(P1IES) X(P1IFG) \
+    X(P2DIR) X(P2OUT) X(P2IN) X(P2REN) X(P2SEL0) X(P2SEL1) X(P2IE) X(P2IES) X(P2IFG) \
+    X(P3DIR) X(P3OUT) X(P3IN) X(P3REN) X(P3SEL0) X(P3SEL1) X(P3IE) X(P3IES) X(P3IFG) \
+    X(P4DIR) X(P4OUT) X(P4SEL0) X(P4SEL1) X(P6DIR) X(P6OUT) X(P9DIR) X(P9OUT) X(PJSEL0) \
+    X(TA0CTL) X(TA1CTL) X(TB0CTL) X(TB1CTL) X(TB0CCR0) X(TB0CCTL0) \
+    X(TA0CCR0) X(TA0CCTL0) X(TB3CTL) X(TB3CCR0) X(TB3CCTL0) \
+    X(UCA0CTLW0) X(UCA0BR0) X(UCA0BR1) X(UCA0MCTLW) X(UCA0IFG) X(UCA0IE) X(UCA0RXBUF) X(UCA0TXBUF) \
+    X(UCA1CTLW0) X(UCA1BRW) X(UCA1MCTLW) X(UCA1STATW) X(UCA1IFG) X(UCA1IE) X(UCA1RXBUF) \
+    X(UCB0CTLW0) X(UCB0BRW) X(UCB0IFG) X(UCB0RXBUF) X(UCB0TXBUF) \
+    X(CSCTL0) X(CSCTL1) X(CSCTL2) X(CSCTL3) X(CSCTL4) X(CSCTL5) X(CSCTL7) X(FRCTL0) \
+    X(PMMCTL0) X(PMMCTL2) X(REFCTL0) \
+    X(ADCCTL0) X(ADCCTL1) X(ADCCTL2) X(ADCMCTL0) X(ADCIE) \
+    X(ADC12CTL0) X(ADC12CTL1) X(ADC12CTL2) X(ADC12CTL3) X(ADC12MCTL0) X(ADC12MCTL1) X(ADC12IER0) \
+    X(RTCCTL0) X(RTCCTL13) X(RTCYEAR) X(RTCMON) X(RTCDAY) X(RTCDOW) X(RTCHOUR) X(RTCMIN) X(RTCSEC)
+
+#define SIM_DECLARE_REGISTER(name) extern volatile unsigned int sim_reg_##name;
+SIM_REGISTERS(SIM_DECLARE_REGISTER)
+#undef SIM_DECLARE_REGISTER
+
+// Simulator hooks behind the accessors
+volatile unsigned int* sim_io(volatile unsigned int* reg);
+volatile unsigned char* sim_io_byte(volatile unsigned int* reg, unsigned int high);
+volatile unsigned int* sim_io_status(volatile unsigned int* reg, unsigned int set, unsigned int clear);
+unsigned int sim_timer_count(volatile unsigned int* ctl);
+volatile unsigned int* sim_timer_ccr(volatile unsigned int* ccr, volatile unsigned int* ctl,
+                                     volatile unsigned int* cctl);
+unsigned int sim_adc_result(unsigned int channel);
+volatile unsigned int* sim_uart_txbuf(void);
+unsigned int sim_uart_iv(void);
+unsigned int sim_port2_iv(void);
+unsigned int sim_rtc_iv(void);
+
+#define SIM_IO(name)              (*sim_io(&sim_reg_##name))
+#define SIM_IO_L(name)            (*sim_io_byte(&sim_reg_##name, 0))
+#define SIM_IO_H(name)            (*sim_io_byte(&sim_reg_##name, 1))
+#define SIM_IO_READY(name, s, c)  (*sim_io_status(&sim_reg_##name, (s), (c)))
+
+//-----------------------------------------------------------------------------
+// Registers common to both devices
+//-----------------------------------------------------------------------------
+#define WDTCTL        SIM_IO(WDTCTL)
+#define PM5CTL0       SIM_IO(PM5CTL0)
+#define SFRIFG1       SIM_IO(SFRIFG1)
+#define SYSRSTIV      SIM_IO(SYSRSTIV)
+
+#define P1DIR         SIM_IO(P1DIR)
+#define P1OUT         SIM_IO(P1OUT)
+#define P1IN          SIM_IO(P1IN)
+#define P1REN         SIM_IO(P1REN)
+#define P1SEL0        SIM_IO(P1SEL0)
+#define P1SEL1        SIM_IO(P1SEL1)
+#define P1IE          SIM_IO(P1IE)
+#define P1IES         SIM_IO(P1IES)
+#define P1IFG         SIM_IO(P1IFG)
+#define P2DIR         SIM_IO(P2DIR)
+#define P2OUT         SIM_IO(P2OUT)
+#define P2IN          SIM_IO(P2IN)
+#define P2REN         SIM_IO(P2REN)
+#define P2SEL0        SIM_IO(P2SEL0)
+#define P2SEL1        SIM_IO(P2SEL1)
+#define P2IE          SIM_IO(P2IE)
+#define P2IES         SIM_IO(P2IES)
+#define P2IFG         SIM_IO(P2IFG)
+#define P2IV          sim_port2_iv()
+#define P2IV__NONE    (0x0000)
+#define P2IV__P2IFG0  (0x0002)
+#define P2IV__P2IFG1  (0x0004)
+#define P2IV__P2IFG2  (0x0006)
+#define P2IV__P2IFG3  (0x0008)
+#define P2IV__P2IFG4  (0x000A)
+#define P2IV__P2IFG5  (0x000C)
+#define P2IV__P2IFG6  (0x000E)
+#define P2IV__P2IFG7  (0x0010)
+#define P3DIR         SIM_IO(P3DIR)
+#define P3OUT         SIM_IO(P3OUT)
+#define P3IN          SIM_IO(P3IN)
+#define P3REN         SIM_IO(P3REN)
+#define P3SEL0        SIM_IO(P3SEL0)
+#define P3SEL1        SIM_IO(P3SEL1)
+#define P3IE          SIM_IO(P3IE)
+#define P3IES         SIM_IO(P3IES)
+#define P3IFG         SIM_IO(P3IFG)
+#define P4DIR         SIM_IO(P4DIR)
+#define P4OUT         SIM_IO(P4OUT)
+#define P4SEL0        SIM_IO(P4SEL0)
+#define P4SEL1        SIM_IO(P4SEL1)
+
+#define UCB0CTLW0     SIM_IO(UCB0CTLW0)
+#define UCB0BRW       SIM_IO(UCB0BRW)
+#define UCB0BR0       SIM_IO_L(UCB0BRW)
+#define UCB0BR1       SIM_IO_H(UCB0BRW)
+#define UCB0IFG       SIM_IO_READY(UCB0IFG, UCTXIFG | UCRXIFG, 0)
+#define UCB0RXBUF     SIM_IO(UCB0RXBUF)
+#define UCB0TXBUF     SIM_IO(UCB0TXBUF)
+
+#define BIT0          (0x0001)
+#define BIT1          (0x0002)
+#define BIT2          (0x0004)
+#define BIT3          (0x0008)
+#define BIT4          (0x0010)
+#define BIT5          (0x0020)
+#define BIT6          (0x0040)
+#define BIT7          (0x0080)
+#define BIT8          (0x0100)
+#define BIT9          (0x0200)
+#define BITA          (0x0400)
+#define BITB          (0x0800)
+#define BITC          (0x1000)
+#define BITD          (0x2000)
+#define BITE          (0x4000)
+#define BITF          (0x8000)
+
+#define GIE           (0x0008)
+#define CPUOFF        (0x0010)
+#define SCG0          (0x0040)
+#define SCG1          (0x0080)
+#define LPM3_bits     (SCG1 | SCG0 | CPUOFF)
+
+#define CSCTL0        SIM_IO(CSCTL0)
+#define CSCTL1        SIM_IO(CSCTL1)
+#define CSCTL2        SIM_IO(CSCTL2)
+#define CSCTL3        SIM_IO(CSCTL3)
+#define CSCTL4        SIM_IO(CSCTL4)
+#define CSCTL5        SIM_IO(CSCTL5)
+#define FRCTL0        SIM_IO(FRCTL0)
+#define FRCTLPW       (0xA500)
+#define NWAITS_0      (0x0000)
+#define NWAITS_1      (0x0010)
+#define NWAITS_2      (0x0020)
+#define DIVM          (0x0007)
+#define DIVM__1       (0x0000)
+#define DIVM__2       (0x0001)
+#define DIVM__4       (0x0002)
+#define DIVM__8       (0x0003)
+#define DIVM__16      (0x0004)
+#define DIVM__32      (0x0005)
+#define DIVS__1       (0x0000)
+#define DIVS__2       (0x0010)
+#define DIVS__4       (0x0020)
+#define DIVS__8       (0x0030)
+
+#define WDTPW         (0x5A00)
+#define WDTHOLD       (0x0080)
+#define WDTSSEL__ACLK (0x0020)
+#define WDTCNTCL      (0x0008)
+#define WDTIS__8192K  (0x0002)
+#define LOCKLPM5      (0x0001)
+
+// Timer_A / Timer_B
+#define TASSEL__ACLK   (0x0100)
+#define TBSSEL__ACLK   (0x0100)
+#define ID__1          (0x0000)
+#define ID__8          (0x00C0)
+#define MC__STOP       (0x0000)
+#define MC__UP         (0x0010)
+#define MC__CONTINUOUS (0x0020)
+#define TACLR          (0x0004)
+#define TBCLR          (0x0004)
+#define CCIE           (0x0010)
+#define CCIFG          (0x0001)
+
+// eUSCI
+#define UCSWRST       (0x0001)
+#define UCSSEL__SMCLK (0x0080)
+#define UCSYNC        (0x0100)
+#define UCMST         (0x0800)
+#define UCMSB         (0x2000)
+#define UCCKPH        (0x8000)
+#define UCRXIFG       (0x0001)
+#define UCTXIFG       (0x0002)
+#define UCRXIE        (0x0001)
+#define UCTXIE        (0x0002)
+#define UCBUSY        (0x0001)
+#define UCOS16        (0x0001)
+#define UCBRF_1       (0x0010)
+#define UCBRF_5       (0x0050)
+#define UCBRF_10      (0x00A0)
+#define USCI_NONE            (0x0000)
+#define USCI_UART_UCRXIFG    (0x0002)
+#define USCI_UART_UCTXIFG    (0x0004)
+#define USCI_UART_UCSTTIFG   (0x0006)
+#define USCI_UART_UCTXCPTIFG (0x0008)
+
+// Power management (both parts)
+#define PMMCTL0       SIM_IO(PMMCTL0)
+#define PMMCTL0_L     SIM_IO_L(PMMCTL0)
+#define PMMCTL0_H     SIM_IO_H(PMMCTL0)
+#define PMMPW_H       (0xA5)
+#define SVSHE         (0x0040)
+
+//-----------------------------------------------------------------------------
+// MSP430FR2355
+//-----------------------------------------------------------------------------
+#if defined(__MSP430FR2355__)
+
+#define SYSCFG0       SIM_IO(SYSCFG0)
+#define FRWPPW        (0xA500)
+#define PFWP          (0x0001)
+#define DFWP          (0x0002)
+
+#define P6DIR         SIM_IO(P6DIR)
+#define P6OUT         SIM_IO(P6OUT)
+
+#define TB0CTL        SIM_IO(TB0CTL)
+#define TB0CCR0       SIM_IO(TB0CCR0)
+#define TB0CCTL0      SIM_IO(TB0CCTL0)
+#define TB0R          sim_timer_count(&sim_reg_TB0CTL)
+#define TB1CTL        SIM_IO(TB1CTL)
+#define TB1R          sim_timer_count(&sim_reg_TB1CTL)
+#define TB3CTL        SIM_IO(TB3CTL)
+#define TB3CCR0       (*sim_timer_ccr(&sim_reg_TB3CCR0, &sim_reg_TB3CTL, &sim_reg_TB3CCTL0))
+#define TB3CCTL0      SIM_IO(TB3CCTL0)
+#define TB3R          sim_timer_count(&sim_reg_TB3CTL)
+
+#define CSCTL7        SIM_IO(CSCTL7)
+#define DIVS          (0x0030)
+#define DCORSEL_1     (0x0002)
+#define DCORSEL_7     (0x000E)
+#define FLLN          (0x03FF)
+#define FLLD          (0x7000)
+#define FLLD_0        (0x0000)
+#define FLLD_1        (0x1000)
+#define SELREF__REFOCLK  (0x0010)
+#define SELMS__DCOCLKDIV (0x0000)
+#define SELA__REFOCLK (0x0100)
+#define FLLUNLOCK0    (0x0100)
+#define FLLUNLOCK1    (0x0200)
+
+#define PMMCTL2       SIM_IO(PMMCTL2)
+#define INTREFEN      (0x0001)
+#define TSENSOREN     (0x0008)
+
+#define ADCCTL0       SIM_IO(ADCCTL0)
+#define ADCCTL1       SIM_IO_READY(ADCCTL1, 0, ADCBUSY)
+#define ADCCTL2       SIM_IO(ADCCTL2)
+#define ADCMCTL0      SIM_IO(ADCMCTL0)
+#define ADCIE         SIM_IO(ADCIE)
+#define ADCMEM0       sim_adc_result(sim_reg_ADCMCTL0 & 0x000F)
+#define ADCSC         (0x0001)
+#define ADCENC        (0x0002)
+#define ADCON         (0x0010)
+#define ADCSHP        (0x0200)
+#define ADCSHT_8      (0x0800)
+#define ADCBUSY       (0x0001)
+#define ADCRES        (0x0030)
+#define ADCRES_2      (0x0020)
+#define ADCSREF_0     (0x0000)
+#define ADCSREF_1     (0x0010)
+#define ADCINCH_12    (12)
+#define ADCINCH_13    (13)
+
+#endif /* __MSP430FR2355__ */
+
+//-----------------------------------------------------------------------------
+// MSP430FR6989
+//-----------------------------------------------------------------------------
+#if defined(__MSP430FR6989__)
+
+#define P9DIR         SIM_IO(P9DIR)
+#define P9OUT         SIM_IO(P9OUT)
+#define PJSEL0        SIM_IO(PJSEL0)
+
+#define TA0CTL        SIM_IO(TA0CTL)
+#define TA0R          sim_timer_count(&sim_reg_TA0CTL)
+#define TA0CCR0       (*sim_timer_ccr(&sim_reg_TA0CCR0, &sim_reg_TA0CTL, &sim_reg_TA0CCTL0))
+#define TA0CCTL0      SIM_IO(TA0CCTL0)
+#define TA1CTL        SIM_IO(TA1CTL)
+#define TA1R          sim_timer_count(&sim_reg_TA1CTL)
+
+#define UCA0CTLW0     SIM_IO(UCA0CTLW0)
+#define UCA0BR0       SIM_IO(UCA0BR0)
+#define UCA0BR1       SIM_IO(UCA0BR1)
+#define UCA0MCTLW     SIM_IO(UCA0MCTLW)
+#define UCA0IFG       SIM_IO_READY(UCA0IFG, UCTXIFG, 0)
+#define UCA0IE        SIM_IO(UCA0IE)
+#define UCA0RXBUF     SIM_IO(UCA0RXBUF)
+#define UCA0TXBUF     SIM_IO(UCA0TXBUF)
+#define UCA1CTLW0     SIM_IO(UCA1CTLW0)
+#define UCA1BRW       SIM_IO(UCA1BRW)
+#define UCA1BR0       SIM_IO_L(UCA1BRW)
+#define UCA1BR1       SIM_IO_H(UCA1BRW)
+#define UCA1MCTLW     SIM_IO(UCA1MCTLW)
+#define UCA1STATW     SIM_IO_READY(UCA1STATW, 0, UCBUSY)
+#define UCA1IFG       SIM_IO(UCA1IFG)
+#define UCA1IE        SIM_IO(UCA1IE)
+#define UCA1RXBUF     SIM_IO(UCA1RXBUF)
+#define UCA1TXBUF     (*sim_uart_txbuf())
+#define UCA1IV        sim_uart_iv()
+
+#define CSCTL0_H      SIM_IO_H(CSCTL0)
+#define CSKEY         (0xA500)
+#define CSKEY_H       (0xA5)
+#define DCOFSEL_0     (0x0000)
+#define DCOFSEL_3     (0x0006)
+#define DCOFSEL_4     (0x0008)
+#define DCOFSEL_6     (0x000C)
+#define DCOFSEL       (0x000E)
+#define DCORSEL       (0x0040)
+#define SELA__LFXTCLK (0x0000)
+#define SELA__VLOCLK  (0x0100)
+#define SELS__DCOCLK  (0x0030)
+#define SELM__DCOCLK  (0x0003)
+#define DIVA__1       (0x0000)
+#define DIVA__4       (0x0200)
+#define DIVS          (0x0070)
+#define DIVS__16      (0x0040)
+#define DIVS__32      (0x0050)
+#define LFXTOFF       (0x0001)
+#define LFXTOFFG      (0x0001)
+#define OFIFG         (0x0002)
+
+#define REFCTL0       SIM_IO_READY(REFCTL0, REFGENRDY, REFGENBUSY)
+#define REFON         (0x0001)
+#define REFVSEL_0     (0x0000)
+#define REFVSEL_1     (0x0010)
+#define REFVSEL_2     (0x0020)
+#define REFGENBUSY    (0x0400)
+#define REFGENRDY     (0x1000)
+
+#define ADC12CTL0     SIM_IO(ADC12CTL0)
+#define ADC12CTL1     SIM_IO_READY(ADC12CTL1, 0, ADC12BUSY)
+#define ADC12CTL2     SIM_IO(ADC12CTL2)
+#define ADC12CTL3     SIM_IO(ADC12CTL3)
+#define ADC12MCTL0    SIM_IO(ADC12MCTL0)
+#define ADC12MCTL1    SIM_IO(ADC12MCTL1)
+#define ADC12IER0     SIM_IO(ADC12IER0)
+#define ADC12MEM0     sim_adc_result(sim_reg_ADC12MCTL0 & 0x001F)
+#define ADC12MEM1     sim_adc_result(sim_reg_ADC12MCTL1 & 0x001F)
+#define ADC12SC       (0x0001)
+#define ADC12ENC      (0x0002)
+#define ADC12ON       (0x0010)
+#define ADC12SHP      (0x0200)
+#define ADC12SHT0_15  (0x0F00)
+#define ADC12BUSY     (0x0001)
+#define ADC12RES_2    (0x0020)
+#define ADC12BATMAP   (0x0040)
+#define ADC12TCMAP    (0x0080)
+#define ADC12CSTARTADD_1  (0x0001)
+#define ADC12CSTARTADD_31 (0x001F)
+#define ADC12VRSEL_1  (0x0100)
+#define ADC12INCH_30  (30)
+#define ADC12INCH_31  (31)
+
+#define RTCCTL0       SIM_IO(RTCCTL0)
+#define RTCCTL0_L     SIM_IO_L(RTCCTL0)
+#define RTCCTL0_H     SIM_IO_H(RTCCTL0)
+#define RTCCTL13      SIM_IO(RTCCTL13)
+#define RTCCTL1       SIM_IO_L(RTCCTL13)
+#define RTCYEAR       SIM_IO(RTCYEAR)
+#define RTCMON        SIM_IO(RTCMON)
+#define RTCDAY        SIM_IO(RTCDAY)
+#define RTCDOW        SIM_IO(RTCDOW)
+#define RTCHOUR       SIM_IO(RTCHOUR)
+#define RTCMIN        SIM_IO(RTCMIN)
+#define RTCSEC        SIM_IO(RTCSEC)
+#define RTCIV         sim_rtc_iv()
+#define RTCKEY_H      (0xA5)
+#define RTCRDYIE      (0x0010)
+#define RTCRDYIFG     (0x0001)
+#define RTCBCD        (0x0080)
+#define RTCHOLD       (0x0040)
+#define RTCMODE       (0x0020)
+#define RTCIV__NONE       (0x0000)
+#define RTCIV__RTCRDYIFG  (0x0004)
+#define RTCIV__RT1PSIFG   (0x000C)
+
+#endif /* __MSP430FR6989__ */
+
+//-----------------------------------------------------------------------------
+// Compiler intrinsics
+//-----------------------------------------------------------------------------
+#define __interrupt
+#define __even_in_range(value, bound) (value)
+
+void __delay_cycles(unsigned long cycles);
+void __no_operation(void);
+void __enable_interrupt(void);
+void __disable_interrupt(void);
+unsigned short __get_interrupt_state(void);
+void __set_interrupt_state(unsigned short state);
+void __bis_SR_register(unsigned short bits);
+void __bic_SR_register(unsigned short bits);
+void __bic_SR_register_on_exit(unsigned short bits);
+void __low_power_mode_3(void);
+void __low_power_mode_off_on_exit(void);
+
+#endif /* _TIGR_SIM_MSP430_H */
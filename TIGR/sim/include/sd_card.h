@@ -0,0 +1,69 @@
+// sd_card.h
+// SD card model for the TIGR host simulator
+//
+// An SPI-mode SD card behind sim_spi_device, backed by a sparse image file
+// (unwritten sectors read as zero). The image is a plain sector dump, the
+// same thing the extractor reads from a physical card.
+//
+// Supported commands: CMD0/1/8/9/12/13/16/17/18/24/25/55/58 and ACMD41.
+// SDSC cards use byte addresses and a v1 CSD; SDHC cards use block
+// addresses, a v2 CSD, and only leave idle through ACMD41 with HCS set.
+//
+// Program busy after each written block is drawn from a busy profile in
+// simulated time, so the firmware's busy polling costs what it would on a
+// real card. Faults (rejected blocks, stuck busy, removal) are injected
+// from a seeded generator, so a run is repeatable.
+
+#ifndef _TIGR_SIM_SD_CARD_H
+#define _TIGR_SIM_SD_CARD_H
+
+// Program-busy distribution for one written block: log-normal around
+// typical_us, plus occasional internal housekeeping stalls
+typedef struct {
+    const char* name;
+    double typical_us;                  // Median busy time
+    double sigma;                       // Log-normal shape
+    double stall_rate;                  // Fraction of writes that stall
+    double stall_min_ms;
+    double stall_max_ms;
+} SdBusyProfile;
+
+typedef struct {
+    unsigned char high_capacity;        // SDHC instead of SDSC
+    unsigned long sectors;              // Capacity in 512-byte blocks
+    const SdBusyProfile* busy;          // NULL = no program busy
+    unsigned int init_polls;            // CMD1/ACMD41 polls answered "idle"
+    unsigned long seed;                 // Fault and busy generator seed
+    double crc_error_rate;              // Blocks rejected with a CRC error token
+    double stuck_busy_rate;             // Writes that hold busy for stuck_busy_ms
+    double stuck_busy_ms;
+    double remove_at_s;                 // Pull the card at this time (< 0: never)
+    double reinsert_at_s;               // Put it back (< 0: never)
+} SdCardConfig;
+
+typedef struct {
+    unsigned long commands;
+    unsigned long blocks_read;
+    unsigned long blocks_written;
+    unsigned long crc_errors;           // Injected
+    unsigned long stuck_busy;           // Injected
+    unsigned long removals;
+    unsigned long long busy_cycles;     // Total program busy
+    unsigned long long worst_busy;
+} SdCardStats;
+
+extern SdCardStats sd_card_stats;
+
+// Busy profiles, looked up by name ("industrial", "consumer", "worst")
+const SdBusyProfile* sd_card_busy_profile(const char* name);
+void sd_card_default_config(SdCardConfig* config);
+
+// Attach a card backed by image_path (created if missing, grown to the
+// configured capacity). Call after sim_reset(). Returns 0 on success.
+int sd_card_open(const char* image_path, const SdCardConfig* config);
+void sd_card_close(void);
+
+// Insert or remove the card (card-detect follows)
+void sd_card_insert(int inserted);
+
+#endif /* _TIGR_SIM_SD_CARD_H */
@@ -0,0 +1,123 @@
+// sim.h
+// TIGR host simulator core
+//
+// The firmware runs natively against simulated registers. Time is counted
+// in ticks of a fixed SIM_TICK_HZ timebase and only moves when the
+// firmware waits: __delay_cycles, SPI/ADC/UART transfers, register polling
+// (1 MCLK cycle per access) and low-power sleep, which skips ahead to the
+// next scheduled event. MCLK and SMCLK are decoded from the CS registers
+// by the board model at each wait, so the firmware can change them at run
+// time.
+// Instruction execution itself is not timed (see the ISA profiling target
+// for that), so simulated dead time is the peripheral wait time that
+// dominates it on hardware.
+//
+// Interrupts are delivered when GIE is set: at register accesses,
+// __enable_interrupt/__set_interrupt_state, and while sleeping. An ISR
+// runs with GIE clear, as on the CPU, so flags raised meanwhile stay
+// pending and edges on an already-pending pin are merged. A PORT2 flag is
+// serviced when a P2IV read hands it out; one the firmware clears by
+// writing P2IFG first is counted in port2_cleared.
+//
+// Energy: elapsed time is split into CPU active time per MCLK frequency
+// and sleep time, and SPI transfers with the card selected are counted as
+// card time at the MCLK they ran at. The board supplies the CPU current
+// model; the card draws SIM_CARD_UA while clocked.
+
+#ifndef _TIGR_SIM_H
+#define _TIGR_SIM_H
+
+typedef unsigned long long sim_time_t;      // SIM_TICK_HZ ticks since reset
+typedef void (*sim_vector_t)(void);
+typedef void (*sim_event_fn)(void* arg);
+
+#define SIM_MAX_EVENTS      64
+#define SIM_CLOCK_POINTS    4               // Distinct MCLK frequencies tracked
+
+// Time and clocks
+extern sim_time_t sim_now;
+#define SIM_TICK_HZ         96000000ULL     // Multiple of every MCLK the firmware uses
+#define SIM_ACLK_HZ         32768UL
+sim_time_t sim_seconds(double seconds);
+double sim_to_seconds(sim_time_t ticks);
+sim_time_t sim_cycles(unsigned long long cycles, unsigned long hz);
+unsigned long long sim_aclk_ticks(void);
+
+// Environment inputs (used by the ADC model)
+extern int sim_temperature_c;
+extern unsigned int sim_avcc_mv;
+
+// Interrupt state
+extern unsigned char sim_gie;
+extern unsigned char sim_isr_depth;
+
+// Scheduler
+void sim_schedule(sim_time_t at, sim_event_fn fn, void* arg);
+void sim_cancel(sim_event_fn fn, void* arg);
+void sim_advance(unsigned long cycles);     // MCLK cycles
+void sim_advance_ticks(sim_time_t ticks);
+void sim_service(void);
+
+// Run entry (normally tigr_firmware_main) until simulated time reaches
+// until. The run stops the next time the firmware sleeps past that point.
+void sim_reset(void);
+void sim_run(int (*entry)(void), sim_time_t until);
+
+// Statistics and hooks
+#define SIM_CARD_UA         25000.0         // SD card while clocked or programming
+
+typedef struct {
+    unsigned long mclk_hz;                  // 0 = unused entry
+    sim_time_t active;                      // CPU on at this MCLK
+    sim_time_t card;                        // SPI transfers with the card selected
+    unsigned long sectors;                  // Blocks the card accepted
+} SimClockStats;
+
+typedef struct {
+    unsigned long interrupts;               // ISR invocations (all vectors)
+    unsigned long port2_edges;              // Edges presented on PORT2
+    unsigned long port2_merged;             // Edges on a pin whose flag was still set
+    unsigned long port2_cleared;            // Flags cleared by a P2IFG write before P2IV
+                                            // handed them to the ISR (edge never serviced)
+    sim_time_t port2_isr_cycles;            // Time spent in the PORT2 ISR
+    sim_time_t port2_worst_isr;             // Longest single PORT2 ISR
+    sim_time_t port2_worst_latency;         // Longest edge-to-ISR-entry delay
+    sim_time_t masked_cycles;               // GIE clear (ISRs, critical sections) after
+                                            // interrupts were first enabled
+    unsigned long spi_bytes;
+    unsigned long uart_tx_bytes;
+    SimClockStats clock[SIM_CLOCK_POINTS];  // In order of first use
+    sim_time_t sleep;                       // CPU off
+} SimStats;
+extern SimStats sim_stats;
+void sim_clear_stats(void);                 // Start a measurement window now
+SimClockStats* sim_clock_stats(void);       // Entry for the current MCLK
+void sim_account(void);                     // Bring the energy split up to now
+
+// Called for every byte the firmware shifts out of UCA1 (FR6989)
+extern void (*sim_uart_tx_sink)(unsigned char byte);
+// Called after every PORT2 ISR with its length, entry to RETI
+extern void (*sim_port2_isr_sink)(sim_time_t spent);
+// SPI slave on eUSCI_B0: gets MOSI and chip-select state, returns MISO
+extern unsigned char (*sim_spi_device)(unsigned char mosi, int selected);
+
+// Board (board_fr2355.c / board_fr6989.c)
+extern const char* sim_board_name;
+void sim_board_reset(void);
+sim_vector_t sim_board_pending(void);
+sim_vector_t sim_board_port2_vector(void);
+unsigned int sim_board_band_bit(unsigned char band);
+int sim_board_cs_selected(void);
+unsigned int sim_board_spi_divider(void);
+unsigned long sim_board_mclk_hz(void);      // Decoded from the CS registers
+unsigned long sim_board_smclk_hz(void);
+extern const double sim_board_active_ua_mhz;   // CPU current model
+extern const double sim_board_sleep_ua;
+unsigned int sim_board_adc(unsigned int channel);
+void sim_board_card_detect(int inserted);   // Drive the SD card-detect input
+
+// Inputs
+void sim_port2_edge(unsigned int bits);
+void sim_uart_rx(unsigned char byte);
+
+#endif /* _TIGR_SIM_H */
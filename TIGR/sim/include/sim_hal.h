@@ -0,0 +1,14 @@
+// sim_hal.h
+// Host simulator versions of the tigr_hal.h access points
+
+#ifndef _TIGR_SIM_HAL_H
+#define _TIGR_SIM_HAL_H
+
+unsigned char sim_spi_xfer(unsigned char data);
+unsigned int sim_tlv_word(unsigned int address);
+
+#define hal_spi_xfer(data)      sim_spi_xfer(data)
+#define hal_tlv_word(address)   sim_tlv_word(address)
+#define hal_port2_iv()          P2IV
+
+#endif /* _TIGR_SIM_HAL_H */
@@ -0,0 +1,21 @@
+// profile_hal.h
+// Cycle-profiling versions of the tigr_hal.h access points
+//
+// SPI bytes are answered by a scripted SD card (profile_main.c) so the
+// write path runs end to end without a card or an SPI peripheral model.
+// TLV reads return fixed calibration words from RAM, which costs the same
+// as the absolute read on the target. The ISA simulator has no PORT2 model,
+// so P2IV is worked out from P2IFG and P2IE the way the hardware does.
+
+#ifndef _TIGR_PROFILE_HAL_H
+#define _TIGR_PROFILE_HAL_H
+
+unsigned char profile_spi_xfer(unsigned char data);
+extern const unsigned int profile_tlv[2];      // CAL 30 C, CAL 85 C
+unsigned int profile_port2_iv(void);
+
+#define hal_spi_xfer(data)      profile_spi_xfer(data)
+#define hal_tlv_word(address)   (profile_tlv[((address) - 0x1A1A) >> 1])
+#define hal_port2_iv()          profile_port2_iv()
+
+#endif /* _TIGR_PROFILE_HAL_H */
@@ -0,0 +1,83 @@
+// legacy_format.c
+// The event-line formatter as it was before the fixed-width writers, kept
+// only as the reference for the formatter speedup in profile.py
+//
+// Each field goes through a division-based conversion into a temporary,
+// which is then copied into the destination.
+
+#include "tigr_config.h"
+
+static void legacy_uint_to_string(unsigned int num, char* str) {
+    int i = 0;
+    int j;
+    char temp;
+    
+    if (num == 0) {
+        str[0] = '0';
+        str[1] = '\0';
+        return;
+    }
+    while (num > 0) {
+        str[i++] = '0' + (num % 10);
+        num /= 10;
+    }
+    str[i] = '\0';
+    for (j = 0; j < i/2; j++) {
+        temp = str[j];
+        str[j] = str[i-1-j];
+        str[i-1-j] = temp;
+    }
+}
+
+static void legacy_bcd_to_string(unsigned char bcd, char* str) {
+    str[0] = '0' + ((bcd >> 4) & 0x0F);
+    str[1] = '0' + (bcd & 0x0F);
+    str[2] = '\0';
+}
+
+static void legacy_hex_to_string_4(unsigned int hex, char* str) {
+    str[0] = '0' + ((hex >> 12) & 0x0F);
+    str[1] = '0' + ((hex >> 8) & 0x0F);
+    str[2] = '0' + ((hex >> 4) & 0x0F);
+    str[3] = '0' + (hex & 0x0F);
+    str[4] = '\0';
+}
+
+static char* legacy_append(char* dst, const char* str) {
+    while (*str != '\0') {
+        *dst++ = *str++;
+    }
+    return dst;
+}
+
+char* legacy_format_event(char* dst, unsigned int muon_number, unsigned char band,
+                          const RtcTime* time) {
+    char num_str[12];
+    char str[6];
+    
+    legacy_uint_to_string(muon_number, num_str);
+    dst = legacy_append(dst, num_str);
+    *dst++ = ',';
+    legacy_uint_to_string(band, num_str);
+    dst = legacy_append(dst, num_str);
+    *dst++ = ',';
+    legacy_hex_to_string_4(time->year, str);
+    dst = legacy_append(dst, str);
+    *dst++ = '-';
+    legacy_bcd_to_string(time->month, str);
+    dst = legacy_append(dst, str);
+    *dst++ = '-';
+    legacy_bcd_to_string(time->day, str);
+    dst = legacy_append(dst, str);
+    *dst++ = ',';
+    legacy_bcd_to_string(time->hour, str);
+    dst = legacy_append(dst, str);
+    *dst++ = ':';
+    legacy_bcd_to_string(time->minute, str);
+    dst = legacy_append(dst, str);
+    *dst++ = ':';
+    legacy_bcd_to_string(time->second, str);
+    dst = legacy_append(dst, str);
+    *dst++ = '\n';
+    return dst;
+}
@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""
+TIGR Hot-Path Cycle Profile
+Runs a profiling image built by TIGR/sim/isa/Makefile under mspdebug (its
+MSP430 simulator by default, or a LaunchPad with --driver tilib), stops at
+profile_done and prints the MCLK cycles taken by each measured function.
+
+Each row is the minimum over the harness's runs (the code paths are
+deterministic; max differs only if something else ran). Timer overhead is
+subtracted. ISR rows add interrupt acceptance and RETI, so they are the full
+cost of one interrupt. SPI bytes are answered by a scripted card; the "cpu"
+column removes the responder's cost per byte and "target" adds back an
+estimate of a real eUSCI byte (--spi-byte-cycles).
+
+The run fails if one event line from format_event is not at least
+--min-speedup times cheaper than the legacy divide-and-copy formatter, or,
+given --budget, if a detection ISR path takes more than BUDGET_SLACK times
+the CPU cycles measured for it there. A budget is the --csv table of a
+measured run (budget_<board>.csv, make budget).
+
+The speedup gate has not yet been run on an MSP430, so the 5x is a target,
+not a measurement. The only figure so far is the host one from make -C
+TIGR/sim format: about 1.2x (24 vs 28 ns per line, x86-64, gcc -O2), where
+the legacy divisions by 10 compile to multiplies.
+
+Usage:
+    python3 profile.py build/tigr_profile_fr2355.elf --mhz 1.5
+    python3 profile.py build/tigr_profile_fr6989.elf --mhz 8 --csv fr6989.csv
+    python3 profile.py build/tigr_profile_fr6989.elf --mhz 8 --budget budget_fr6989.csv
+"""
+
+import argparse
+import csv
+import re
+import struct
+import subprocess
+import sys
+
+# Keep in step with the enum in profile_main.c
+MEASUREMENTS = ("empty", "empty_isr", "spi_byte", "port2_isr", "port2_isr_flush",
+                "port2_isr_shower", "port2_isr_prescaled", "port2_isr_histogram",
+                "save_reading", "read_temperature", "write_readings_to_sd",
+                "uint_to_string(0)", "uint_to_string(99)", "uint_to_string(12345)",
+                "uint_to_string(65535)", "mmc_write_block", "format_event",
+                "format_event(legacy)")
+ISR_ROWS = ("port2_isr", "port2_isr_flush", "port2_isr_shower",
+            "port2_isr_prescaled", "port2_isr_histogram")
+
+# Growth of a detection ISR path's CPU cycles (scripted SPI bytes
+# removed, interrupt acceptance and RETI included) over its measured
+# budget before the run fails. The flush path formats MAX_READINGS lines
+# and writes a sector, so its budget holds for one build configuration.
+BUDGET_SLACK = 1.10
+SPI_BATCH = 16                          # Bytes timed by the spi_byte run
+
+RESULT = struct.Struct("<LLLHH")        # min, max, total, runs, spi_bytes
+ACCEPT_CYCLES = 6                       # Interrupt acceptance
+RETI_CYCLES = 5
+
+# The simulator's Timer_A model stands in for TB2 (FR2355) / TA2 (FR6989)
+SIM_TIMER = ("simio add timer ptimer", "simio config ptimer base 0x0400")
+
+
+def symbols(elf):
+    out = subprocess.run(["msp430-elf-nm", elf], check=True,
+                         capture_output=True, text=True).stdout
+    table = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 3:
+            table[parts[2]] = int(parts[0], 16)
+    return table
+
+
+def read_budget(path):
+    """Measured CPU cycles per ISR path from a --csv table"""
+    with open(path) as f:
+        return {r["function"]: int(r["cpu"]) for r in csv.DictReader(f)
+                if r["function"] in ISR_ROWS}
+
+
+def run_mspdebug(driver, elf, done, results, length):
+    commands = [f"prog {elf}"]
+    if driver == "sim":
+        commands += SIM_TIMER
+    commands += [f"setbreak 0x{done:04x}", "run", f"md 0x{results:04x} {length}"]
+    out = subprocess.run(["mspdebug", "-q", driver] + commands, check=True,
+                         capture_output=True, text=True).stdout
+    data = bytearray()
+    for line in out.splitlines():
+        m = re.match(r"\s*(?:0x)?[0-9a-fA-F]+:\s+([0-9a-fA-F ]+)", line)
+        if m:
+            data += bytes(int(b, 16) for b in m.group(1).split() if len(b) == 2)
+    if len(data) < length:
+        sys.exit(f"mspdebug returned {len(data)} of {length} result bytes:\n{out}")
+    return bytes(data[:length])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TIGR hot-path cycle profile")
+    parser.add_argument('elf', help="profiling image (tigr_profile_*.elf)")
+    parser.add_argument('--driver', default="sim", help="mspdebug driver (sim, tilib, ...)")
+    parser.add_argument('--mhz', type=float, default=1.0, help="MCLK for the time column")
+    parser.add_argument('--spi-byte-cycles', type=float, default=24.0,
+                        help="cycles per SPI byte on the target (8 bits at SMCLK/2 "
+                             "plus call and flag polls)")
+    parser.add_argument('--ua-per-mhz', type=float, default=120.0,
+                        help="active current; the default is approximate, measure the board")
+    parser.add_argument('--vcc', type=float, default=3.0)
+    parser.add_argument('--min-speedup', type=float, default=5.0,
+                        help="fail if format_event is not this much faster than the legacy formatter")
+    parser.add_argument('--csv', help="write the table to this CSV file")
+    parser.add_argument('--budget', help="fail on ISR paths over this measured table (CSV)")
+    args = parser.parse_args()
+    budget = read_budget(args.budget) if args.budget else {}
+
+    syms = symbols(args.elf)
+    length = RESULT.size * len(MEASUREMENTS)
+    raw = run_mspdebug(args.driver, args.elf, syms["profile_done"],
+                       syms["profile_results"], length)
+    res = {name: RESULT.unpack_from(raw, i * RESULT.size)
+           for i, name in enumerate(MEASUREMENTS)}
+    if any(r[3] == 0 for r in res.values()):
+        sys.exit("harness did not complete every measurement")
+
+    overhead = res["empty"][0]
+    isr_frame = res["empty_isr"][0] - overhead
+    spi_byte = (res["spi_byte"][0] - overhead) / SPI_BATCH
+
+    rows = []
+    for name in MEASUREMENTS[3:]:
+        lo, hi, total, runs, spi_bytes = res[name]
+        cycles = lo - overhead
+        if name in ISR_ROWS:
+            cycles += ACCEPT_CYCLES + RETI_CYCLES - isr_frame
+        cpu = cycles - spi_bytes * spi_byte
+        target = cpu + spi_bytes * args.spi_byte_cycles
+        rows.append({
+            "function": name, "cycles": cycles, "max": hi - lo + cycles,
+            "spi_bytes": spi_bytes, "cpu": round(cpu), "target": round(target),
+            "target_us": target / args.mhz,
+            "target_nj": target * args.ua_per_mhz * args.vcc * 1e-3,
+        })
+
+    print(f"{args.elf}: timer overhead {overhead}, scripted SPI byte {spi_byte:.1f} cycles")
+    print(f"{'function':<24}{'cycles':>9}{'max':>9}{'spi':>6}{'cpu':>9}{'target':>9}"
+          f"{'us@' + format(args.mhz, 'g'):>11}{'nJ':>9}{'budget':>9}")
+    for r in rows:
+        print(f"{r['function']:<24}{r['cycles']:>9}{r['max']:>9}{r['spi_bytes']:>6}"
+              f"{r['cpu']:>9}{r['target']:>9}{r['target_us']:>11.1f}{r['target_nj']:>9.1f}"
+              f"{budget.get(r['function'], ''):>9}")
+    if not budget:
+        print("no ISR cycle budget given (--budget), paths not checked")
+
+    cycles = {r["function"]: r["cycles"] for r in rows}
+    speedup = cycles["format_event(legacy)"] / cycles["format_event"]
+    print(f"event line formatter: {speedup:.1f}x faster than the legacy formatter")
+
+    if args.csv:
+        with open(args.csv, 'w', newline='') as f:
+            writer = csv.DictWriter(f, fieldnames=list(rows[0]))
+            writer.writeheader()
+            writer.writerows(rows)
+
+    over = [f"{r['function']} {r['cpu']} > {budget[r['function']]}"
+            for r in rows if r['cpu'] > BUDGET_SLACK * budget.get(r['function'], float('inf'))]
+    if speedup < args.min_speedup:
+        sys.exit(f"formatter speedup {speedup:.1f}x is below {args.min_speedup:g}x")
+    if over:
+        sys.exit("ISR cycle budget exceeded: " + ", ".join(over))
+
+
+if __name__ == '__main__':
+    main()
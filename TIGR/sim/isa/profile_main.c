@@ -0,0 +1,356 @@
+// profile_main.c
+// Cycle-profiling harness for the TIGR hot path
+//
+// Linked with one firmware tree built by msp430-elf-gcc (main renamed to
+// tigr_firmware_main), this calls each hot-path function from a known
+// state and times it on a timer clocked from SMCLK = MCLK. Results land in
+// profile_results[]; profile.py reads them at the profile_done breakpoint.
+// The same image runs under the mspdebug simulator and on a LaunchPad.
+//
+// The timer lives at 0x0400 on both boards (TB2 on the FR2355, TA2 on the
+// FR6989), which is where profile.py attaches the simulator's timer.
+
+#include <msp430.h>
+#include "tigr_config.h"
+#include "tigr_mmc.h"
+#include "tigr_utils.h"
+#include "temp_utils.h"
+#include "sd_utils.h"
+#include "histogram.h"
+#include "prescale.h"
+
+#define PORT2_ISR       ISRP2
+
+#if defined(__MSP430FR2355__)
+#define BAND1_BIT       BIT4
+#define BAND4_BIT       BIT1
+#define PROFILE_TCTL    TB2CTL
+#define PROFILE_TR      TB2R
+#define PROFILE_TSTART  (TBSSEL__SMCLK | MC__CONTINUOUS)
+#define PROFILE_TIFG    TBIFG
+#elif defined(__MSP430FR6989__)
+#define BAND1_BIT       BIT1
+#define BAND4_BIT       BIT4
+#define PROFILE_TCTL    TA2CTL
+#define PROFILE_TR      TA2R
+#define PROFILE_TSTART  (TASSEL__SMCLK | MC__CONTINUOUS)
+#define PROFILE_TIFG    TAIFG
+#else
+#error "profile_main.c: unsupported device"
+#endif
+
+#ifndef PROFILE_RUNS
+#define PROFILE_RUNS 8
+#endif
+
+// Scripted card: bytes of N_CR before R1 and of program busy after the
+// data response
+#ifndef PROFILE_NCR
+#define PROFILE_NCR 1
+#endif
+#ifndef PROFILE_BUSY_BYTES
+#define PROFILE_BUSY_BYTES 0
+#endif
+
+// Keep in step with MEASUREMENTS in profile.py
+enum {
+    PROF_EMPTY,                 // Timer start/stop overhead
+    PROF_EMPTY_ISR,             // Synthetic interrupt frame around a bare RETI
+    PROF_SPI_BYTE,              // One scripted SPI byte, subtracted per byte
+    PROF_PORT2_ISR,             // Band 1 edge, staging not full
+    PROF_PORT2_ISR_FLUSH,       // Band 4 edge that fills the staging array
+    PROF_PORT2_ISR_SHOWER,      // Bands 1 and 4 pending together: one detection
+    PROF_PORT2_ISR_PRESCALED,   // Band 1 edge skipped by a prescale of 2
+    PROF_PORT2_ISR_HISTOGRAM,   // Band 1 edge counted into a histogram bin
+    PROF_SAVE_READING,
+    PROF_READ_TEMPERATURE,
+    PROF_WRITE_READINGS,        // MAX_READINGS staged, one sector written
+    PROF_UINT_TO_STRING_0,
+    PROF_UINT_TO_STRING_99,
+    PROF_UINT_TO_STRING_12345,
+    PROF_UINT_TO_STRING_65535,
+    PROF_MMC_WRITE_BLOCK,
+    PROF_FORMAT_EVENT,          // One event line into sd_buffer
+    PROF_FORMAT_EVENT_LEGACY,   // Same line, pre-fixed-width formatter
+    PROF_COUNT
+};
+
+typedef struct {
+    unsigned long min;
+    unsigned long max;
+    unsigned long total;
+    unsigned int runs;
+    unsigned int spi_bytes;     // Per run
+} ProfileResult;
+
+volatile ProfileResult profile_results[PROF_COUNT];
+volatile unsigned int profile_count = PROF_COUNT;
+
+const unsigned int profile_tlv[2] = { 2000, 2400 };
+
+// ---- Scripted SD card --------------------------------------------------
+
+enum { CARD_IDLE, CARD_ARG, CARD_R1, CARD_TOKEN, CARD_DATA, CARD_DRESP, CARD_BUSY };
+
+static unsigned char card_state = CARD_IDLE;
+static unsigned char card_cmd;
+static unsigned int card_count;
+static volatile unsigned int profile_spi_bytes;
+
+// Answers every command with R1 = 0 after PROFILE_NCR fill bytes and
+// accepts CMD24 data blocks with data response 0x05
+unsigned char profile_spi_xfer(unsigned char data) {
+    profile_spi_bytes++;
+    switch (card_state) {
+    case CARD_IDLE:
+        if ((data & 0xC0) == 0x40) {
+            card_cmd = data;
+            card_count = 5;
+            card_state = CARD_ARG;
+        }
+        return 0xFF;
+    case CARD_ARG:
+        if (--card_count == 0) {
+            card_count = PROFILE_NCR;
+            card_state = CARD_R1;
+        }
+        return 0xFF;
+    case CARD_R1:
+        if (card_count) {
+            card_count--;
+            return 0xFF;
+        }
+        card_state = (card_cmd == MMC_WRITE_BLOCK) ? CARD_TOKEN : CARD_IDLE;
+        return 0x00;
+    case CARD_TOKEN:
+        if (data == MMC_START_DATA_BLOCK_TOKEN) {
+            card_count = MMC_BLOCK_SIZE + 2;
+            card_state = CARD_DATA;
+        }
+        return 0xFF;
+    case CARD_DATA:
+        if (--card_count == 0) {
+            card_state = CARD_DRESP;
+        }
+        return 0xFF;
+    case CARD_DRESP:
+        card_count = PROFILE_BUSY_BYTES;
+        card_state = CARD_BUSY;
+        return 0x05;
+    default:
+        if (card_count) {
+            card_count--;
+            return 0x00;
+        }
+        card_state = CARD_IDLE;
+        return 0xFF;
+    }
+}
+
+// ---- Measurement -------------------------------------------------------
+
+static unsigned int spi_mark;
+
+#define PROFILE_BEGIN()                                 \
+    do {                                                \
+        spi_mark = profile_spi_bytes;                   \
+        PROFILE_TCTL = 0;                               \
+        PROFILE_TR = 0;                                 \
+        PROFILE_TCTL = PROFILE_TSTART;                  \
+    } while (0)
+
+#define PROFILE_END(id) \
+    profile_record(id, PROFILE_TR, PROFILE_TCTL & PROFILE_TIFG)
+
+static void profile_record(unsigned int id, unsigned int count, unsigned int wrapped) {
+    volatile ProfileResult* r = &profile_results[id];
+    unsigned long cycles = count;
+
+    // Anything past one wrap (131071 cycles) is out of range
+    if (wrapped) {
+        cycles += 65536UL;
+    }
+    if (r->runs == 0 || cycles < r->min) {
+        r->min = cycles;
+    }
+    if (cycles > r->max) {
+        r->max = cycles;
+    }
+    r->total += cycles;
+    r->runs++;
+    r->spi_bytes = profile_spi_bytes - spi_mark;
+}
+
+#define STR(x)  #x
+#define XSTR(x) STR(x)
+
+// Enter an ISR the way the CPU does: push PC, push SR, jump. Its RETI
+// returns to the label. Interrupt acceptance (6 cycles) is added by
+// profile.py, as the frame set-up is measured by PROF_EMPTY_ISR.
+#define CALL_ISR(isr)                                   \
+    __asm__ __volatile__("push #1f\n\t"                 \
+                         "push r2\n\t"                  \
+                         "br #" XSTR(isr) "\n"          \
+                         "1:\n" ::: "memory")
+
+__interrupt void PORT2_ISR(void);
+
+// P2IV: lowest numbered pending enabled flag, cleared as it is returned
+unsigned int profile_port2_iv(void) {
+    unsigned char active = P2IFG & P2IE;
+    unsigned char bit = active & -active;
+    unsigned int iv = 0;
+
+    if (!bit) {
+        return 0;
+    }
+    P2IFG &= ~bit;
+    while (bit) {
+        iv += 2;
+        bit >>= 1;
+    }
+    return iv;
+}
+
+__attribute__((interrupt, used)) void profile_empty_isr(void) {
+}
+
+static char num_str[12];
+
+char* legacy_format_event(char* dst, unsigned int muon_number, unsigned char band,
+                          const RtcTime* time);
+
+// Two seconds before a year rollover; muon 54321 (five digits) is the
+// legacy formatter's slowest case
+static const RtcTime sample_time = { 0x2025, 0x12, 0x31, 0x23, 0x59, 0x58 };
+
+// Staging array ready for an edge; full = the next save fills it. The
+// first formatted line straddles a sector boundary, so flushing paths
+// write one sector.
+static void stage(unsigned char full) {
+    unsigned int i;
+
+    // Events spread over the batch so formatting crosses second boundaries
+    for (i = 0; i < MAX_READINGS; i++) {
+        readings[i].tick_delta = 1000;
+        readings[i].band_mask = (unsigned char)(1 << (i & 3));
+        readings[i].second_offset = (unsigned char)(i / 4);
+    }
+    stage_anchor.muon_number = 1000;
+    stage_anchor.uptime = uptime_s;
+    stage_anchor.time = sample_time;
+    reading_count = full ? MAX_READINGS - 1 : 0;
+    buffer_position = SD_BUFFER_SIZE - EVENT_LINE_LEN / 2;
+    current_sector = 2048;
+}
+
+static void profile_uint_to_string(unsigned int id, unsigned int value) {
+    PROFILE_BEGIN();
+    uint_to_string(value, num_str);
+    PROFILE_END(id);
+}
+
+// profile.py stops here
+void __attribute__((noinline)) profile_done(void) {
+    __no_operation();
+}
+
+int main(void) {
+    unsigned int run;
+    unsigned int i;
+
+    WDTCTL = WDTPW | WDTHOLD;
+    PM5CTL0 &= ~LOCKLPM5;
+
+    adc_init();
+    P2IE = BAND_FLAGS;          // P2IV only reports enabled flags
+    sd_initialized = 1;
+    muon_count = 1000;
+
+    for (run = 0; run < PROFILE_RUNS; run++) {
+        PROFILE_BEGIN();
+        PROFILE_END(PROF_EMPTY);
+
+        PROFILE_BEGIN();
+        CALL_ISR(profile_empty_isr);
+        PROFILE_END(PROF_EMPTY_ISR);
+
+        PROFILE_BEGIN();
+        for (i = 0; i < 16; i++) {
+            spi_send_byte(0xFF);
+        }
+        PROFILE_END(PROF_SPI_BYTE);
+
+        stage(0);
+        P2IFG = BAND1_BIT;
+        PROFILE_BEGIN();
+        CALL_ISR(PORT2_ISR);
+        PROFILE_END(PROF_PORT2_ISR);
+
+        stage(1);
+        P2IFG = BAND4_BIT;
+        PROFILE_BEGIN();
+        CALL_ISR(PORT2_ISR);
+        PROFILE_END(PROF_PORT2_ISR_FLUSH);
+
+        stage(0);
+        P2IFG = BAND1_BIT | BAND4_BIT;
+        PROFILE_BEGIN();
+        CALL_ISR(PORT2_ISR);
+        PROFILE_END(PROF_PORT2_ISR_SHOWER);
+
+        stage(0);
+        band_config.prescale[0] = 2;
+        prescale_phase[0] = 0;
+        P2IFG = BAND1_BIT;
+        PROFILE_BEGIN();
+        CALL_ISR(PORT2_ISR);
+        PROFILE_END(PROF_PORT2_ISR_PRESCALED);
+        band_config.prescale[0] = 1;
+
+        stage(0);
+        log_mode = LOG_HISTOGRAM;
+        P2IFG = BAND1_BIT;
+        PROFILE_BEGIN();
+        CALL_ISR(PORT2_ISR);
+        PROFILE_END(PROF_PORT2_ISR_HISTOGRAM);
+        log_mode = LOG_EVENTS;
+
+        stage(0);
+        PROFILE_BEGIN();
+        save_reading(2);
+        PROFILE_END(PROF_SAVE_READING);
+
+        PROFILE_BEGIN();
+        read_temperature();
+        PROFILE_END(PROF_READ_TEMPERATURE);
+
+        stage(0);
+        reading_count = MAX_READINGS;
+        PROFILE_BEGIN();
+        write_readings_to_sd();
+        PROFILE_END(PROF_WRITE_READINGS);
+
+        profile_uint_to_string(PROF_UINT_TO_STRING_0, 0);
+        profile_uint_to_string(PROF_UINT_TO_STRING_99, 99);
+        profile_uint_to_string(PROF_UINT_TO_STRING_12345, 12345);
+        profile_uint_to_string(PROF_UINT_TO_STRING_65535, 65535);
+
+        PROFILE_BEGIN();
+        mmc_write_block(2048UL * 512UL, sd_buffer);
+        PROFILE_END(PROF_MMC_WRITE_BLOCK);
+
+        PROFILE_BEGIN();
+        format_event((char*)sd_buffer, 54321, 3, &sample_time);
+        PROFILE_END(PROF_FORMAT_EVENT);
+
+        PROFILE_BEGIN();
+        legacy_format_event((char*)sd_buffer, 54321, 3, &sample_time);
+        PROFILE_END(PROF_FORMAT_EVENT_LEGACY);
+    }
+
+    profile_done();
+    for (;;) {
+        __no_operation();
+    }
+}
@@ -0,0 +1,592 @@
+// msp430_sim.c
+// TIGR host simulator core: register storage, time, events, interrupts
+// See include/sim.h for the model.
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "msp430.h"
+#include "sim.h"
+#include "sim_hal.h"
+
+#define SIM_DEFINE_REGISTER(name) volatile unsigned int sim_reg_##name;
+SIM_REGISTERS(SIM_DEFINE_REGISTER)
+#undef SIM_DEFINE_REGISTER
+
+#define ISR_ENTRY_CYCLES    6       // Interrupt acceptance
+#define ISR_RETI_CYCLES     5       // RETI
+#define SPI_BYTE_OVERHEAD   4       // Polling around each SPI byte
+
+sim_time_t sim_now = 0;
+int sim_temperature_c = 22;
+unsigned int sim_avcc_mv = 3300;
+unsigned char sim_gie = 0;
+unsigned char sim_isr_depth = 0;
+SimStats sim_stats;
+void (*sim_uart_tx_sink)(unsigned char byte) = 0;
+void (*sim_port2_isr_sink)(sim_time_t spent) = 0;
+unsigned char (*sim_spi_device)(unsigned char mosi, int selected) = 0;
+
+typedef struct {
+    sim_time_t at;
+    sim_event_fn fn;
+    void* arg;
+} SimEvent;
+
+static SimEvent events[SIM_MAX_EVENTS];
+static unsigned int event_count = 0;
+
+static unsigned char lpm_exit = 0;
+static unsigned char running = 0;
+static sim_time_t run_until = 0;
+static jmp_buf run_exit;
+
+static sim_time_t port2_edge_time[8];
+static unsigned int port2_unserviced = 0;   // Enabled flags set by an edge, not yet read from P2IV
+static sim_time_t masked_since = 0;
+static unsigned char gie_seen = 0;
+static unsigned char cpu_off = 0;
+static sim_time_t accounted_at = 0;
+
+static volatile unsigned int uart_tx_latch;
+
+//-----------------------------------------------------------------------------
+// Clocks
+//-----------------------------------------------------------------------------
+sim_time_t sim_seconds(double seconds) {
+    return (sim_time_t)(seconds * (double)SIM_TICK_HZ + 0.5);
+}
+
+double sim_to_seconds(sim_time_t ticks) {
+    return (double)ticks / (double)SIM_TICK_HZ;
+}
+
+// Duration of a number of cycles of a clock running at hz
+sim_time_t sim_cycles(unsigned long long cycles, unsigned long hz) {
+    if (hz == 0) {
+        hz = 1;
+    }
+    return (cycles * SIM_TICK_HZ + hz / 2) / hz;
+}
+
+unsigned long long sim_aclk_ticks(void) {
+    return (sim_now * SIM_ACLK_HZ) / SIM_TICK_HZ;
+}
+
+//-----------------------------------------------------------------------------
+// Energy accounting
+//-----------------------------------------------------------------------------
+SimClockStats* sim_clock_stats(void) {
+    unsigned long hz = sim_board_mclk_hz();
+    unsigned int i;
+
+    for (i = 0; i < SIM_CLOCK_POINTS - 1; i++) {
+        if (sim_stats.clock[i].mclk_hz == hz || sim_stats.clock[i].mclk_hz == 0) {
+            break;
+        }
+    }
+    sim_stats.clock[i].mclk_hz = hz;            // The last entry takes any overflow
+    return &sim_stats.clock[i];
+}
+
+// Attribute the time since the last call to the CPU state it ran in.
+// Called before anything that changes that state.
+void sim_account(void) {
+    sim_time_t span = sim_now - accounted_at;
+
+    if (span) {
+        if (cpu_off) {
+            sim_stats.sleep += span;
+        } else {
+            sim_clock_stats()->active += span;
+        }
+        accounted_at = sim_now;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Scheduler
+//-----------------------------------------------------------------------------
+void sim_schedule(sim_time_t at, sim_event_fn fn, void* arg) {
+    if (event_count >= SIM_MAX_EVENTS) {
+        fprintf(stderr, "sim: event queue full\n");
+        abort();
+    }
+    events[event_count].at = at;
+    events[event_count].fn = fn;
+    events[event_count].arg = arg;
+    event_count++;
+}
+
+void sim_cancel(sim_event_fn fn, void* arg) {
+    unsigned int i = 0;
+
+    while (i < event_count) {
+        if (events[i].fn == fn && events[i].arg == arg) {
+            events[i] = events[--event_count];
+        } else {
+            i++;
+        }
+    }
+}
+
+// Index of the earliest event, -1 if none
+static int next_event(void) {
+    int best = -1;
+    unsigned int i;
+
+    for (i = 0; i < event_count; i++) {
+        if (best < 0 || events[i].at < events[best].at) {
+            best = (int)i;
+        }
+    }
+    return best;
+}
+
+// Run every event due at or before limit, in time order
+static void run_events(sim_time_t limit) {
+    int i;
+    SimEvent ev;
+
+    while ((i = next_event()) >= 0 && events[i].at <= limit) {
+        ev = events[i];
+        events[i] = events[--event_count];
+        if (ev.at > sim_now) {
+            sim_now = ev.at;
+        }
+        ev.fn(ev.arg);
+        sim_service();
+    }
+}
+
+void sim_advance_ticks(sim_time_t ticks) {
+    sim_time_t target = sim_now + ticks;
+
+    sim_account();
+    run_events(target);
+    if (sim_now < target) {
+        sim_now = target;
+    }
+    sim_service();
+}
+
+void sim_advance(unsigned long cycles) {
+    sim_advance_ticks(sim_cycles(cycles, sim_board_mclk_hz()));
+}
+
+//-----------------------------------------------------------------------------
+// Interrupts
+//-----------------------------------------------------------------------------
+// All GIE changes go through here so masked time can be accounted
+static void set_gie(unsigned char enable) {
+    if (enable && !sim_gie) {
+        if (gie_seen) {
+            sim_stats.masked_cycles += sim_now - masked_since;
+        }
+        gie_seen = 1;
+    } else if (!enable && sim_gie) {
+        masked_since = sim_now;
+    }
+    sim_gie = enable;
+}
+
+static void dispatch(sim_vector_t vector) {
+    sim_time_t entry;
+    sim_time_t spent;
+    unsigned int pending;
+    unsigned int bit;
+    sim_time_t first_edge = 0;
+    unsigned char found = 0;
+    unsigned char port2 = (vector == sim_board_port2_vector());
+    unsigned char was_off = cpu_off;
+
+    sim_account();
+    cpu_off = 0;                                // The ISR wakes the CPU
+    set_gie(0);
+    sim_isr_depth++;
+    sim_stats.interrupts++;
+    sim_now += sim_cycles(ISR_ENTRY_CYCLES, sim_board_mclk_hz());
+    entry = sim_now;
+
+    if (port2) {
+        pending = sim_reg_P2IFG & sim_reg_P2IE & 0xFF;
+        for (bit = 0; bit < 8; bit++) {
+            if ((pending & (1u << bit)) && (!found || port2_edge_time[bit] < first_edge)) {
+                first_edge = port2_edge_time[bit];
+                found = 1;
+            }
+        }
+        if (found && entry - first_edge > sim_stats.port2_worst_latency) {
+            sim_stats.port2_worst_latency = entry - first_edge;
+        }
+    }
+
+    vector();
+
+    sim_now += sim_cycles(ISR_RETI_CYCLES, sim_board_mclk_hz());
+    if (port2) {
+        spent = sim_now - entry + sim_cycles(ISR_ENTRY_CYCLES, sim_board_mclk_hz());
+        sim_stats.port2_isr_cycles += spent;
+        if (spent > sim_stats.port2_worst_isr) {
+            sim_stats.port2_worst_isr = spent;
+        }
+        if (sim_port2_isr_sink) {
+            sim_port2_isr_sink(spent);
+        }
+    }
+    sim_isr_depth--;
+    sim_account();
+    cpu_off = was_off;
+    set_gie(1);                                 // RETI restores SR
+}
+
+// Flags that went from pending to clear without a P2IV read were written
+// off by the firmware. Checked before every register access, so the write
+// made through the previous access is seen.
+static void port2_check_cleared(void) {
+    unsigned int lost = port2_unserviced & ~sim_reg_P2IFG;
+
+    while (lost) {
+        sim_stats.port2_cleared++;
+        port2_unserviced &= ~(lost & -lost);
+        lost &= lost - 1;
+    }
+}
+
+void sim_service(void) {
+    sim_vector_t vector;
+
+    port2_check_cleared();
+    while (sim_gie && (vector = sim_board_pending()) != 0) {
+        dispatch(vector);
+    }
+}
+
+// Sleep until an ISR requests wake-up; ends the run past run_until
+static void sleep_until_woken(void) {
+    int i;
+
+    sim_account();
+    cpu_off = 1;
+    set_gie(1);
+    lpm_exit = 0;
+    for (;;) {
+        sim_service();
+        if (lpm_exit) {
+            lpm_exit = 0;
+            sim_account();
+            cpu_off = 0;
+            return;
+        }
+        i = next_event();
+        if (i < 0 || events[i].at > run_until) {
+            if (sim_now < run_until) {
+                sim_now = run_until;
+            }
+            sim_account();
+            cpu_off = 0;
+            if (running) {
+                longjmp(run_exit, 1);
+            }
+            return;
+        }
+        run_events(events[i].at);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Intrinsics
+//-----------------------------------------------------------------------------
+void __delay_cycles(unsigned long cycles) {
+    sim_advance(cycles);
+}
+
+void __no_operation(void) {
+    sim_advance(1);
+}
+
+void __enable_interrupt(void) {
+    set_gie(1);
+    sim_service();
+}
+
+void __disable_interrupt(void) {
+    set_gie(0);
+}
+
+unsigned short __get_interrupt_state(void) {
+    return sim_gie ? GIE : 0;
+}
+
+void __set_interrupt_state(unsigned short state) {
+    set_gie((state & GIE) ? 1 : 0);
+    sim_service();
+}
+
+void __bis_SR_register(unsigned short bits) {
+    if (bits & CPUOFF) {
+        sleep_until_woken();
+    } else if (bits & GIE) {
+        __enable_interrupt();
+    }
+}
+
+void __bic_SR_register(unsigned short bits) {
+    if (bits & GIE) {
+        __disable_interrupt();
+    }
+}
+
+void __bic_SR_register_on_exit(unsigned short bits) {
+    if (bits & CPUOFF) {
+        lpm_exit = 1;
+    }
+}
+
+void __low_power_mode_3(void) {
+    sleep_until_woken();
+}
+
+void __low_power_mode_off_on_exit(void) {
+    lpm_exit = 1;
+}
+
+//-----------------------------------------------------------------------------
+// Register accessors
+//-----------------------------------------------------------------------------
+volatile unsigned int* sim_io(volatile unsigned int* reg) {
+    sim_advance(1);
+    return reg;
+}
+
+volatile unsigned char* sim_io_byte(volatile unsigned int* reg, unsigned int high) {
+    sim_advance(1);
+    return (volatile unsigned char*)reg + (high ? 1 : 0);
+}
+
+volatile unsigned int* sim_io_status(volatile unsigned int* reg, unsigned int set, unsigned int clear) {
+    sim_advance(1);
+    *reg = (*reg | set) & ~clear;
+    return reg;
+}
+
+// Timer counter: ACLK or SMCLK through the ID divider (SMCLK taken as
+// constant since reset).
+// The count is not wrapped at 16 bits so tick differences taken in a
+// 32-bit host int stay correct.
+unsigned int sim_timer_count(volatile unsigned int* ctl) {
+    unsigned long long ticks;
+
+    sim_advance(1);
+    ticks = ((*ctl & 0x0300) == 0x0100) ? sim_aclk_ticks()
+                                        : sim_now * sim_board_smclk_hz() / SIM_TICK_HZ;
+    return (unsigned int)(ticks >> ((*ctl >> 6) & 0x3));
+}
+
+// CCR0 compare of a continuous-mode ACLK timer. An access to the CCR
+// re-arms the match from the value it holds once the access is done, so a
+// write is seen; the match sets CCIFG and recurs every 65536 counts. The
+// firmware only uses one such channel.
+typedef struct {
+    volatile unsigned int* ccr;
+    volatile unsigned int* ctl;
+    volatile unsigned int* cctl;
+} SimCompare;
+
+static SimCompare compare;
+
+static void compare_arm(void* arg);
+
+static void compare_match(void* arg) {
+    SimCompare* c = arg;
+
+    *c->cctl |= CCIFG;
+    compare_arm(c);
+}
+
+static void compare_arm(void* arg) {
+    SimCompare* c = arg;
+    unsigned int shift = (*c->ctl >> 6) & 0x3;
+    unsigned long long count;
+    unsigned long long target;
+
+    sim_cancel(compare_match, c);
+    if ((*c->ctl & 0x0030) != MC__CONTINUOUS || (*c->ctl & 0x0300) != 0x0100) {
+        return;
+    }
+    count = sim_aclk_ticks() >> shift;
+    target = count + (((*c->ccr - count) & 0xFFFF) ? ((*c->ccr - count) & 0xFFFF) : 0x10000);
+    sim_schedule(((target << shift) * SIM_TICK_HZ + SIM_ACLK_HZ - 1) / SIM_ACLK_HZ, compare_match, c);
+}
+
+volatile unsigned int* sim_timer_ccr(volatile unsigned int* ccr, volatile unsigned int* ctl,
+                                     volatile unsigned int* cctl) {
+    sim_advance(1);
+    compare.ccr = ccr;
+    compare.ctl = ctl;
+    compare.cctl = cctl;
+    sim_cancel(compare_arm, &compare);
+    sim_schedule(sim_now, compare_arm, &compare);
+    return ccr;
+}
+
+unsigned int sim_adc_result(unsigned int channel) {
+    sim_advance_ticks(SIM_TICK_HZ / 20000);     // ~50 us sample and convert
+    return sim_board_adc(channel);
+}
+
+//-----------------------------------------------------------------------------
+// eUSCI_A1 UART
+//-----------------------------------------------------------------------------
+static void uart_tx_done(void* arg) {
+    (void)arg;
+    sim_stats.uart_tx_bytes++;
+    if (sim_uart_tx_sink) {
+        sim_uart_tx_sink((unsigned char)uart_tx_latch);
+    }
+    sim_reg_UCA1STATW &= ~UCBUSY;
+    sim_reg_UCA1IFG |= UCTXIFG;
+}
+
+// A TXBUF write starts a 10-bit frame at the programmed bit rate:
+// BRW BRCLK cycles a bit, or 16 x BRW + UCBRF with oversampling (UCBRS
+// modulation averages out over a frame and is ignored)
+volatile unsigned int* sim_uart_txbuf(void) {
+    unsigned long bit_cycles = sim_reg_UCA1BRW;
+
+    sim_advance(1);
+    if (sim_reg_UCA1MCTLW & UCOS16) {
+        bit_cycles = 16 * bit_cycles + ((sim_reg_UCA1MCTLW >> 4) & 0xF);
+    }
+    if (bit_cycles == 0) {
+        bit_cycles = 1;
+    }
+    sim_reg_UCA1IFG &= ~UCTXIFG;
+    sim_reg_UCA1STATW |= UCBUSY;
+    sim_schedule(sim_now + sim_cycles(10ULL * bit_cycles, sim_board_smclk_hz()), uart_tx_done, 0);
+    return &uart_tx_latch;
+}
+
+// Reading UCA1IV returns and clears the highest pending enabled flag
+unsigned int sim_uart_iv(void) {
+    unsigned int active;
+
+    sim_advance(1);
+    active = sim_reg_UCA1IFG & sim_reg_UCA1IE;
+    if (active & UCRXIFG) {
+        sim_reg_UCA1IFG &= ~UCRXIFG;
+        return USCI_UART_UCRXIFG;
+    }
+    if (active & UCTXIFG) {
+        sim_reg_UCA1IFG &= ~UCTXIFG;
+        return USCI_UART_UCTXIFG;
+    }
+    return USCI_NONE;
+}
+
+void sim_uart_rx(unsigned char byte) {
+    sim_reg_UCA1RXBUF = byte;
+    sim_reg_UCA1IFG |= UCRXIFG;
+    sim_service();
+}
+
+//-----------------------------------------------------------------------------
+// PORT2 and SPI
+//-----------------------------------------------------------------------------
+void sim_port2_edge(unsigned int bits) {
+    unsigned int bit;
+
+    port2_check_cleared();
+    for (bit = 0; bit < 8; bit++) {
+        if (!(bits & (1u << bit))) {
+            continue;
+        }
+        sim_stats.port2_edges++;
+        if (sim_reg_P2IFG & (1u << bit)) {
+            sim_stats.port2_merged++;           // Flag still set: edge lost
+        } else {
+            sim_reg_P2IFG |= (1u << bit);
+            port2_edge_time[bit] = sim_now;
+            if (sim_reg_P2IE & (1u << bit)) {
+                port2_unserviced |= (1u << bit);
+            }
+        }
+    }
+    sim_service();
+}
+
+// Reading P2IV returns and clears the highest priority (lowest numbered)
+// pending enabled flag
+unsigned int sim_port2_iv(void) {
+    unsigned int active;
+    unsigned int bit;
+
+    sim_advance(1);
+    active = sim_reg_P2IFG & sim_reg_P2IE & 0xFF;
+    for (bit = 0; bit < 8; bit++) {
+        if (active & (1u << bit)) {
+            sim_reg_P2IFG &= ~(1u << bit);
+            port2_unserviced &= ~(1u << bit);
+            return 2 * (bit + 1);
+        }
+    }
+    return P2IV__NONE;
+}
+
+// One byte at SMCLK / UCB0BRW; with the card selected this is card time
+unsigned char sim_spi_xfer(unsigned char data) {
+    sim_time_t ticks = sim_cycles(8 * sim_board_spi_divider() + SPI_BYTE_OVERHEAD,
+                                  sim_board_smclk_hz());
+    int selected = sim_board_cs_selected();
+
+    if (selected && sim_spi_device) {
+        sim_clock_stats()->card += ticks;
+    }
+    sim_advance_ticks(ticks);
+    sim_stats.spi_bytes++;
+    if (sim_spi_device) {
+        return sim_spi_device(data, selected);
+    }
+    return 0xFF;                                // Nothing driving MISO
+}
+
+//-----------------------------------------------------------------------------
+// Run control
+//-----------------------------------------------------------------------------
+void sim_reset(void) {
+#define SIM_CLEAR_REGISTER(name) sim_reg_##name = 0;
+    SIM_REGISTERS(SIM_CLEAR_REGISTER)
+#undef SIM_CLEAR_REGISTER
+
+    sim_now = 0;
+    accounted_at = 0;
+    cpu_off = 0;
+    sim_gie = 0;
+    sim_isr_depth = 0;
+    gie_seen = 0;
+    event_count = 0;
+    lpm_exit = 0;
+    memset(&sim_stats, 0, sizeof(sim_stats));
+    memset(port2_edge_time, 0, sizeof(port2_edge_time));
+    port2_unserviced = 0;
+
+    sim_reg_PM5CTL0 = LOCKLPM5;
+    sim_reg_UCA1IFG = UCTXIFG;
+    sim_board_reset();
+}
+
+void sim_clear_stats(void) {
+    memset(&sim_stats, 0, sizeof(sim_stats));
+    masked_since = sim_now;
+    accounted_at = sim_now;
+}
+
+void sim_run(int (*entry)(void), sim_time_t until) {
+    run_until = until;
+    running = 1;
+    if (setjmp(run_exit) == 0) {
+        entry();
+    }
+    running = 0;
+}
@@ -0,0 +1,573 @@
+// sd_card.c
+// SD card model for the TIGR host simulator
+// See include/sd_card.h.
+
+#define _FILE_OFFSET_BITS 64
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include "sim.h"
+#include "sd_card.h"
+
+#define BLOCK_SIZE          512
+#define OUT_QUEUE_SIZE      (BLOCK_SIZE + 8)
+
+#define R1_IDLE             0x01
+#define R1_ILLEGAL_CMD      0x04
+#define R1_CRC_ERROR        0x08
+#define R1_ADDRESS_ERROR    0x20
+#define R1_PARAM_ERROR      0x40
+
+#define TOKEN_START_BLOCK   0xFE
+#define TOKEN_START_MULTI   0xFC
+#define TOKEN_STOP_MULTI    0xFD
+
+#define DATA_ACCEPTED       0x05
+#define DATA_CRC_ERROR      0x0B
+
+#define OCR_VOLTAGES        0x00FF8000UL    // 2.7-3.6 V
+#define OCR_POWER_UP        0x80000000UL
+#define OCR_CCS             0x40000000UL
+#define ACMD41_HCS          0x40000000UL
+
+// Single-block program time. Rough shapes from vendor write figures; stall
+// maxima stay inside the 250 ms write timeout of the SD Physical Layer spec.
+static const SdBusyProfile busy_profiles[] = {
+    { "industrial",  250.0, 0.25, 0.001,  1.0,   5.0 },     // SLC, small FTL
+    { "consumer",    700.0, 0.50, 0.010, 10.0,  80.0 },     // Typical class 10
+    { "worst",      1500.0, 0.70, 0.030, 50.0, 250.0 },     // Worn or cheap card
+};
+
+typedef enum {
+    MODE_COMMAND,                       // Waiting for / receiving a command
+    MODE_WRITE_TOKEN,                   // CMD24/25 accepted, waiting for a token
+    MODE_WRITE_DATA,                    // Receiving a block and its CRC
+    MODE_READ_MULTI                     // CMD18 streaming until CMD12
+} SdMode;
+
+static struct {
+    FILE* image;
+    SdCardConfig config;
+    unsigned char present;
+    unsigned char idle;                 // R1 idle bit
+    unsigned char app_cmd;              // Last command was CMD55
+    unsigned int polls_left;
+    SdMode mode;
+    unsigned char multi_write;
+    unsigned char cmd[6];
+    unsigned int cmd_len;
+    unsigned long block;                // Current read/write block
+    unsigned char data[BLOCK_SIZE + 2];
+    unsigned int data_len;
+    unsigned char out[OUT_QUEUE_SIZE];
+    unsigned int out_head;
+    unsigned int out_len;
+    sim_time_t busy_until;
+    unsigned long long rng;
+} card;
+
+SdCardStats sd_card_stats;
+
+//-----------------------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------------------
+static double card_uniform(void) {
+    card.rng ^= card.rng >> 12;
+    card.rng ^= card.rng << 25;
+    card.rng ^= card.rng >> 27;
+    return (double)((card.rng * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+}
+
+static double card_normal(void) {
+    double u1 = card_uniform();
+    double u2 = card_uniform();
+
+    return sqrt(-2.0 * log(1.0 - u1)) * cos(6.283185307179586 * u2);
+}
+
+static unsigned char crc7(const unsigned char* data, unsigned int length) {
+    unsigned char crc = 0;
+    unsigned int i;
+    unsigned char bit;
+
+    for (i = 0; i < length; i++) {
+        for (bit = 0x80; bit; bit >>= 1) {
+            crc <<= 1;
+            if (((data[i] & bit) != 0) ^ ((crc & 0x80) != 0)) {
+                crc ^= 0x09;
+            }
+        }
+    }
+    return crc & 0x7F;
+}
+
+static unsigned int crc16(const unsigned char* data, unsigned int length) {
+    unsigned int crc = 0;
+    unsigned int i;
+    unsigned char bit;
+
+    for (i = 0; i < length; i++) {
+        crc ^= (unsigned int)data[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc & 0xFFFF;
+}
+
+static void queue_byte(unsigned char byte) {
+    if (card.out_len < OUT_QUEUE_SIZE) {
+        card.out[(card.out_head + card.out_len) % OUT_QUEUE_SIZE] = byte;
+        card.out_len++;
+    }
+}
+
+static void queue_r1(unsigned char flags) {
+    queue_byte(0xFF);                               // N_CR = 1
+    queue_byte(flags | card.idle);
+}
+
+static void image_read(unsigned long block, unsigned char* buffer) {
+    memset(buffer, 0, BLOCK_SIZE);
+    if (fseeko(card.image, (off_t)block * BLOCK_SIZE, SEEK_SET) == 0) {
+        if (fread(buffer, 1, BLOCK_SIZE, card.image) != BLOCK_SIZE) {
+            clearerr(card.image);
+        }
+    }
+}
+
+static void image_write(unsigned long block, const unsigned char* buffer) {
+    if (fseeko(card.image, (off_t)block * BLOCK_SIZE, SEEK_SET) != 0 ||
+        fwrite(buffer, 1, BLOCK_SIZE, card.image) != BLOCK_SIZE) {
+        fprintf(stderr, "sd_card: image write failed at block %lu\n", block);
+    }
+}
+
+static void queue_block(unsigned long block) {
+    unsigned char buffer[BLOCK_SIZE];
+    unsigned int crc;
+    unsigned int i;
+
+    image_read(block, buffer);
+    crc = crc16(buffer, BLOCK_SIZE);
+    queue_byte(0xFF);                               // N_AC
+    queue_byte(TOKEN_START_BLOCK);
+    for (i = 0; i < BLOCK_SIZE; i++) {
+        queue_byte(buffer[i]);
+    }
+    queue_byte(crc >> 8);
+    queue_byte(crc & 0xFF);
+    sd_card_stats.blocks_read++;
+}
+
+// CSD register, v1 (SDSC) or v2 (SDHC) layout
+static void queue_csd(void) {
+    unsigned char csd[16];
+    unsigned long c_size;
+    unsigned int read_bl_len = 9;
+    unsigned int c_size_mult = 7;
+    unsigned int i;
+
+    memset(csd, 0, sizeof(csd));
+    csd[1] = 0x0E;                                  // TAAC 1 ms
+    csd[3] = 0x32;                                  // TRAN_SPEED 25 MHz
+    csd[4] = 0x5B;                                  // CCC
+    if (card.config.high_capacity) {
+        c_size = card.config.sectors / 1024 - 1;    // 512 KiB units
+        csd[0] = 0x40;
+        csd[5] = 0x59;
+        csd[7] = (c_size >> 16) & 0x3F;
+        csd[8] = (c_size >> 8) & 0xFF;
+        csd[9] = c_size & 0xFF;
+    } else {
+        // (C_SIZE + 1) * 2^(C_SIZE_MULT + 2) * 2^READ_BL_LEN bytes
+        if (card.config.sectors > 4096UL * 512UL) {
+            read_bl_len = 10;                       // 2 GB cards
+        }
+        c_size = (card.config.sectors >> (c_size_mult + 2 + read_bl_len - 9)) - 1;
+        csd[5] = 0x50 | read_bl_len;
+        csd[6] = (c_size >> 10) & 0x03;
+        csd[7] = (c_size >> 2) & 0xFF;
+        csd[8] = (c_size & 0x03) << 6;
+        csd[9] = (c_size_mult >> 1) & 0x03;
+        csd[10] = (c_size_mult & 0x01) << 7;
+    }
+    csd[15] = (crc7(csd, 15) << 1) | 0x01;
+
+    queue_byte(0xFF);
+    queue_byte(TOKEN_START_BLOCK);
+    for (i = 0; i < sizeof(csd); i++) {
+        queue_byte(csd[i]);
+    }
+    i = crc16(csd, sizeof(csd));
+    queue_byte(i >> 8);
+    queue_byte(i & 0xFF);
+}
+
+// Card address to block, or -1 with *error set
+static long address_to_block(unsigned long address, unsigned char* error) {
+    unsigned long block = address;
+
+    if (!card.config.high_capacity) {
+        if (address % BLOCK_SIZE) {
+            *error = R1_ADDRESS_ERROR;
+            return -1;
+        }
+        block = address / BLOCK_SIZE;
+    }
+    if (block >= card.config.sectors) {
+        *error = R1_PARAM_ERROR;
+        return -1;
+    }
+    return (long)block;
+}
+
+// Power-on state, as after insertion
+static void card_power_on(void) {
+    card.idle = R1_IDLE;
+    card.app_cmd = 0;
+    card.polls_left = card.config.init_polls;
+    card.mode = MODE_COMMAND;
+    card.cmd_len = 0;
+    card.out_len = 0;
+    card.busy_until = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Commands
+//-----------------------------------------------------------------------------
+static void init_poll(void) {
+    if (card.polls_left > 0) {
+        card.polls_left--;
+    } else {
+        card.idle = 0;
+    }
+    queue_r1(0);
+}
+
+static void execute_command(void) {
+    unsigned char index = card.cmd[0] & 0x3F;
+    unsigned long arg = ((unsigned long)card.cmd[1] << 24) | ((unsigned long)card.cmd[2] << 16) |
+                        ((unsigned long)card.cmd[3] << 8) | card.cmd[4];
+    unsigned char app = card.app_cmd;
+    unsigned char error = 0;
+    unsigned long ocr;
+    long block;
+
+    sd_card_stats.commands++;
+    card.app_cmd = 0;
+
+    // CRC is off in SPI mode except for CMD0 and CMD8
+    if ((index == 0 || index == 8) && (card.cmd[5] >> 1) != crc7(card.cmd, 5)) {
+        queue_r1(R1_CRC_ERROR);
+        return;
+    }
+    // Only initialization commands are legal while idle
+    if (card.idle && index != 0 && index != 1 && index != 8 && index != 55 &&
+        index != 58 && !(app && index == 41)) {
+        queue_r1(R1_ILLEGAL_CMD);
+        return;
+    }
+
+    switch (index) {
+        case 0:                                     // GO_IDLE_STATE
+            card_power_on();
+            queue_r1(0);
+            break;
+        case 1:                                     // SEND_OP_COND (SDSC only)
+            if (card.config.high_capacity) {
+                queue_r1(R1_ILLEGAL_CMD);
+            } else {
+                init_poll();
+            }
+            break;
+        case 8:                                     // SEND_IF_COND (v2 cards)
+            if (!card.config.high_capacity) {
+                queue_r1(R1_ILLEGAL_CMD);
+            } else {
+                queue_r1(0);
+                queue_byte(0x00);
+                queue_byte(0x00);
+                queue_byte(card.cmd[3] & 0x0F);
+                queue_byte(card.cmd[4]);
+            }
+            break;
+        case 9:                                     // SEND_CSD
+            queue_r1(0);
+            queue_csd();
+            break;
+        case 12:                                    // STOP_TRANSMISSION
+            card.out_len = 0;
+            card.mode = MODE_COMMAND;
+            queue_byte(0xFF);                       // Stuff byte
+            queue_r1(0);
+            break;
+        case 13:                                    // SEND_STATUS (R2)
+            queue_r1(0);
+            queue_byte(0x00);
+            break;
+        case 16:                                    // SET_BLOCKLEN
+            queue_r1((arg == BLOCK_SIZE || card.config.high_capacity) ? 0 : R1_PARAM_ERROR);
+            break;
+        case 17:                                    // READ_SINGLE_BLOCK
+        case 18:                                    // READ_MULTIPLE_BLOCK
+            block = address_to_block(arg, &error);
+            queue_r1(error);
+            if (block >= 0) {
+                card.block = (unsigned long)block;
+                queue_block(card.block++);
+                if (index == 18) {
+                    card.mode = MODE_READ_MULTI;
+                }
+            }
+            break;
+        case 24:                                    // WRITE_BLOCK
+        case 25:                                    // WRITE_MULTIPLE_BLOCK
+            block = address_to_block(arg, &error);
+            queue_r1(error);
+            if (block >= 0) {
+                card.block = (unsigned long)block;
+                card.multi_write = (index == 25);
+                card.mode = MODE_WRITE_TOKEN;
+            }
+            break;
+        case 41:                                    // ACMD41 SD_SEND_OP_COND
+            if (card.config.high_capacity && !(arg & ACMD41_HCS)) {
+                queue_r1(0);                        // SDHC never leaves idle without HCS
+            } else {
+                init_poll();
+            }
+            break;
+        case 55:                                    // APP_CMD
+            card.app_cmd = 1;
+            queue_r1(0);
+            break;
+        case 58:                                    // READ_OCR (R3)
+            ocr = OCR_VOLTAGES;
+            if (!card.idle) {
+                ocr |= OCR_POWER_UP;
+                if (card.config.high_capacity) {
+                    ocr |= OCR_CCS;
+                }
+            }
+            queue_r1(0);
+            queue_byte(ocr >> 24);
+            queue_byte(ocr >> 16);
+            queue_byte(ocr >> 8);
+            queue_byte(ocr);
+            break;
+        default:
+            queue_r1(R1_ILLEGAL_CMD);
+            break;
+    }
+}
+
+// A complete block (data + CRC) has arrived
+static void program_block(void) {
+    const SdBusyProfile* busy = card.config.busy;
+    double busy_us = 0.0;
+    sim_time_t cycles;
+
+    if (card_uniform() < card.config.crc_error_rate) {
+        sd_card_stats.crc_errors++;
+        queue_byte(DATA_CRC_ERROR);
+        card.mode = card.multi_write ? MODE_WRITE_TOKEN : MODE_COMMAND;
+        return;
+    }
+
+    image_write(card.block++, card.data);
+    sd_card_stats.blocks_written++;
+    sim_clock_stats()->sectors++;
+    queue_byte(DATA_ACCEPTED);
+
+    if (busy) {
+        busy_us = busy->typical_us * exp(busy->sigma * card_normal());
+        if (card_uniform() < busy->stall_rate) {
+            busy_us = 1000.0 * (busy->stall_min_ms +
+                                card_uniform() * (busy->stall_max_ms - busy->stall_min_ms));
+        }
+    }
+    if (card_uniform() < card.config.stuck_busy_rate) {
+        sd_card_stats.stuck_busy++;
+        busy_us = 1000.0 * card.config.stuck_busy_ms;
+    }
+    cycles = sim_seconds(busy_us * 1e-6);
+    card.busy_until = sim_now + cycles;
+    sd_card_stats.busy_cycles += cycles;
+    if (cycles > sd_card_stats.worst_busy) {
+        sd_card_stats.worst_busy = cycles;
+    }
+    card.mode = card.multi_write ? MODE_WRITE_TOKEN : MODE_COMMAND;
+}
+
+//-----------------------------------------------------------------------------
+// SPI
+//-----------------------------------------------------------------------------
+// One full-duplex byte: shift out the queued response (or busy / idle
+// level) while taking in mosi
+static unsigned char card_spi(unsigned char mosi, int selected) {
+    unsigned char miso = 0xFF;
+    unsigned char busy = sim_now < card.busy_until;
+
+    if (!card.present) {
+        return 0xFF;                                // DO floating, pulled up
+    }
+    if (!selected) {
+        card.out_len = 0;                           // Deselect drops the response
+        card.cmd_len = 0;
+        if (card.mode == MODE_WRITE_DATA) {
+            card.mode = MODE_COMMAND;
+        }
+        return 0xFF;
+    }
+
+    if (card.out_len > 0) {
+        miso = card.out[card.out_head];
+        card.out_head = (card.out_head + 1) % OUT_QUEUE_SIZE;
+        card.out_len--;
+    } else if (busy) {
+        miso = 0x00;
+    }
+
+    switch (card.mode) {
+        case MODE_WRITE_TOKEN:
+            if (busy || card.out_len > 0) {
+                break;
+            }
+            if (mosi == TOKEN_START_BLOCK || (card.multi_write && mosi == TOKEN_START_MULTI)) {
+                card.data_len = 0;
+                card.mode = MODE_WRITE_DATA;
+            } else if (card.multi_write && mosi == TOKEN_STOP_MULTI) {
+                queue_byte(0xFF);
+                card.busy_until = sim_now + sim_seconds(20e-6);
+                card.mode = MODE_COMMAND;
+            } else if ((mosi & 0xC0) == 0x40) {
+                card.mode = MODE_COMMAND;           // Host gave up on the write
+                card.cmd[0] = mosi;
+                card.cmd_len = 1;
+            }
+            break;
+
+        case MODE_WRITE_DATA:
+            card.data[card.data_len++] = mosi;
+            if (card.data_len == BLOCK_SIZE + 2) {
+                program_block();
+            }
+            break;
+
+        case MODE_READ_MULTI:
+            if (card.cmd_len == 0 && (mosi & 0xC0) != 0x40) {
+                if (card.out_len == 0) {
+                    if (card.block < card.config.sectors) {
+                        queue_block(card.block++);
+                    }
+                }
+                break;
+            }
+            // fall through: CMD12 arrives while data streams
+        case MODE_COMMAND:
+            if (busy) {
+                break;
+            }
+            if (card.cmd_len == 0 && (mosi & 0xC0) != 0x40) {
+                break;
+            }
+            card.cmd[card.cmd_len++] = mosi;
+            if (card.cmd_len == 6) {
+                card.cmd_len = 0;
+                execute_command();
+            }
+            break;
+    }
+    return miso;
+}
+
+//-----------------------------------------------------------------------------
+// Insertion and removal
+//-----------------------------------------------------------------------------
+void sd_card_insert(int inserted) {
+    if (card.present && !inserted) {
+        sd_card_stats.removals++;
+    }
+    card.present = inserted ? 1 : 0;
+    card_power_on();
+    sim_board_card_detect(card.present);
+}
+
+static void remove_event(void* arg) {
+    (void)arg;
+    sd_card_insert(0);
+}
+
+static void reinsert_event(void* arg) {
+    (void)arg;
+    sd_card_insert(1);
+}
+
+//-----------------------------------------------------------------------------
+// Setup
+//-----------------------------------------------------------------------------
+const SdBusyProfile* sd_card_busy_profile(const char* name) {
+    unsigned int i;
+
+    for (i = 0; i < sizeof(busy_profiles) / sizeof(busy_profiles[0]); i++) {
+        if (!strcmp(name, busy_profiles[i].name)) {
+            return &busy_profiles[i];
+        }
+    }
+    return 0;
+}
+
+void sd_card_default_config(SdCardConfig* config) {
+    memset(config, 0, sizeof(*config));
+    config->sectors = 2UL * 1024 * 1024;            // 1 GB SDSC
+    config->busy = &busy_profiles[1];
+    config->init_polls = 20;
+    config->seed = 1;
+    config->stuck_busy_ms = 1000.0;
+    config->remove_at_s = -1.0;
+    config->reinsert_at_s = -1.0;
+}
+
+int sd_card_open(const char* image_path, const SdCardConfig* config) {
+    memset(&card, 0, sizeof(card));
+    memset(&sd_card_stats, 0, sizeof(sd_card_stats));
+    card.config = *config;
+    card.rng = 0x2545F4914F6CDD1DULL ^ config->seed;
+
+    card.image = fopen(image_path, "r+b");
+    if (!card.image) {
+        card.image = fopen(image_path, "w+b");
+    }
+    if (!card.image) {
+        perror(image_path);
+        return -1;
+    }
+    // Grow to full size without allocating: unwritten sectors read as zero
+    fseeko(card.image, 0, SEEK_END);
+    if (ftello(card.image) < (off_t)config->sectors * BLOCK_SIZE &&
+        ftruncate(fileno(card.image), (off_t)config->sectors * BLOCK_SIZE) != 0) {
+        perror(image_path);
+    }
+
+    sim_spi_device = card_spi;
+    sd_card_insert(1);
+    if (config->remove_at_s >= 0.0) {
+        sim_schedule(sim_seconds(config->remove_at_s), remove_event, 0);
+    }
+    if (config->reinsert_at_s >= 0.0) {
+        sim_schedule(sim_seconds(config->reinsert_at_s), reinsert_event, 0);
+    }
+    return 0;
+}
+
+void sd_card_close(void) {
+    if (card.image) {
+        fclose(card.image);
+        card.image = 0;
+    }
+    sim_spi_device = 0;
+}
@@ -0,0 +1,446 @@
+// sim_main.c
+// Command line driver for the TIGR host simulator
+//
+// Runs the unmodified firmware main loop for a span of simulated time
+// while injecting Poisson muon arrivals on the four band inputs, with an
+// optional emulated SD card behind the SPI bus.
+//
+//   tigr_sim_fr6989 --seconds 120 --rate 2 --uart uart.bin
+//   tigr_sim_fr2355 --seconds 600 --rate 5 --sd card.img --sd-busy worst
+//   tigr_sim_fr2355 --rate 2000 --weights 4,3,2,1 --burst 0.05 --report
+//
+// Arrivals start after --warmup seconds (boot and card init) and the
+// measurement window covers the following --seconds. --burst is the
+// fraction of arrivals that are coincident showers hitting 2-4 bands at
+// the same instant. A given seed always produces the same run.
+//
+// --brownout S[,MVPS] lets the supply fall from --avcc by MVPS mV per
+// second (default 5) from S seconds into the window, and ends the run
+// where SVSH would reset the CPU. The report then shows what the
+// power-fail commit (supply.h) left in FRAM, and what a reset there loses.
+//
+// --ringing P[,US] gives a fraction P of arrivals a second falling edge on
+// the same bands US microseconds later (default 5), as a ringing
+// comparator would. Build with FW_DEFS=-DHOLDOFF_DEFAULT_US=n to hold them
+// off (holdoff.h).
+//
+// --isr FILE writes the length of every detection ISR in the window, one
+// per line in microseconds, so the paths can be told apart (stress_bench.py
+// --paths).
+//
+// --fram FILE writes the FRAM log as a READ over the UART would dump it,
+// for FR6989 builds with FW_DEFS=-DLOG_FRAM=1 (fram_log.h).
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "msp430.h"
+#include "sim.h"
+#include "sd_card.h"
+#include "tigr_config.h"
+#include "log_manager.h"
+#include "sd_utils.h"
+// The FRAM log is FR6989 only: tigr_config.h turns LOG_FRAM off elsewhere
+#if LOG_FRAM
+#define SIM_FRAM_LOG 1
+#include "fram_log.h"
+#else
+#define SIM_FRAM_LOG 0
+#endif
+
+int tigr_firmware_main(void);
+
+static unsigned long long rng_state = 0x9E3779B97F4A7C15ULL;
+static double arrival_rate = 0.0;
+static double band_weight[4] = { 1.0, 1.0, 1.0, 1.0 };     // Bands 1-4
+static double burst_fraction = 0.0;
+static FILE* uart_file = 0;
+static FILE* isr_file = 0;
+static const char* fram_dump = 0;
+
+// Supply ramp (--brownout)
+#define SIM_SVSH_MV         1800            // SVSH reset level
+#define SUPPLY_STEP_S       0.1
+static double brownout_at = -1.0;           // Seconds into the window, < 0 = off
+static double brownout_mvps = 5.0;
+static double supply_mv = 0.0;
+
+// Comparator ringing (--ringing)
+static double ring_fraction = 0.0;
+static double ring_us = 5.0;
+static unsigned long ring_edges = 0;
+
+// Measurement window
+static sim_time_t window_start = 0;
+static unsigned int counted_base = 0;
+static unsigned long arrivals = 0;
+static unsigned long edges_injected = 0;
+static unsigned long bursts = 0;
+
+// xorshift64*: identical sequence on every host for a given seed
+static double rng_uniform(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (double)((rng_state * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+}
+
+static sim_time_t next_interval(void) {
+    return sim_seconds(-log(1.0 - rng_uniform()) / arrival_rate);
+}
+
+// Band 1-4 drawn by weight
+static unsigned char pick_band(void) {
+    double total = band_weight[0] + band_weight[1] + band_weight[2] + band_weight[3];
+    double x = rng_uniform() * total;
+    unsigned char band;
+
+    for (band = 1; band < 4; band++) {
+        if (x < band_weight[band - 1]) {
+            break;
+        }
+        x -= band_weight[band - 1];
+    }
+    return band;
+}
+
+static unsigned int count_bits(unsigned int bits) {
+    unsigned int n = 0;
+
+    for (; bits; bits &= bits - 1) {
+        n++;
+    }
+    return n;
+}
+
+static void ring_edge(void* arg) {
+    unsigned int bits = (unsigned int)(unsigned long)arg;
+
+    ring_edges += count_bits(bits);
+    sim_port2_edge(bits);
+}
+
+static void muon_arrival(void* arg) {
+    unsigned int bits = sim_board_band_bit(pick_band());
+    unsigned int active = 0;
+    unsigned int want;
+    unsigned char band;
+
+    (void)arg;
+    // Schedule the next arrival first: the edge below may run the ISR
+    sim_schedule(sim_now + next_interval(), muon_arrival, 0);
+    arrivals++;
+    if (burst_fraction > 0.0 && rng_uniform() < burst_fraction) {
+        for (band = 0; band < 4; band++) {
+            active += band_weight[band] > 0.0;
+        }
+        want = 2 + (unsigned int)(rng_uniform() * 3.0);
+        if (want > active) {
+            want = active;
+        }
+        while (count_bits(bits) < want) {
+            bits |= sim_board_band_bit(pick_band());
+        }
+        bursts++;
+    }
+    if (ring_fraction > 0.0 && rng_uniform() < ring_fraction) {
+        sim_schedule(sim_now + sim_seconds(ring_us * 1e-6), ring_edge, (void*)(unsigned long)bits);
+    }
+    edges_injected += count_bits(bits);
+    sim_port2_edge(bits);
+}
+
+static void supply_fall(void* arg) {
+    (void)arg;
+    supply_mv -= brownout_mvps * SUPPLY_STEP_S;
+    if (supply_mv < SIM_SVSH_MV) {
+        supply_mv = SIM_SVSH_MV;
+    }
+    sim_avcc_mv = (unsigned int)supply_mv;
+    if (sim_avcc_mv > SIM_SVSH_MV) {
+        sim_schedule(sim_now + sim_seconds(SUPPLY_STEP_S), supply_fall, 0);
+    }
+}
+
+static void isr_to_file(sim_time_t spent) {
+    fprintf(isr_file, "%.1f\n", 1e6 * sim_to_seconds(spent));
+}
+
+static void window_open(void* arg) {
+    (void)arg;
+    window_start = sim_now;
+    counted_base = muon_count;
+    sim_clear_stats();
+    if (isr_file) {
+        sim_port2_isr_sink = isr_to_file;
+    }
+    if (arrival_rate > 0.0) {
+        sim_schedule(sim_now + next_interval(), muon_arrival, 0);
+    }
+    if (brownout_at >= 0.0) {
+        supply_mv = sim_avcc_mv;
+        sim_schedule(sim_now + sim_seconds(brownout_at), supply_fall, 0);
+    }
+}
+
+// Energy split (sim.h): CPU current at each MCLK, sleep current, card
+// current while clocked. Returns the average supply current over the
+// window and the card-window energy per accepted sector (0 if none).
+static double cpu_ua(const SimClockStats* c) {
+    return sim_board_active_ua_mhz * (double)c->mclk_hz / 1e6;
+}
+
+static double sector_uj(const SimClockStats* c) {
+    double volts = sim_avcc_mv / 1000.0;
+
+    return c->sectors ? sim_to_seconds(c->card) * (SIM_CARD_UA + cpu_ua(c)) * volts / c->sectors : 0.0;
+}
+
+static void energy(double elapsed, double* avg_ua, double* all_sector_uj) {
+    double charge = sim_to_seconds(sim_stats.sleep) * sim_board_sleep_ua;
+    double card_uj = 0.0;
+    unsigned long sectors = 0;
+    const SimClockStats* c;
+
+    for (c = sim_stats.clock; c < sim_stats.clock + SIM_CLOCK_POINTS && c->mclk_hz; c++) {
+        charge += sim_to_seconds(c->active) * cpu_ua(c) + sim_to_seconds(c->card) * SIM_CARD_UA;
+        card_uj += sector_uj(c) * c->sectors;
+        sectors += c->sectors;
+    }
+    *avg_ua = elapsed > 0.0 ? charge / elapsed : 0.0;
+    *all_sector_uj = sectors ? card_uj / sectors : 0.0;
+}
+
+static void uart_to_file(unsigned char byte) {
+    fputc(byte, uart_file);
+}
+
+static void usage(const char* name) {
+    fprintf(stderr,
+            "usage: %s [--seconds S] [--warmup S] [--rate HZ] [--weights W1,W2,W3,W4] [--burst P]\n"
+            "          [--ringing P[,US]] [--seed N] [--temp C] [--avcc MV] [--brownout S[,MVPS]]\n"
+            "          [--uart FILE] [--isr FILE] [--fram FILE] [--report]\n"
+            "          [--sd IMAGE] [--sd-hc] [--sd-mb N] [--sd-busy industrial|consumer|worst|none]\n"
+            "          [--sd-crc P] [--sd-stuck P] [--sd-remove S] [--sd-reinsert S]\n",
+            name);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    double seconds = 60.0;
+    double warmup = 3.0;
+    unsigned long seed = 0;
+    int report = 0;
+    const char* sd_image = 0;
+    SdCardConfig sd;
+    double elapsed;
+    double avg_ua;
+    double all_sector_uj;
+    const SimClockStats* c;
+    unsigned int counted;
+    int i;
+
+    sd_card_default_config(&sd);
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--sd-hc")) {
+            sd.high_capacity = 1;
+            sd.sectors = 16UL * 1024 * 1024;        // 8 GB
+        } else if (!strcmp(argv[i], "--report")) {
+            report = 1;
+        } else if (i + 1 >= argc) {
+            usage(argv[0]);
+        } else if (!strcmp(argv[i], "--seconds")) {
+            seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--warmup")) {
+            warmup = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--rate")) {
+            arrival_rate = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--weights")) {
+            if (sscanf(argv[++i], "%lf,%lf,%lf,%lf", &band_weight[0], &band_weight[1],
+                       &band_weight[2], &band_weight[3]) != 4) {
+                usage(argv[0]);
+            }
+        } else if (!strcmp(argv[i], "--burst")) {
+            burst_fraction = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--ringing")) {
+            if (sscanf(argv[++i], "%lf,%lf", &ring_fraction, &ring_us) < 1 || ring_us < 0.0) {
+                usage(argv[0]);
+            }
+        } else if (!strcmp(argv[i], "--seed")) {
+            seed = strtoul(argv[++i], 0, 0);
+            sd.seed = seed;
+            rng_state ^= seed;
+        } else if (!strcmp(argv[i], "--temp")) {
+            sim_temperature_c = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--avcc")) {
+            sim_avcc_mv = (unsigned int)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--brownout")) {
+            if (sscanf(argv[++i], "%lf,%lf", &brownout_at, &brownout_mvps) < 1 ||
+                brownout_at < 0.0 || brownout_mvps <= 0.0) {
+                usage(argv[0]);
+            }
+        } else if (!strcmp(argv[i], "--uart")) {
+            uart_file = fopen(argv[++i], "wb");
+            if (!uart_file) {
+                perror(argv[i]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "--isr")) {
+            isr_file = fopen(argv[++i], "w");
+            if (!isr_file) {
+                perror(argv[i]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "--fram")) {
+            fram_dump = argv[++i];
+        } else if (!strcmp(argv[i], "--sd")) {
+            sd_image = argv[++i];
+        } else if (!strcmp(argv[i], "--sd-mb")) {
+            sd.sectors = strtoul(argv[++i], 0, 0) * 2048UL;
+        } else if (!strcmp(argv[i], "--sd-busy")) {
+            sd.busy = sd_card_busy_profile(argv[++i]);
+            if (!sd.busy && strcmp(argv[i], "none")) {
+                usage(argv[0]);
+            }
+        } else if (!strcmp(argv[i], "--sd-crc")) {
+            sd.crc_error_rate = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--sd-stuck")) {
+            sd.stuck_busy_rate = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--sd-remove")) {
+            sd.remove_at_s = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--sd-reinsert")) {
+            sd.reinsert_at_s = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    sim_reset();
+    if (uart_file) {
+        sim_uart_tx_sink = uart_to_file;
+    }
+    if (sd_image && sd_card_open(sd_image, &sd) != 0) {
+        return 1;
+    }
+    sim_schedule(sim_seconds(warmup), window_open, 0);
+    if (brownout_at >= 0.0 && sim_avcc_mv > SIM_SVSH_MV &&
+        brownout_at + (sim_avcc_mv - SIM_SVSH_MV) / brownout_mvps < seconds) {
+        seconds = brownout_at + (sim_avcc_mv - SIM_SVSH_MV) / brownout_mvps;
+    }
+
+    sim_run(tigr_firmware_main, sim_seconds(warmup + seconds));
+
+    sim_account();
+    elapsed = sim_to_seconds(sim_now - window_start);
+    counted = muon_count - counted_base;
+    energy(elapsed, &avg_ua, &all_sector_uj);
+
+    if (report) {
+        // One CSV row per run; columns documented in stress_bench.py
+        printf("%s,%.6g,%.6g,%lu,%.6g,%lu,%lu,%lu,%u,%lu,%.4f,%.4f,%.1f,%.1f,%lu,%lu,%.1f,%.1f\n",
+               sim_board_name, elapsed, arrival_rate, seed, burst_fraction,
+               arrivals, bursts, edges_injected, counted, sim_stats.port2_merged,
+               100.0 * sim_to_seconds(sim_stats.port2_isr_cycles) / elapsed,
+               100.0 * sim_to_seconds(sim_stats.masked_cycles) / elapsed,
+               1e6 * sim_to_seconds(sim_stats.port2_worst_isr),
+               1e6 * sim_to_seconds(sim_stats.port2_worst_latency),
+               log_written, sim_stats.port2_cleared, avg_ua, all_sector_uj);
+    } else {
+        printf("board            %s\n", sim_board_name);
+        printf("window           %.3f s after %.3f s warmup\n", elapsed, warmup);
+        printf("muons injected   %lu (%lu bursts, %lu band edges)\n", arrivals, bursts, edges_injected);
+        if (ring_fraction > 0.0) {
+            printf("ringing edges    %lu, %.1f us after the first\n", ring_edges, ring_us);
+        }
+        printf("muons counted    %u\n", counted);
+        printf("edges merged     %lu\n", sim_stats.port2_merged);
+        printf("edges cleared    %lu (flag written off before P2IV handed it out)\n",
+               sim_stats.port2_cleared);
+        printf("staged readings  %u\n", reading_count);
+        printf("sd initialized   %u\n", sd_initialized);
+        printf("sectors written  %lu\n", log_written);
+#if SIM_FRAM_LOG
+        printf("fram log         %u of %lu bytes, %u records dropped (%u h)\n",
+               fram_log_head, FRAM_LOG_BYTES, fram_log_dropped, fram_log_hours_left());
+#endif
+        if (log_capacity) {
+            printf("log ring         head %lu, tail %lu, %u sessions, %lu of %lu sectors free (%u h)\n",
+                   current_sector, log_tail_sector(), log_session_count(), log_free_sectors(),
+                   log_capacity - LOG_FIRST_SECTOR, log_hours_left());
+        }
+        printf("isr time         %.3f ms total, %.3f ms worst\n",
+               1000.0 * sim_to_seconds(sim_stats.port2_isr_cycles),
+               1000.0 * sim_to_seconds(sim_stats.port2_worst_isr));
+        printf("dead time        %.3f %% in ISR, %.3f %% interrupts masked\n",
+               100.0 * sim_to_seconds(sim_stats.port2_isr_cycles) / elapsed,
+               100.0 * sim_to_seconds(sim_stats.masked_cycles) / elapsed);
+        printf("worst latency    %.1f us\n", 1e6 * sim_to_seconds(sim_stats.port2_worst_latency));
+        printf("spi bytes        %lu\n", sim_stats.spi_bytes);
+        if (sd_image) {
+            printf("card blocks      %lu written, %lu read, %lu commands\n",
+                   sd_card_stats.blocks_written, sd_card_stats.blocks_read, sd_card_stats.commands);
+            printf("card busy        %.3f ms total, %.3f ms worst\n",
+                   1000.0 * sim_to_seconds(sd_card_stats.busy_cycles),
+                   1000.0 * sim_to_seconds(sd_card_stats.worst_busy));
+            printf("card faults      %lu crc, %lu stuck busy, %lu removals\n",
+                   sd_card_stats.crc_errors, sd_card_stats.stuck_busy, sd_card_stats.removals);
+        }
+        printf("uart bytes       %lu\n", sim_stats.uart_tx_bytes);
+        printf("mclk       active ms    card ms  sectors  uJ/sector\n");
+        for (c = sim_stats.clock; c < sim_stats.clock + SIM_CLOCK_POINTS && c->mclk_hz; c++) {
+            printf("%6.2f MHz %9.3f %10.3f %8lu %10.1f\n", c->mclk_hz / 1e6,
+                   1000.0 * sim_to_seconds(c->active), 1000.0 * sim_to_seconds(c->card),
+                   c->sectors, sector_uj(c));
+        }
+        printf("sleep            %.3f s\n", sim_to_seconds(sim_stats.sleep));
+        printf("supply current   %.1f uA average at %.2f V\n", avg_ua, sim_avcc_mv / 1000.0);
+        if (brownout_at >= 0.0) {
+            printf("brownout         falling %.1f mV/s from %.3f s, %u mV at the end%s\n",
+                   brownout_mvps, brownout_at, sim_avcc_mv,
+                   sim_avcc_mv <= SIM_SVSH_MV ? " (SVSH reset)" : "");
+            if (sd_rescue.magic == SD_RESCUE_MAGIC) {
+                printf("fram commit      at muon %u: %u log bytes, %u staged; "
+                       "%u detections after it lost\n",
+                       sd_rescue.muon_count,
+                       sd_rescue.buffer_position - SECTOR_HEADER_LEN, sd_rescue.reading_count,
+                       muon_count - sd_rescue.muon_count);
+            } else {
+                printf("fram commit      none\n");
+            }
+        }
+    }
+
+#if SIM_FRAM_LOG
+    if (fram_dump) {
+        // The dump blocks as READ streams them
+        unsigned char block[FRAM_LOG_BLOCK];
+        unsigned int n;
+        FILE* f = fopen(fram_dump, "wb");
+        if (!f) {
+            perror(fram_dump);
+            return 1;
+        }
+        for (n = 0; n < fram_log_blocks(); n++) {
+            fram_log_block(n, block);
+            fwrite(block, 1, sizeof(block), f);
+        }
+        fclose(f);
+    }
+#else
+    if (fram_dump) {
+        fprintf(stderr, "--fram: build with FW_DEFS=-DLOG_FRAM=1 (FR6989)\n");
+    }
+#endif
+    if (sd_image) {
+        sd_card_close();
+    }
+    if (uart_file) {
+        fclose(uart_file);
+    }
+    if (isr_file) {
+        fclose(isr_file);
+    }
+    return 0;
+}
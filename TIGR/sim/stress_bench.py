@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+"""
+TIGR Dead-Time Stress Benchmark
+Sweeps Poisson muon rates from 0.1 Hz to 5 kHz through the host simulator
+for each firmware configuration and reports how many events were recorded,
+the dead-time fraction, the worst ISR latency and the supply current.
+
+Every run uses a fixed seed, so the report is the same on every rerun with
+the same toolchain. --check compares against a saved baseline and exits
+non-zero on a regression, or if any run cleared a pending band flag that
+the detection ISR never took from P2IV. It also lets the supply fall
+through a burst of events on each board: the power-fail commit (supply.h)
+must reach FRAM, and the detections after it, lost at the SVSH reset,
+must stay within one SUPPLY_LOW_PERIOD_S of events.
+
+--paths times each path of the detection ISR on both boards instead: one
+run per path with the band input, prescale or mode that keeps the ISR on
+it, reporting the median and longest ISR. These are simulator times (the
+peripheral waits and register accesses on each path), not MSP430 cycles.
+
+--uart compares the FR6989 event path with a telemetry frame per event sent
+through the TX ring (the firmware default) and polled out byte by byte
+from the ISR (UART_TX_BLOCKING=1, as before the ring).
+
+Usage:
+    python3 stress_bench.py                              # full sweep
+    python3 stress_bench.py --check stress_baseline.csv  # regression check
+    python3 stress_bench.py --csv stress_baseline.csv    # refresh baseline
+    python3 stress_bench.py --paths                      # ISR time per path
+    python3 stress_bench.py --uart                       # TX ring vs blocking
+"""
+
+import argparse
+import csv
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+RATES = (0.1, 1.0, 10.0, 100.0, 1000.0, 5000.0)
+WEIGHTS = "4,3,2,1"          # Band 1 (lowest energy) most frequent
+BURST = 0.05                 # Coincident multi-band showers
+SEED = 1
+TARGET_EVENTS = 2000
+MIN_SECONDS = 20.0
+MAX_SECONDS = 3600.0
+
+# (name, board, MAX_READINGS, debug); debug on = trace ring at VERBOSE and,
+# on the FR6989, a live telemetry frame from the ISR for every event
+CONFIGS = [
+    (f"{board}-mr{mr}-{'dbg' if debug else 'nodbg'}", board, mr, debug)
+    for board in ("fr2355", "fr6989")
+    for mr in (16, 64)
+    for debug in (False, True)
+]
+
+# Columns printed by tigr_sim --report
+SIM_COLUMNS = ("board", "seconds", "rate", "seed", "burst", "arrivals", "bursts",
+               "edges", "counted", "merged", "isr_pct", "masked_pct",
+               "worst_isr_us", "worst_latency_us", "sectors", "cleared", "avg_ua",
+               "sector_uj")
+COLUMNS = ("config", "max_readings", "debug") + SIM_COLUMNS + ("lost_pct",)
+
+# Allowed drift before --check reports a regression
+TOLERANCE = {"lost_pct": 0.5, "masked_pct": 0.5, "worst_isr_us": 0.10,
+             "worst_latency_us": 0.10}
+
+# Brownout run for --check: the supply falls BROWNOUT_MVPS mV/s from
+# BROWNOUT_AT s into the window at BROWNOUT_RATE Hz until SVSH resets the
+# CPU. Loss after the last commit may exceed one commit period of events
+# by BROWNOUT_SLACK for Poisson spread.
+BROWNOUT_RATE = 100.0
+BROWNOUT_AT = 10.0
+BROWNOUT_MVPS = 20.0
+BROWNOUT_SLACK = 1.2
+BROWNOUT_CONFIGS = ("fr2355-mr64-nodbg", "fr6989-mr64-nodbg")
+
+# ISR paths for --paths, as in the ISA harness (isa/profile_main.c):
+# (path, extra FW_DEFS, weights, burst). Debug output is off and
+# MAX_READINGS at its default of 48; each run lasts PATH_SECONDS at
+# PATH_RATE Hz. The median ISR is the path's own; the flush path is the
+# longest one, when the staging array fills.
+PATHS = [
+    ("port2_isr", "", "1,0,0,0", 0.0),
+    ("port2_isr_shower", "", "1,0,0,1", 1.0),
+    ("port2_isr_prescaled", "-DBAND_DEFAULT_PRESCALE1=255", "1,0,0,0", 0.0),
+    ("port2_isr_histogram", "-DHIST_DEFAULT_ENTER_RATE=1 -DHIST_DEFAULT_EXIT_RATE=0",
+     "1,0,0,0", 0.0),
+    ("port2_isr_flush", "", "1,0,0,0", 0.0),
+]
+PATH_RATE = 10.0
+PATH_SECONDS = 60.0
+
+# --uart: FR6989 builds with per-event telemetry, the event path
+UART_MODES = (("ring", 0), ("blocking", 1))
+
+
+def fw_defs(board, max_readings, debug):
+    defs = [f"-DMAX_READINGS={max_readings}", f"-DTRACE_LEVEL={2 if debug else 0}"]
+    if board == "fr6989":
+        defs.append(f"-DTLM_EVENTS={1 if debug else 0}")
+    return " ".join(defs)
+
+
+def build(name, board, max_readings, debug, defs=None):
+    """Build one configuration into its own directory, return the binary"""
+    build_dir = os.path.join("build", "bench", name)
+    if defs is None:
+        defs = fw_defs(board, max_readings, debug)
+    result = subprocess.run(["make", "-s", "-C", HERE, f"BUILD={build_dir}",
+                             f"FW_DEFS={defs}",
+                             os.path.join(build_dir, f"tigr_sim_{board}")],
+                            capture_output=True, text=True)
+    if result.returncode != 0:
+        sys.exit(f"build of {name} failed:\n{result.stderr}")
+    return os.path.join(HERE, build_dir, f"tigr_sim_{board}")
+
+
+def run(binary, rate):
+    seconds = min(max(TARGET_EVENTS / rate, MIN_SECONDS), MAX_SECONDS)
+    with tempfile.TemporaryDirectory() as tmp:
+        out = subprocess.run([binary, "--report", "--rate", str(rate),
+                              "--seconds", str(seconds), "--weights", WEIGHTS,
+                              "--burst", str(BURST), "--seed", str(SEED),
+                              "--sd", os.path.join(tmp, "card.img")],
+                             check=True, capture_output=True, text=True).stdout
+    row = dict(zip(SIM_COLUMNS, out.strip().splitlines()[-1].split(",")))
+    arrivals = int(row["arrivals"])
+    lost = arrivals - int(row["counted"])
+    row["lost_pct"] = f"{100.0 * lost / arrivals:.2f}" if arrivals else "0.00"
+    return row
+
+
+def supply_low_period():
+    """SUPPLY_LOW_PERIOD_S from the firmware, so the bound follows it"""
+    with open(os.path.join(HERE, "..", "src", "TIGR", "supply.h")) as f:
+        return int(re.search(r"#define SUPPLY_LOW_PERIOD_S\s+(\d+)", f.read()).group(1))
+
+
+def brownout(name, binary):
+    """Run one brownout; return a list of problems"""
+    with tempfile.TemporaryDirectory() as tmp:
+        out = subprocess.run([binary, "--rate", str(BROWNOUT_RATE), "--seconds", str(MAX_SECONDS),
+                              "--weights", WEIGHTS, "--burst", str(BURST), "--seed", str(SEED),
+                              "--brownout", f"{BROWNOUT_AT},{BROWNOUT_MVPS}",
+                              "--sd", os.path.join(tmp, "card.img")],
+                             check=True, capture_output=True, text=True).stdout
+    if "(SVSH reset)" not in out:
+        return [f"{name} brownout: supply never reached SVSH"]
+    commit = re.search(r"fram commit\s+at muon \d+:.*; (\d+) detections after it lost", out)
+    if commit is None:
+        return [f"{name} brownout: no fram commit before the SVSH reset"]
+    lost = int(commit.group(1))
+    limit = BROWNOUT_SLACK * supply_low_period() * BROWNOUT_RATE
+    print(f"{name:<18} brownout  {lost} detections lost after the fram commit (limit {limit:g})")
+    if lost > limit:
+        return [f"{name} brownout: {lost} detections lost after the fram commit, limit {limit:g}"]
+    return []
+
+
+def isr_path(name, board, defs, weights, burst):
+    """Run one ISR path; return (ISRs, median us, longest us)"""
+    binary = build(name, board, None, False, defs)
+    with tempfile.TemporaryDirectory() as tmp:
+        times = os.path.join(tmp, "isr.txt")
+        subprocess.run([binary, "--rate", str(PATH_RATE), "--seconds", str(PATH_SECONDS),
+                        "--weights", weights, "--burst", str(burst), "--seed", str(SEED),
+                        "--isr", times, "--sd", os.path.join(tmp, "card.img")],
+                       check=True, capture_output=True)
+        with open(times) as f:
+            us = sorted(float(line) for line in f)
+    return len(us), us[len(us) // 2], us[-1]
+
+
+def paths():
+    print(f"{'board':<8} {'path':<21} {'ISRs':>5} {'median us':>10} {'longest us':>11}")
+    for board in ("fr2355", "fr6989"):
+        for path, defs, weights, burst in PATHS:
+            defs = f"-DTRACE_LEVEL=0 -DTLM_EVENTS=0 {defs}".strip()
+            count, median, longest = isr_path(f"{board}-{path}", board, defs, weights, burst)
+            print(f"{board:<8} {path:<21} {count:>5} {median:>10.1f} {longest:>11.1f}",
+                  flush=True)
+
+
+def uart():
+    print(f"{'fr6989 telemetry':<21} {'ISRs':>5} {'median us':>10} {'longest us':>11}")
+    for mode, blocking in UART_MODES:
+        defs = f"-DTRACE_LEVEL=0 -DTLM_EVENTS=1 -DUART_TX_BLOCKING={blocking}"
+        count, median, longest = isr_path(f"fr6989-uart-{mode}", "fr6989", defs, "1,0,0,0", 0.0)
+        print(f"{mode:<21} {count:>5} {median:>10.1f} {longest:>11.1f}", flush=True)
+
+
+def sweep(configs, rates, verbose=True):
+    rows = []
+    for name, board, max_readings, debug in configs:
+        binary = build(name, board, max_readings, debug)
+        for rate in rates:
+            row = run(binary, rate)
+            row.update(config=name, max_readings=max_readings, debug=int(debug))
+            rows.append(row)
+            if verbose:
+                print(f"{name:<18} {rate:>8g} Hz  {row['counted']:>6}/{row['arrivals']:<6} "
+                      f"lost {row['lost_pct']:>6}%  masked {float(row['masked_pct']):6.2f}%  "
+                      f"worst ISR {float(row['worst_isr_us']):9.1f} us  "
+                      f"latency {float(row['worst_latency_us']):7.1f} us", flush=True)
+    return rows
+
+
+def check(rows, baseline_path):
+    """Compare against a baseline; return a list of regressions"""
+    with open(baseline_path) as f:
+        baseline = {(r["config"], float(r["rate"])): r for r in csv.DictReader(f)}
+    problems = []
+    for row in rows:
+        key = (row["config"], float(row["rate"]))
+        if int(row["cleared"]) > 0:
+            problems.append(f"{key[0]} @ {key[1]:g} Hz: {row['cleared']} pending edges "
+                            f"cleared unserviced")
+        base = baseline.get(key)
+        if base is None:
+            continue
+        for field, tol in TOLERANCE.items():
+            new, old = float(row[field]), float(base[field])
+            # Percentages drift in points, latency relative to the baseline
+            limit = old + (tol if field.endswith("_pct") else max(old * tol, 1.0))
+            if new > limit:
+                problems.append(f"{key[0]} @ {key[1]:g} Hz: {field} {old:g} -> {new:g}")
+    return problems
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TIGR dead-time stress benchmark")
+    parser.add_argument('--csv', help="write the report to this CSV file")
+    parser.add_argument('--check', help="compare against a baseline CSV")
+    parser.add_argument('--config', action='append',
+                        help="only run this configuration (repeatable)")
+    parser.add_argument('--paths', action='store_true',
+                        help="time each detection ISR path on both boards")
+    parser.add_argument('--uart', action='store_true',
+                        help="compare telemetry through the TX ring and blocking")
+    args = parser.parse_args()
+
+    if args.paths:
+        paths()
+        return
+    if args.uart:
+        uart()
+        return
+
+    configs = [c for c in CONFIGS if not args.config or c[0] in args.config]
+    rows = sweep(configs, RATES)
+
+    if args.csv:
+        with open(args.csv, 'w', newline='') as f:
+            writer = csv.DictWriter(f, fieldnames=COLUMNS, extrasaction='ignore')
+            writer.writeheader()
+            writer.writerows(rows)
+
+    if args.check:
+        problems = check(rows, args.check)
+        for name, board, max_readings, debug in configs:
+            if name in BROWNOUT_CONFIGS:
+                problems += brownout(name, build(name, board, max_readings, debug))
+        for problem in problems:
+            print(f"REGRESSION {problem}", file=sys.stderr)
+        if problems:
+            sys.exit(1)
+        print(f"No regressions against {args.check}")
+
+
+if __name__ == '__main__':
+    main()
@@ -13,7 +13,9 @@
 // with priority to higher energy band. Currently displays energy band to on board LEDs and does
 // not save energy band onto RAM.
 //
-// Unlikely to develop further as SD card is almost necessary for our design
+// Unlikely to develop further as SD card is almost necessary for our design.
+// Logging without a card is now part of the FR6989 firmware: build it with
+// -DLOG_FRAM=1 (TIGR/fram_log.h).
 
 #include <msp430.h>
 
@@ -33,7 +35,7 @@ typedef struct {
 #define MAX_READINGS 100                // Adjust as needed
 EnergyReading readings[MAX_READINGS];
 volatile unsigned int reading_count = 0;
-volatile unsinged int muon_count = 0;
+volatile unsigned int muon_count = 0;
 
 // Function to save current reading
 void save_reading(unsigned char band) {
@@ -53,8 +55,8 @@ void save_reading(unsigned char band) {
     }
     else
     {
-         /* save to sdcard and reset the array for more space 
-            LOCAL SAVE CODE GOES HERE
+         /* Array full: further readings are not kept. See fram_log.h
+            in TIGR for logging to FRAM without a card
         */
     }
     
@@ -0,0 +1,647 @@
+//  _______ _____ _____ _____   
+// |__   __|_   _/ ____|  __ \ 
+//    | |    | || |  __| |__) |
+//    | |    | || | |_ |  _  / 
+//    | |   _| || |__| | | \ \  
+//    |_|  |_____\_____|_|  \_\ 
+//
+//  Tiny Instrument for Gathering Radiation
+//  Version: 2.4
+//  Date: 10/14/2025
+//
+//  Authors:
+//    - Kevin Nguyen
+//    - Daniel Uribe
+//    - Arda Cobanoglu
+//    - JP McLeese III
+//
+//  Description:
+//    This version of TIGR extends Version 2.4 with an onboard temperature sensor
+//    using the MSP430’s internal ADC. A separate file was created for this feature,
+//    since the ADC was initially avoided to minimize power consumption on
+//    coin-cell-powered systems.
+//
+//    One source tree builds for the MSP430FR6989 and the MSP430FR2355;
+//    board.h resolves the differences at compile time from the device the
+//    build targets.
+//
+//  Changelog:
+//    - Added UART debug messages showing what would be written to the SD card
+//      (to be removed in the final release).
+//
+//    - Integrated MSP430 internal temperature sensor to log on-chip temperature (°C)
+//      at each interrupt event.
+//
+//    - Temperature moved out of the event records into a separate housekeeping
+//      record (temperature, supply voltage, dead time, event count) written
+//      every HK_INTERVAL_S seconds from the RTC ready interrupt.
+//
+//    - UART output is queued in a TX ring buffer drained by the eUSCI_A1 TX
+//      interrupt. Debug prints from ISRs no longer block on UCTXIFG; bytes are
+//      dropped (and counted) when the ring is full.
+//
+//    - Binary live telemetry (telemetry.c): COBS framed event, housekeeping and
+//      stats records with sequence number and CRC16, decoded on the host by
+//      TIGRAnalyzer/tigr_telemetry.py.
+//
+//    - Bulk SD readout over UART (readout.c): the host negotiates up to
+//      921600 baud and streams sectors with CMD18 multi-block reads and
+//      windowed ACKs, so the card no longer has to be pulled for extraction.
+//
+//    - Hot path UART debug strings replaced by trace points (trace.h). They
+//      record binary entries into a RAM ring that is dumped on request, and
+//      compile to nothing when TRACE_LEVEL is TRACE_LEVEL_FLIGHT.
+//
+//    - Host simulator build (TIGR/sim): SPI byte exchange and TLV reads go
+//      through tigr_hal.h; UART ring waits poll with __no_operation() so the
+//      simulator can advance time while the TX ISR drains.
+//
+//    - Event lines are fixed width ("00042,3,...") and formatted straight
+//      into sd_buffer; digits by subtracting powers of ten, BCD timestamp
+//      nibbles mapped directly to ASCII.
+//
+//    - Streaming log: lines continue across sector boundaries and each
+//      sector starts with a header (magic, sequence number, bytes used),
+//      so no sector space is lost to padding.
+//
+//    - Staged events are packed to 4 bytes (tick delta, band mask, seconds
+//      offset); the muon number and RTC time are kept once per batch, so
+//      the same RAM stages 48 events instead of 16.
+//
+//    - Flush policy (flush_policy.c): high-water mark, maximum age of
+//      unwritten data and a rate-based lookahead, set over the UART with
+//      SET_FLUSH. The reason each sector was written is in its header.
+//
+//    - Histogram mode (histogram.c): above a rate threshold the logger
+//      writes per-band and coincidence counts in fixed bins instead of
+//      one line (and one telemetry frame) per event.
+//
+//    - Per-band enables and prescales (prescale.c), set over the UART with
+//      SET_BANDS: a noisy band can be masked at P2IE or logged 1 in N.
+//      Housekeeping records carry exact per-band counts and PS records
+//      the settings, so the analyzer can weight the event lines.
+//
+//    - Detection ISR dispatches on P2IV: each flag is cleared by the read
+//      that returns it, so edges during the ISR are no longer wiped; bands
+//      pending together still count as one detection.
+//
+//    - Dynamic clock scaling (clock.c): MCLK/SMCLK idle at 8 MHz and
+//      boost to 16 MHz (one FRAM wait state) for a batch flush; the SPI
+//      divisor, card busy timeout and UART baud registers follow each
+//      transition.
+//
+//    - Non-blocking boot: detection starts at once and the card is brought
+//      up in the background. Card detect (P1.5) interrupts on insertion and
+//      removal; sectors are held in FRAM while there is no card and written
+//      in order once it is ready. CARD_PRESENT() polarity corrected.
+//
+//    - Log ring (log_manager.c): card capacity from the CSD (v1 and v2,
+//      SDHC cards now initialize), a metadata sector with head, tail and
+//      session starts, and a stop or wrap policy when the card fills, set
+//      with LOG_POLICY or SET_LOG over the UART. Each boot opens a session
+//      instead of overwriting sector 0; housekeeping records carry the
+//      card hours left at the current rate.
+//
+//    - Power-fail commit (supply.c): the supply is checked with each
+//      housekeeping record; below SUPPLY_LOW_MV card writes stop and
+//      staged events, the partial sector and the writer position are
+//      committed to FRAM every few seconds, then taken back after a
+//      brownout reset. SVSH kept on in LPM3.
+//
+//    - Watchdog (recovery.c): no longer held for good; it runs at 256 s
+//      and is kicked on every main loop pass and per readout sector. After
+//      a reset the RTC, muon count and log carry on from FRAM and an RS
+//      record gives the SYSRSTIV cause.
+//
+//    - Retrigger holdoff (holdoff.c): after an edge a band's P2IE bit is
+//      cleared for a configurable time per band, timed by a Timer_A0
+//      compare; edges inside the window are counted as retriggers in the
+//      HK record. Holdoffs are logged in the PS record and set with
+//      SET_BANDS.
+//
+//    - FRAM-only logging (fram_log.c), grown out of the SRAMTIGR prototype:
+//      built with LOG_FRAM the card is never used and the log goes to a
+//      63.5 KB FRAM region at a fixed address, events as 4-byte binary
+//      records committed from the ISR with a single head write. READ
+//      streams it as blocks and the extractor decodes the dump.
+//
+//    - Session header sector (sd_utils.c): each boot starts its log with a
+//      binary sector giving board, firmware version, detector id, RTC,
+//      reset cause and the band, flush, histogram and supply settings, so
+//      runs can be told apart without reading their events. Under
+//      LOG_FRAM it is an 'S' record.
+//
+//    - Single source for both boards (board.h): the FR2355 port, until now
+//      a copy of this tree in 2355FR_TIGR, builds from here. Pins, the
+//      tick and holdoff timers, FRAM write protection and which
+//      peripherals exist are set per board at compile time. The FR2355 has
+//      a software BCD RTC on Timer_B0, its own ADC, LED2 on P6.6, a 24 MHz
+//      FLL clock (idle 1.5 MHz, two FRAM wait states at boost) and no back
+//      channel: UART, telemetry, readout and the FRAM log compile out.
+//      The detection ISR is ISRP2 on both.
+//
+//    - Note: SD card data is written in raw sector format — a hex editor
+//      is required to view contents since no FAT filesystem is used
+//      (excluded to save power and memory).
+//
+//    - SD Card functionality complete. Refer to tigr_mmc.h for wiring guide!
+//
+//  Next Steps: 
+//    - Test SD card via a Coin battery powered MSP430 Launchpad to ensure program works
+//      in a different envirorment. 
+//    
+//  Power Impact Note (From Frank):
+//    - The MSP430 internal temperature sensor and ADC draw power only while active.
+//    - During conversion, the ADC + reference consume ≈200–250 µA for ~1–2 ms.
+//      → Sampling once per second ≈ 0.25 µA average current (minimal impact).
+//      → Sampling once per minute or on rare events ≈ 0.004 µA (negligible).
+//      → Continuous operation ≈ 250 µA (significant drain; not recommended).
+//    - Best practice: enable ADC only when needed (e.g., at muon interrupts),
+//      then power it down immediately after conversion. (Changes must be implemented to code)
+
+
+#include "tigr_config.h"
+#include "tigr_mmc.h"
+#include "sd_utils.h"
+#include "tigr_utils.h"
+#include "temp_utils.h"
+#include "UART.h"
+#include "readout.h"
+#include "trace.h"
+#include "flush_policy.h"
+#include "histogram.h"
+#include "prescale.h"
+#include "tigr_hal.h"
+#include "clock.h"
+#include "supply.h"
+#include "recovery.h"
+#include "holdoff.h"
+#include "fram_log.h"
+
+// Boot messages go to the back channel on boards that have one
+#if BOARD_HAS_UART
+#define BOOT_MSG(text)  UART1string(text)
+#else
+#define BOOT_MSG(text)
+#endif
+
+// Global Variables - Definitions (declared extern in tigr_config.h)
+StagedEvent readings[MAX_READINGS];
+StageAnchor stage_anchor;
+volatile unsigned int reading_count = 0;
+volatile unsigned int muon_count = 0;
+
+// SD Card variables
+unsigned char sd_buffer[SD_BUFFER_SIZE];
+unsigned long current_sector = 0;
+#pragma PERSISTENT(sector_seq)
+unsigned long sector_seq = 0;            // Kept over a reset, the log goes on
+unsigned int buffer_position = SECTOR_HEADER_LEN;
+volatile unsigned char sd_initialized = 0;
+
+// Housekeeping variables
+volatile unsigned char hk_due = 0;
+volatile unsigned long dead_ticks = 0;
+volatile unsigned int uptime_s = 0;
+static unsigned int hk_seconds = 0;
+
+#if !BOARD_HAS_RTC_C
+// Software RTC variables (the FR2355 doesn't have RTC_C)
+volatile unsigned int rtc_year = 0x2025;
+volatile unsigned char rtc_month = 0x10;
+volatile unsigned char rtc_day = 0x14;
+volatile unsigned char rtc_hour = 0x12;
+volatile unsigned char rtc_minute = 0x00;
+volatile unsigned char rtc_second = 0x00;
+volatile unsigned int rtc_ms = 0;
+
+// Initialize software RTC using Timer_B0
+static void rtc_init(void) {
+    // Configure Timer_B0 for 10ms interrupts
+    // Using ACLK (32768 Hz): count to 328 (approximately)
+    TB0CTL = TBSSEL__ACLK | MC__UP | TBCLR;  // ACLK, Up mode, clear timer
+    TB0CCR0 = 327;                            // ~10ms period (32768/100 = 328)
+    TB0CCTL0 = CCIE;                          // Enable CCR0 interrupt
+}
+#endif
+
+// MSP430 and peripherals initialization
+void msp_init(void) {
+    WDTCTL = WDTPW | WDTHOLD;     // Hold the watchdog until the main loop
+    recovery_init();              // Reset cause from SYSRSTIV
+    PM5CTL0 &= ~LOCKLPM5;         // Unlock ports from power manager
+    
+    clock_init();                 // DCO at CLOCK_DCO_HZ, MCLK/SMCLK at the idle point
+    
+#if BOARD_HAS_UART
+    // Initialize UART 
+    UART1init(115200);
+    __delay_cycles(200000);       // Let UART stabilize
+#endif
+    
+    P1DIR |= BIT0;                // LED1 (P1.0, red) set as output
+    LED2_DIR |= LED2_PIN;         // LED2 (green, board.h) set as output
+    
+    // Band inputs P2.1-P2.4; which band each pin carries is in board.h
+    /*------BAND INPUT P2.1-----*/
+    P2DIR &= ~BIT1;               // Set pin P2.1 to be an input
+    P2REN |=  BIT1;               // Enable internal pullup/pulldown resistor on P2.1
+    P2OUT |=  BIT1;               // Pullup selected on P2.1
+    
+    P2IES |=  BIT1;               // Make P2.1 interrupt happen on the falling edge
+    P2IFG &= ~BIT1;               // Clear the P2.1 interrupt flag
+    P2IE  |=  BIT1;               // Enable P2.1 interrupt
+    
+    /*------BAND INPUT P2.2-----*/
+    P2DIR &= ~BIT2;               // Set pin P2.2 to be an input
+    P2REN |=  BIT2;               // Enable internal pullup/pulldown resistor on P2.2
+    P2OUT |=  BIT2;               // Pullup selected on P2.2
+    
+    P2IES |=  BIT2;               // Make P2.2 interrupt happen on the falling edge
+    P2IFG &= ~BIT2;               // Clear the P2.2 interrupt flag
+    P2IE  |=  BIT2;               // Enable P2.2 interrupt
+    
+    /*------BAND INPUT P2.3-----*/
+    P2DIR &= ~BIT3;               // Set pin P2.3 to be an input
+    P2REN |=  BIT3;               // Enable internal pullup/pulldown resistor on P2.3
+    P2OUT |=  BIT3;               // Pullup selected on P2.3
+    
+    P2IES |=  BIT3;               // Make P2.3 interrupt happen on the falling edge
+    P2IFG &= ~BIT3;               // Clear the P2.3 interrupt flag
+    P2IE  |=  BIT3;               // Enable P2.3 interrupt
+    
+    /*------BAND INPUT P2.4-----*/
+    P2DIR &= ~BIT4;               // Set pin P2.4 to be an input
+    P2REN |=  BIT4;               // Enable internal pullup/pulldown resistor on P2.4
+    P2OUT |=  BIT4;               // Pullup selected on P2.4
+    
+    P2IES |=  BIT4;               // Make P2.4 interrupt happen on the falling edge
+    P2IFG &= ~BIT4;               // Clear the P2.4 interrupt flag
+    P2IE  |=  BIT4;               // Enable P2.4 interrupt
+    
+    band_config_apply(BAND_ALL);  // Mask the bands disabled in band_config (prescale.h)
+    holdoff_init();               // Retrigger holdoff timer (holdoff.h)
+    
+#if BOARD_HAS_RTC_C
+    // RTC Initialization
+    RTCCTL0_H = RTCKEY_H;                   // Unlock RTC
+    RTCCTL1 = RTCBCD | RTCHOLD | RTCMODE;   // BCD mode, Calendar mode, Hold
+    
+    // Clear and set RTC values
+    RTCYEAR = 0x2025;                       // Year 
+    RTCMON = 0x10;                          // Month 
+    RTCDAY = 0x14;                          // Day 
+    RTCDOW = 0x02;                          // Day of week 
+    RTCHOUR = 0x12;                         // Hour 
+    RTCMIN = 0x00;                          // Minute 
+    RTCSEC = 0x00;                          // Seconds 
+    recovery_clock();                       // Carry on from the last kick after a reset
+    
+    RTCCTL0_L |= RTCRDYIE;                  // Interrupt once per second (housekeeping)
+    RTCCTL1 &= ~(RTCHOLD);                  // Start RTC
+    RTCCTL0_H = 0;                          // Lock RTC
+#else
+    // Software RTC Initialization
+    rtc_year = 0x2025;            // Year (BCD)
+    rtc_month = 0x10;             // Month (BCD)
+    rtc_day = 0x14;               // Day (BCD)
+    rtc_hour = 0x12;              // Hour (BCD)
+    rtc_minute = 0x00;            // Minute (BCD)
+    rtc_second = 0x00;            // Seconds (BCD)
+    rtc_ms = 0;                   // Milliseconds counter
+    recovery_clock();             // Carry on from the last kick after a reset
+    
+    rtc_init();                   // Timer_B0 tick
+#endif
+    
+    // Tick counter free-running at ACLK/8 (4096 Hz) for dead-time measurement
+    TICK_START();
+    
+    // Initialize ADC for temperature sensing
+    adc_init();
+
+#if BOARD_HAS_UART
+    UCA1IE |= UCRXIE;           // Enable USCI_A1 RX interrupt
+#endif
+    __enable_interrupt();       // Enable global interrupts
+    
+    P1OUT &= ~BIT0;             // Initialize LEDs to off
+    LED2_OUT &= ~LED2_PIN;
+}
+
+#if BOARD_HAS_UART
+// Banner, RTC, temperature sensor and reset cause on the back channel
+static void startup_report(void) {
+    char rtc_str[6];
+    char debug_val[12];
+    char temp_str[12];
+    
+    // Small delay after init
+    __delay_cycles(500000);
+    
+    // Send startup message
+    UART1string("\r\n\r\n");
+    UART1string("***************************************\r\n");
+    UART1string("*    TIGR - Radiation Detector v2.4   *\r\n");
+    UART1string("*                                     *\r\n");
+    UART1string("***************************************\r\n");
+    UART1string("System initializing...\r\n\r\n");
+    UART1flush();
+    
+    // Display RTC status BEFORE SD init
+    UART1string("=========== RTC Status Check ===========\r\n");
+    
+    UART1string("Year  : 0x");
+    hex_to_string_4(RTCYEAR, rtc_str);
+    UART1string((unsigned char*)rtc_str);
+    
+    UART1string("\r\nMonth : 0x");
+    bcd_to_string(RTCMON, rtc_str);
+    UART1string((unsigned char*)rtc_str);
+
+    UART1string("\r\nDay   : 0x");
+    bcd_to_string(RTCDAY, rtc_str);
+    UART1string((unsigned char*)rtc_str);
+    
+    UART1string("\r\nHour  : 0x");
+    bcd_to_string(RTCHOUR, rtc_str);
+    UART1string((unsigned char*)rtc_str);
+    
+    UART1string("\r\nMinute: 0x");
+    bcd_to_string(RTCMIN, rtc_str);
+    UART1string((unsigned char*)rtc_str);
+    
+    UART1string("\r\nSecond: 0x");
+    bcd_to_string(RTCSEC, rtc_str);
+    UART1string((unsigned char*)rtc_str);
+    UART1string("\r\n========================================\r\n\r\n");
+    UART1flush();
+    
+    // Test temperature sensor
+    UART1string("======= Temperature Sensor Test ========\r\n");
+    
+    UART1string("Raw ADC Value: ");
+    uint_to_string(read_raw_adc(), debug_val);
+    UART1string((unsigned char*)debug_val);
+    UART1string(" (should be ~2400-2600 at room temp)\r\n");  
+    
+    UART1string("Calculated Temperature: ");
+    int_to_string(read_temperature(), temp_str);
+    UART1string((unsigned char*)temp_str);
+    UART1string(" C\r\n");
+    UART1string("========================================\r\n\r\n");
+    UART1flush();
+    
+    UART1string("Reset cause (SYSRSTIV): 0x");
+    hex_to_string_4(reset_cause, rtc_str);
+    UART1string((unsigned char*)rtc_str);
+    UART1string("\r\n");
+}
+#endif
+
+int main(void) {
+    msp_init();
+#if BOARD_HAS_UART
+    startup_report();
+#endif
+    
+    // Take back the log checkpoint in FRAM before this boot's header
+    if (sd_rescue_restore()) {
+        BOOT_MSG("Log restored from FRAM after a reset\r\n");
+    }
+    
+    // Start this boot's log with the session header sector and the CSV header
+    BOOT_MSG("Writing session and CSV headers to buffer...\r\n");
+    sd_log_begin();
+    BOOT_MSG("Header prepared: ");
+    BOOT_MSG(LOG_CSV_HEADER);
+    log_reset(reset_cause);       // RS record with the reset cause
+    log_band_config();            // Band settings in force from the first event
+    
+#if LOG_FRAM
+    // No card: the log goes to FRAM (fram_log.h)
+    char debug_val[12];
+    UART1string("\r\nFRAM log, no SD card used. Bytes used: ");
+    uint_to_string(fram_log_head, debug_val);
+    UART1string((unsigned char*)debug_val);
+    UART1string("\r\n");
+#else
+    // Card comes up in the background; sectors are held until then
+    sd_card_start();
+    if (sd_state == SD_NO_CARD) {
+        BOOT_MSG("\r\nNo SD card: sectors are held until one is inserted\r\n");
+        BOOT_MSG("Sectors that do not fit are displayed on terminal\r\n");
+    } else {
+        BOOT_MSG("\r\nSD card detected, initializing in the background\r\n");
+    }
+#endif
+    
+    supply_init();                // First supply sample, SVSH on in LPM3
+    if (supply_low) {
+        BOOT_MSG("Supply low: sectors are held in FRAM until it recovers\r\n");
+    }
+    
+    BOOT_MSG("\r\nSystem ready! Waiting for muon detections...\r\n");
+#if BOARD_HAS_UART
+    UART1flush();
+#endif
+    recovery_start();             // Watchdog on, first checkpoint
+    
+    while(1) {
+        __low_power_mode_3();
+        recovery_kick();          // Watchdog, RTC record, log checkpoint
+        
+        if (hk_due) {
+            hk_due = 0;
+            log_housekeeping();   // Samples the supply as well
+        }
+        
+        if (supply_due) {
+            supply_service();     // Faster samples while the supply is low
+        }
+        
+        if (sd_service_due) {
+            sd_service();         // Card init after insertion, held sectors
+        }
+        
+        if (band_config_changed) {
+            band_config_changed = 0;
+            log_band_config();    // New prescales apply to the events that follow
+        }
+        
+        if (flush_due) {
+            flush_service();      // Age-based commit of the partial sector
+        }
+        
+#if BOARD_HAS_UART
+        readout_service();        // Host commands (bulk readout)
+#endif
+        
+        __delay_cycles(LED_ON_CYCLES);    // LEDs stay lit a moment (board.h)
+        P1OUT &= ~BIT0;                   // reset LEDs
+    }
+}
+
+// Highest band among band flags found pending together, indexed by
+// P2IFG bits 1-4 (board.h)
+static const unsigned char detection_band[16] = BOARD_DETECTION_BAND;
+
+// One band flag handed out by P2IV. Flags pending together are one
+// detection, logged as the highest band among them; the other flags are
+// then read off P2IV without counting again. shower holds those still to
+// come.
+static inline void band_edge(unsigned char pin, unsigned char* shower) {
+    unsigned char flags;
+    unsigned char band;
+    
+    holdoff_edge(pin);            // Ringing on this band is held off
+    if (*shower & pin) {
+        *shower &= ~pin;          // Rest of a detection already counted
+        return;
+    }
+    *shower = P2IFG & P2IE & BAND_FLAGS;
+    flags = *shower | pin;
+    band = detection_band[flags >> 1];
+    
+    if (band >= 3) {             // LED1 on for bands 3-4
+        P1OUT |= BIT0;
+    } else {
+        P1OUT &= ~BIT0;
+    }
+    if (band & 1) {              // LED2 on for bands 2 and 4
+        LED2_OUT &= ~LED2_PIN;
+    } else {
+        LED2_OUT |= LED2_PIN;
+    }
+    
+    band_counts[band - 1]++;
+    if (log_mode == LOG_HISTOGRAM) {
+        hist_count(band, flags);  // Rate high: count into the open bin
+    } else {
+        save_reading(band);       // Logs 1 in band_config.prescale[band - 1]
+    }
+    muon_count++;
+    if (hist_due && !sd_paused) {
+        // A bin closed since the last detection: log it
+        hist_service();
+    }
+    if(reading_count >= flush_policy.high_water && !sd_paused){
+        // High-water mark reached - format into the log and reset
+        TRACE_EVENT(TR_STAGING_FULL, reading_count);
+        write_readings_to_sd();
+        reading_count = 0;
+    }
+}
+
+// ISR for Port 2 - Muon detection interrupt
+// P2IV returns the highest priority pending flag (P2.1 first: band 1 on
+// the FR6989, band 4 on the FR2355) and clears only that one, so an edge
+// that arrives while a detection is being handled stays pending and is
+// taken on a later pass. The loop ends when no flag is left.
+#pragma vector=PORT2_VECTOR
+__interrupt void ISRP2(void) {
+    unsigned int isr_start = TICK_NOW();
+    unsigned char shower = 0;
+    
+    TRACE_VERBOSE(TR_MUON, P2IFG);
+    
+    for (;;) {
+        switch (__even_in_range(hal_port2_iv(), P2IV__P2IFG7)) {
+            case P2IV__NONE:
+                dead_ticks += (unsigned int)(TICK_NOW() - isr_start);
+                __low_power_mode_off_on_exit();
+                return;
+            case P2IV__P2IFG1: band_edge(BIT1, &shower); break;    // Band input P2.1
+            case P2IV__P2IFG2: band_edge(BIT2, &shower); break;    // Band input P2.2
+            case P2IV__P2IFG3: band_edge(BIT3, &shower); break;    // Band input P2.3
+            case P2IV__P2IFG4: band_edge(BIT4, &shower); break;    // Band input P2.4
+            default: break;       // Not a band input
+        }
+    }
+}
+
+// Once-per-second work, after the RTC has moved to the new second (so
+// histogram bins start on it). Returns nonzero if the main loop has to
+// wake.
+static inline unsigned char rtc_second_tick(void) {
+    unsigned char wake = 0;
+    
+    uptime_s++;
+    if (flush_second()) {
+        wake = 1;
+    }
+    if (sd_card_second()) {
+        wake = 1;
+    }
+    if (supply_second()) {
+        wake = 1;
+    }
+    hist_second();
+    if (++hk_seconds >= HK_INTERVAL_S) {
+        hk_seconds = 0;
+        hk_due = 1;
+        wake = 1;
+    }
+    return wake;
+}
+
+#if BOARD_HAS_RTC_C
+// ISR for RTC - once-per-second ready interrupt drives housekeeping cadence
+#pragma vector=RTC_VECTOR
+__interrupt void RTC_ISR(void) {
+    switch(__even_in_range(RTCIV, RTCIV__RT1PSIFG)) {
+        case RTCIV__RTCRDYIFG:
+            if (rtc_second_tick()) {
+                __low_power_mode_off_on_exit();
+            }
+            break;
+        default:
+            break;
+    }
+}
+#else
+// Timer_B0 CCR0 ISR - Software RTC tick (every ~10ms)
+#pragma vector=TIMER0_B0_VECTOR
+__interrupt void Timer_B0_ISR(void) {
+    rtc_ms += 10;  // Increment by 10ms
+    
+    if (rtc_ms >= 1000) {
+        rtc_ms = 0;
+        
+        // Increment seconds (BCD)
+        rtc_second = bcd_increment(rtc_second, 59);
+        if (rtc_second == 0x00) {
+            // Seconds rolled over, increment minutes
+            rtc_minute = bcd_increment(rtc_minute, 59);
+            if (rtc_minute == 0x00) {
+                // Minutes rolled over, increment hours
+                rtc_hour = bcd_increment(rtc_hour, 23);
+                if (rtc_hour == 0x00) {
+                    // Hours rolled over, increment day
+                    unsigned char max_days = get_max_days(rtc_month, rtc_year);
+                    rtc_day = bcd_increment(rtc_day, max_days);
+                    if (rtc_day == 0x01) {
+                        // Day rolled over, increment month
+                        rtc_month = bcd_increment(rtc_month, 12);
+                        if (rtc_month == 0x01) {
+                            // Month rolled over, increment year
+                            rtc_year = bcd_year_increment(rtc_year);
+                        }
+                    }
+                }
+            }
+        }
+        
+        if (rtc_second_tick()) {
+            __low_power_mode_off_on_exit();
+        }
+    }
+}
+#endif
+
+// ISR for the SD card detect pin (board.h), either edge
+#pragma vector=SD_CD_VECTOR
+__interrupt void Card_Detect_ISR(void) {
+    SD_CD_IFG &= ~SD_CD_PIN;
+    sd_card_detect();             // Writer stops; re-armed for the opposite edge
+}
@@ -0,0 +1,394 @@
+//  Developed by Dr. Tolga Soyata           3/14/2024
+//  This file contains functions/tables related to the UART operation
+
+// On-board     UART:   eUSCI Module 0    Channel A: UART, SPI   Channel B: I2C, SPI
+//                                        UCA0RXD=P4.3   UCA0TXD=P4.2
+// Back channel UART:   eUSCI Module 1    Channel A: UART, SPI   Channel B: I2C, SPI
+//                                        UCA1RXD=P3.5   UCA1TXD=P3.4
+//
+// UCAxIFG     register that contains two flags:  UCTXIFG     UCRXIFG
+//             UCRXIFG  receive flag. 0=no new data   1=new data arrived
+//             UCTXIFG  receive flag. 0=busy          1=ready to transmit
+// UCAxTXBUF   Transmit buffer  (writing to this starts TX, UCTXIFG goes to 0)
+// UCAxRXBUF   Receive buffer   (reading this clears UCRXIFG)
+
+#include <msp430.h>
+#include "UART.h"
+#include "clock.h"
+
+#if BOARD_HAS_UART
+
+// Back channel TX ring buffer, drained by the eUSCI_A1 TX interrupt.
+// UART1send() never blocks: when the ring is full the byte is dropped and
+// counted in uart_tx_dropped, so debug output can't stall muon detection.
+static unsigned char tx_buffer[UART_TX_BUFFER_SIZE];
+static volatile unsigned int tx_head = 0;     // Next free slot (written by producers)
+static volatile unsigned int tx_tail = 0;     // Next byte to send (written by TX ISR)
+volatile unsigned int uart_tx_dropped = 0;
+volatile unsigned char uart_exclusive = 0;
+
+// RX frame assembly: bytes collect in rx_buffer until a 0x00 delimiter,
+// then the frame is handed to the main loop through uart_rx_frame
+static unsigned char rx_buffer[UART_RX_FRAME_SIZE];
+static unsigned int rx_length = 0;
+unsigned char uart_rx_frame[UART_RX_FRAME_SIZE];
+volatile unsigned int uart_rx_frame_length = 0;
+
+// Back channel baud rate registers for each clock point (clock.h), derived
+// by UART1setbaud() and loaded on every clock transition
+static unsigned long uart1_baud = 0;          // 0 until UART1init()
+static unsigned int uart1_brw[CLOCK_POINTS];
+static unsigned int uart1_mctlw[CLOCK_POINTS];
+static unsigned int uart1_ie;                 // Enables saved across a reload
+static unsigned char uart1_boost_held = 0;    // Rate needs the boost clock
+
+// UCBRSx for the fractional part of BRCLK / baud, SLAU367P Table 30-4
+// (fraction thresholds in 1/4096)
+static const unsigned int ucbrs_fraction[] = {
+    0, 217, 293, 343, 411, 513, 586, 685, 880, 911, 1026, 1229,
+    1367, 1465, 1538, 1640, 1756, 1794, 2049, 2341, 2459, 2562, 2635, 2731,
+    2868, 2928, 3074, 3220, 3279, 3414, 3467, 3512, 3585, 3689, 3757, 3805
+};
+static const unsigned char ucbrs_value[] = {
+    0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x11, 0x21, 0x22, 0x44, 0x25,
+    0x49, 0x4A, 0x52, 0x92, 0x53, 0x55, 0xAA, 0x6B, 0xAD, 0xB5, 0xB6, 0xD6,
+    0xB7, 0xBB, 0xDD, 0xED, 0xEE, 0xBF, 0xDF, 0xEF, 0xF7, 0xFB, 0xFD, 0xFE
+};
+
+
+// Fixed clock setups used by UART0init(); the back channel follows the
+// operating points of clock.c instead
+void initClockTo8MHz(){
+    // Startup clock system with max DCO setting ~8MHz
+    CSCTL0_H = CSKEY >> 8;                    // Unlock clock registers
+    CSCTL1 = DCOFSEL_3 | DCORSEL;             // Set DCO to 8MHz
+    CSCTL2 = SELA__VLOCLK | SELS__DCOCLK | SELM__DCOCLK;
+    CSCTL3 = DIVA__1 | DIVS__1 | DIVM__1;     // Set all dividers
+    CSCTL0_H = 0;                             // Lock CS registers
+}
+
+
+
+void initClockTo16MHz(){
+    // Configure one FRAM waitstate as required by the device datasheet for MCLK
+    // operation beyond 8MHz _before_ configuring the clock system.
+    FRCTL0 = FRCTLPW | NWAITS_1;
+
+    // Clock System Setup
+    CSCTL0_H = CSKEY_H;                     // Unlock CS registers
+    CSCTL1 = DCOFSEL_0;                     // Set DCO to 1MHz
+    // Set SMCLK = MCLK = DCO, ACLK = LFXTCLK (VLOCLK if unavailable)
+    CSCTL2 = SELA__LFXTCLK | SELS__DCOCLK | SELM__DCOCLK;
+    // Per Device Errata set divider to 4 before changing frequency to
+    // prevent out of spec operation from overshoot transient
+    CSCTL3 = DIVA__4 | DIVS__4 | DIVM__4;   // Set all corresponding clk sources to divide by 4 for errata
+    CSCTL1 = DCOFSEL_4 | DCORSEL;           // Set DCO to 16MHz
+    // Delay by ~10us to let DCO settle. 60 cycles = 20 cycles buffer + (10us / (1/4MHz)).
+    __delay_cycles(300);
+    CSCTL3 = DIVA__1 | DIVS__1 | DIVM__1;   // Set all dividers to 1 for 16MHz operation
+
+    CSCTL4 &= ~LFXTOFF;
+    do{
+        CSCTL5 &= ~LFXTOFFG;                  // Clear XT1 fault flag
+        SFRIFG1 &= ~OFIFG;
+    }while (SFRIFG1&OFIFG);                   // Test oscillator fault flag
+
+    CSCTL0_H = 0;                             // Lock CS registers
+}
+
+
+// On-board UART = eUSCI Module 0 Channel A. UCA0RXD=P4.3   UCA0TXD=P4.2
+void UART0init(unsigned long BaudRate){
+    P4SEL0 |=  (BIT3 | BIT2);                 //Configure pin functions:
+    P4SEL1 &= ~(BIT3 | BIT2);                 //UCA0RXD=P4.3   UCA0TXD=P4.2
+    // Configure PJ.5 PJ.4 for external crystal oscillator
+    PJSEL0 |= BIT4 | BIT5;                    // For XT1
+
+    PM5CTL0 &= ~LOCKLPM5;                     //Turn ON GPIO
+
+    // These settings are from SLAU367P, Table 30-5
+    switch(BaudRate){
+        // 9600 baud settings.    UCOS16=1   UCBR=52   UCBRF=1   UCBRS=0x49
+        case 9600:   initClockTo8MHz();
+                     UCA0CTLW0 = UCSWRST;           // put eUSCI in SW reset to change baud rate
+                     UCA0CTLW0 |= UCSSEL__SMCLK;    // BRCLK=8000000
+                     UCA0BR0 = 52;
+                     UCA0BR1 = 0x00;
+                     UCA0MCTLW |= UCOS16 | UCBRF_1 | 0x4900;
+        // 115,200 baud settings. UCOS16=1   UCBR=8   UCBRF=10   UCBRS=0xF7
+        case 115200: initClockTo16MHz();
+                     UCA0CTLW0 = UCSWRST;           // put eUSCI in SW reset to change baud rate
+                     UCA0CTLW0 |= UCSSEL__SMCLK;    // BRCLK=16000000
+                     UCA0BR0 = 8;
+                     UCA0BR1 = 0x00;
+                     UCA0MCTLW |= UCOS16 | UCBRF_10 | 0xF700;
+                     break;
+    }
+    UCA0CTLW0 &= ~UCSWRST;          // take it off SW reset
+}
+
+
+void UART0send(unsigned char data){
+    //wait for any ongoing transmission
+    while(!(UCA0IFG & UCTXIFG));
+    UCA0TXBUF=data;
+}
+
+
+unsigned char UART0receive(){
+    //return ASAP if no data
+    if(!(UCA0IFG & UCRXIFG)) return 0;
+    else return UCA0RXBUF;
+}
+
+
+// Baud rate register settings for a BRCLK, following SLAU367P 30.3.10:
+// N = BRCLK / baud; with N of 16 or more, oversampling with
+// UCBRx = INT(N / 16) and UCBRFx = INT(N) mod 16; UCBRSx from the
+// fractional part of N. Returns 0 if BRCLK is under 3x the baud rate.
+static unsigned char baud_derive(unsigned long brclk, unsigned long baud,
+                                 unsigned int* brw, unsigned int* mctlw){
+    unsigned long n = brclk / baud;
+    unsigned int fraction = (unsigned int)(((brclk % baud) << 12) / baud);
+    unsigned char i = 0;
+
+    if(n < 3) return 0;
+    while(i + 1 < sizeof(ucbrs_value) && fraction >= ucbrs_fraction[i + 1]) i++;
+    if(n >= 16){
+        *brw = n >> 4;
+        *mctlw = ((unsigned int)ucbrs_value[i] << 8) | ((n & 0x0F) << 4) | UCOS16;
+    } else {
+        *brw = n;
+        *mctlw = (unsigned int)ucbrs_value[i] << 8;
+    }
+    return 1;
+}
+
+
+// Back channel UART = eUSCI Module 1 Channel A.     UCA1RXD=P3.5   UCA1TXD=P3.4
+// BRCLK is SMCLK; call clock_init() first.
+void UART1init(unsigned long BaudRate){
+    P3SEL0 |=  (BIT5 | BIT4);                 //Configure pin functions:
+    P3SEL1 &= ~(BIT5 | BIT4);                 //UCA1RXD=P3.5   UCA1TXD=P3.4
+
+    PM5CTL0 &= ~LOCKLPM5;                     //Turn ON GPIO
+
+    UCA1CTLW0 = UCSWRST;                      // put eUSCI in SW reset to change baud rate
+    UCA1CTLW0 |= UCSSEL__SMCLK;               // BRCLK=SMCLK
+    UART1setbaud(BaudRate);
+}
+
+
+#if UART_TX_BLOCKING
+// Send one byte once the shifter takes it (UART_TX_BLOCKING)
+static void tx_poll(unsigned char data){
+    while(!(UCA1IFG & UCTXIFG));
+    UCA1TXBUF = data;
+}
+#endif
+
+
+// Queue one byte for transmission (drop-on-full)
+void UART1send(unsigned char data){
+#if UART_TX_BLOCKING
+    if(!uart_exclusive) tx_poll(data);
+#else
+    unsigned short state = __get_interrupt_state();
+    __disable_interrupt();
+
+    unsigned int next = (tx_head + 1) & (UART_TX_BUFFER_SIZE - 1);
+    if(next == tx_tail || uart_exclusive){
+        uart_tx_dropped++;                    // Ring full: drop, never wait
+    } else {
+        tx_buffer[tx_head] = data;
+        tx_head = next;
+        UCA1IE |= UCTXIE;                     // TX ISR drains the ring
+    }
+
+    __set_interrupt_state(state);
+#endif
+}
+
+
+void UART1string(unsigned char str[]){
+    unsigned char *nextChr=str;
+    unsigned char c;
+    while((c=*nextChr++) != 0){
+        UART1send(c);
+    }
+}
+
+
+// Queue a block of bytes only if all of them fit (for binary frames).
+// Returns 1 if queued, 0 if the ring did not have room.
+unsigned char UART1write(const unsigned char *data, unsigned int length){
+    unsigned int i;
+    unsigned int space;
+#if UART_TX_BLOCKING
+    (void)space;
+    if(uart_exclusive) return 0;
+    for(i = 0; i < length; i++) tx_poll(data[i]);
+    return 1;
+#else
+    unsigned short state = __get_interrupt_state();
+    __disable_interrupt();
+
+    space = (tx_tail - tx_head - 1) & (UART_TX_BUFFER_SIZE - 1);
+    if(length > space || uart_exclusive){
+        __set_interrupt_state(state);
+        return 0;
+    }
+    for(i = 0; i < length; i++){
+        tx_buffer[tx_head] = data[i];
+        tx_head = (tx_head + 1) & (UART_TX_BUFFER_SIZE - 1);
+    }
+    UCA1IE |= UCTXIE;
+
+    __set_interrupt_state(state);
+    return 1;
+#endif
+}
+
+
+// Queue one byte, waiting for ring space instead of dropping. Ignores
+// uart_exclusive. Only call with interrupts enabled, outside of an ISR.
+// The space check and the store share one critical section, so a byte
+// queued by an ISR in between cannot be overwritten.
+void UART1put(unsigned char data){
+#if UART_TX_BLOCKING
+    tx_poll(data);
+#else
+    unsigned int next;
+
+    for(;;){
+        __disable_interrupt();
+        next = (tx_head + 1) & (UART_TX_BUFFER_SIZE - 1);
+        if(next != tx_tail) break;
+        __enable_interrupt();
+        __no_operation();                     // TX ISR frees a slot
+    }
+    tx_buffer[tx_head] = data;
+    tx_head = next;
+    UCA1IE |= UCTXIE;
+    __enable_interrupt();
+#endif
+}
+
+
+// Switch the back channel baud rate. Waits for queued output to finish
+// first. The register settings are derived for both clock points; a rate
+// the idle clock cannot generate keeps the clock boosted until a rate it
+// can replaces it. Returns 0 if the rate is unsupported.
+unsigned char UART1setbaud(unsigned long BaudRate){
+    unsigned int brw[CLOCK_POINTS];
+    unsigned int mctlw[CLOCK_POINTS];
+    unsigned char idle_ok;
+    unsigned char i;
+    unsigned short state;
+
+    idle_ok = baud_derive(clock_hz[CLOCK_IDLE], BaudRate, &brw[CLOCK_IDLE], &mctlw[CLOCK_IDLE]);
+    if(!baud_derive(clock_hz[CLOCK_BOOST], BaudRate, &brw[CLOCK_BOOST], &mctlw[CLOCK_BOOST]) ||
+       (!idle_ok && !CLOCK_BOOST_ENABLE)){
+        return 0;
+    }
+
+    while(tx_head != tx_tail) __no_operation(); // Drain the ring
+    while(UCA1STATW & UCBUSY);                // Last byte out of the shifter
+
+    state = __get_interrupt_state();
+    __disable_interrupt();
+    for(i = 0; i < CLOCK_POINTS; i++){
+        uart1_brw[i] = brw[i];
+        uart1_mctlw[i] = mctlw[i];
+    }
+    uart1_baud = BaudRate;
+    if(!idle_ok && !uart1_boost_held){
+        uart1_boost_held = 1;
+        clock_boost();
+    } else if(idle_ok && uart1_boost_held){
+        uart1_boost_held = 0;
+        clock_release();
+    }
+    UART1clock_hold();
+    UART1clock_apply(clock_point);
+    __set_interrupt_state(state);
+    UCA1IE |= UCRXIE;                         // UCSWRST cleared the enables
+    return 1;
+}
+
+
+// Clock transitions (clock.c), with interrupts disabled: hold lets the
+// byte being sent finish and stops the eUSCI, apply loads the settings
+// for the new SMCLK and restarts it. A byte being received across the
+// switch is lost; its frame fails to decode.
+void UART1clock_hold(void){
+    if(uart1_baud == 0) return;
+    while(UCA1STATW & UCBUSY);
+    uart1_ie = UCA1IE;
+    UCA1CTLW0 |= UCSWRST;
+}
+
+void UART1clock_apply(unsigned char point){
+    if(uart1_baud == 0) return;
+    UCA1BRW = uart1_brw[point];
+    UCA1MCTLW = uart1_mctlw[point];
+    UCA1CTLW0 &= ~UCSWRST;
+    UCA1IE |= uart1_ie;                       // UCSWRST cleared the enables
+}
+
+
+// Wait until the TX ring is empty. Only call with interrupts enabled
+// and outside of an ISR (used for long start-up messages).
+void UART1flush(void){
+    while(tx_head != tx_tail) __no_operation();
+}
+
+
+unsigned char UART1receive(){
+    //return ASAP if no data
+    if(!(UCA1IFG & UCRXIFG)) return 0;
+    else return UCA1RXBUF;
+}
+
+
+// eUSCI_A1 ISR - sends the next queued byte each time TXBUF empties
+#pragma vector=USCI_A1_VECTOR
+__interrupt void USCI_A1_ISR(void){
+    switch(__even_in_range(UCA1IV, USCI_UART_UCTXCPTIFG)){
+        case USCI_UART_UCRXIFG: {
+            unsigned char c = UCA1RXBUF;
+            unsigned int i;
+            if(c == 0x00){
+                // Delimiter: hand a complete frame to the main loop
+                if(rx_length > 0 && rx_length <= UART_RX_FRAME_SIZE && uart_rx_frame_length == 0){
+                    for(i = 0; i < rx_length; i++){
+                        uart_rx_frame[i] = rx_buffer[i];
+                    }
+                    uart_rx_frame_length = rx_length;
+                    __low_power_mode_off_on_exit();
+                }
+                rx_length = 0;
+            } else if(rx_length < UART_RX_FRAME_SIZE){
+                rx_buffer[rx_length++] = c;
+            } else {
+                rx_length = UART_RX_FRAME_SIZE + 1;   // Oversized: discard at delimiter
+            }
+            break;
+        }
+        case USCI_UART_UCTXIFG:
+            if(tx_tail != tx_head){
+                UCA1TXBUF = tx_buffer[tx_tail];
+                tx_tail = (tx_tail + 1) & (UART_TX_BUFFER_SIZE - 1);
+            } else {
+                // Ring empty: stop TX interrupts. Reading UCA1IV cleared
+                // UCTXIFG, so set it again for the next UART1send().
+                UCA1IFG |= UCTXIFG;
+                UCA1IE &= ~UCTXIE;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+#endif /* BOARD_HAS_UART */
@@ -0,0 +1,51 @@
+//  Developed by Dr. Tolga Soyata           3/14/2024
+//  This is the header file for UART.c
+
+
+#ifndef UART_H_
+#define UART_H_
+
+#include "msp430.h"
+
+// TX ring buffer size in bytes (must be a power of two)
+#define UART_TX_BUFFER_SIZE 256
+
+// Build with -DUART_TX_BLOCKING=1 to send each byte by polling UCTXIFG,
+// as before the TX ring. For comparison runs only (stress_bench.py
+// --uart): output from an ISR then holds it for the whole transfer.
+#ifndef UART_TX_BLOCKING
+#define UART_TX_BLOCKING 0
+#endif
+
+// Largest COBS frame accepted on RX (commands from the host)
+#define UART_RX_FRAME_SIZE 48
+
+// Bytes dropped because the TX ring was full
+extern volatile unsigned int uart_tx_dropped;
+
+// When set, UART1send()/UART1write() drop their output so a frame or
+// bulk transfer sent with UART1put() owns the line (tlm_send_frame_blocking,
+// READ)
+extern volatile unsigned char uart_exclusive;
+
+// Last complete RX frame (without delimiter); length is nonzero while
+// a frame is waiting, clear it after processing
+extern unsigned char uart_rx_frame[UART_RX_FRAME_SIZE];
+extern volatile unsigned int uart_rx_frame_length;
+
+extern void UART0init(unsigned long);
+extern void UART0send(unsigned char);
+extern unsigned char UART0receive();
+extern void UART1init(unsigned long);
+extern void UART1send(unsigned char);
+extern void UART1string(unsigned char *);
+extern unsigned char UART1write(const unsigned char *, unsigned int);
+extern void UART1put(unsigned char);
+extern unsigned char UART1setbaud(unsigned long);
+extern void UART1clock_hold(void);
+extern void UART1clock_apply(unsigned char);
+extern void UART1flush(void);
+extern unsigned char UART1receive();
+
+
+#endif /* UART_H_ */
@@ -0,0 +1,157 @@
+// board.h
+// Board specialization for TIGR project
+//
+// One source tree builds for both boards; the board is chosen by the
+// device the compiler targets (-mmcu=msp430fr2355 or msp430fr6989, or the
+// device selected in the CCS project), which defines __MSP430FR2355__ or
+// __MSP430FR6989__. Everything that differs between the boards is
+// resolved here at compile time: pin assignments, the timers behind the
+// tick counter and the retrigger holdoff, FRAM write protection and which
+// peripherals exist. Board code elsewhere is selected with
+// #if TIGR_BOARD == BOARD_FR2355 or the BOARD_HAS_* flags, so nothing is
+// decided at run time.
+//
+//                      FR2355                  FR6989
+//   RTC                Timer_B0, software BCD  RTC_C
+//   Tick counter       Timer_B1                Timer_A1
+//   Holdoff timer      Timer_B3                Timer_A0
+//   Band n input       P2.(5-n)                P2.n
+//   LED2               P6.6                    P9.7
+//   SD SPI             P1.1-P1.3               P1.4, P1.6, P1.7
+//   SD CS, CD          P1.0, P3.7              P1.3, P1.5
+//   Back channel       none                    eUSCI_A1 UART
+//   Program FRAM       write protected (PFWP)  not protected
+
+#ifndef _TIGR_BOARD_H
+#define _TIGR_BOARD_H
+
+#include <msp430.h>
+
+#define BOARD_FR2355        1
+#define BOARD_FR6989        2
+
+#if defined(__MSP430FR2355__)
+
+#define TIGR_BOARD          BOARD_FR2355
+#define BOARD_HAS_RTC_C     0     // Software RTC on Timer_B0 (TIGR.c)
+#define BOARD_HAS_UART      0     // No back channel: no telemetry, readout or FRAM log
+
+// Band n input pin: band 4 is P2.1 through band 1 on P2.4
+#define BOARD_BAND_PINS     { BIT4, BIT3, BIT2, BIT1 }
+// Highest band among band flags found pending together, indexed by
+// P2IFG bits 1-4 (bit 1 is band 4)
+#define BOARD_DETECTION_BAND { 0, 4, 3, 4, 2, 4, 3, 4, 1, 4, 3, 4, 2, 4, 3, 4 }
+// Band mask (bit n-1 is band n) of band flags pending together, indexed
+// the same way
+#define BOARD_BAND_MASK     { 0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15 }
+
+// LED2 (green)
+#define LED2_DIR            P6DIR
+#define LED2_OUT            P6OUT
+#define LED2_PIN            BIT6
+
+// Free-running tick counter (Timer_B1, ACLK/8 = 4096 Hz)
+#define TICK_NOW()          TB1R
+#define TICK_START()        (TB1CTL = TBSSEL__ACLK | ID__8 | MC__CONTINUOUS | TBCLR)
+
+// Retrigger holdoff compare (holdoff.c)
+#define HOLDOFF_TCTL        TB3CTL
+#define HOLDOFF_TSTART      (TBSSEL__ACLK | MC__CONTINUOUS | TBCLR)
+#define HOLDOFF_TR          TB3R
+#define HOLDOFF_CCR         TB3CCR0
+#define HOLDOFF_CCTL        TB3CCTL0
+#define HOLDOFF_VECTOR      TIMER3_B0_VECTOR
+
+// SD card on eUSCI_B0 (tigr_mmc.h): SCLK P1.1, SIMO P1.2, SOMI P1.3
+#define SD_SPI_PINS         (BIT1 | BIT2 | BIT3)
+#define SD_SPI_MODE         UCCKPH         // Data captured on the first edge
+#define SD_CS_OUT           P1OUT
+#define SD_CS_DIR           P1DIR
+#define SD_CS_PIN           BIT0
+#define SD_CD_IN            P3IN
+#define SD_CD_DIR           P3DIR
+#define SD_CD_REN           P3REN
+#define SD_CD_OUT           P3OUT
+#define SD_CD_IE            P3IE
+#define SD_CD_IES           P3IES
+#define SD_CD_IFG           P3IFG
+#define SD_CD_PIN           BIT7
+#define SD_CD_VECTOR        PORT3_VECTOR
+
+// Program FRAM, where the PERSISTENT variables live, is write protected;
+// lift it around writes to them
+#define FRAM_WRITE_ENABLE()   (SYSCFG0 = FRWPPW | DFWP)
+#define FRAM_WRITE_DISABLE()  (SYSCFG0 = FRWPPW | PFWP | DFWP)
+
+// The software RTC only moves in its own ISR
+#define RTC_TICK_PENDING()  0
+
+// Main loop pause with the LEDs lit after a wake: half a second at the
+// idle clock (clock.h)
+#define LED_ON_CYCLES       (CLOCK_IDLE_HZ / 2)
+
+#elif defined(__MSP430FR6989__)
+
+#define TIGR_BOARD          BOARD_FR6989
+#define BOARD_HAS_RTC_C     1
+#define BOARD_HAS_UART      1     // Telemetry and readout on eUSCI_A1 (UART.h)
+
+// Band n input pin: band n is P2.n
+#define BOARD_BAND_PINS     { BIT1, BIT2, BIT3, BIT4 }
+// Highest band among band flags found pending together, indexed by
+// P2IFG bits 1-4 (bit n-1 is band n)
+#define BOARD_DETECTION_BAND { 0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 }
+// Band mask (bit n-1 is band n) of band flags pending together, indexed
+// the same way
+#define BOARD_BAND_MASK     { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 }
+
+// LED2 (green)
+#define LED2_DIR            P9DIR
+#define LED2_OUT            P9OUT
+#define LED2_PIN            BIT7
+
+// Free-running tick counter (Timer_A1, ACLK/8 = 4096 Hz)
+#define TICK_NOW()          TA1R
+#define TICK_START()        (TA1CTL = TASSEL__ACLK | ID__8 | MC__CONTINUOUS | TACLR)
+
+// Retrigger holdoff compare (holdoff.c)
+#define HOLDOFF_TCTL        TA0CTL
+#define HOLDOFF_TSTART      (TASSEL__ACLK | MC__CONTINUOUS | TACLR)
+#define HOLDOFF_TR          TA0R
+#define HOLDOFF_CCR         TA0CCR0
+#define HOLDOFF_CCTL        TA0CCTL0
+#define HOLDOFF_VECTOR      TIMER0_A0_VECTOR
+
+// SD card on eUSCI_B0 (tigr_mmc.h): SCLK P1.4, SIMO P1.6, SOMI P1.7
+#define SD_SPI_PINS         (BIT4 | BIT6 | BIT7)
+#define SD_SPI_MODE         0              // As this board has always run
+#define SD_CS_OUT           P1OUT
+#define SD_CS_DIR           P1DIR
+#define SD_CS_PIN           BIT3
+#define SD_CD_IN            P1IN
+#define SD_CD_DIR           P1DIR
+#define SD_CD_REN           P1REN
+#define SD_CD_OUT           P1OUT
+#define SD_CD_IE            P1IE
+#define SD_CD_IES           P1IES
+#define SD_CD_IFG           P1IFG
+#define SD_CD_PIN           BIT5
+#define SD_CD_VECTOR        PORT1_VECTOR
+
+// FRAM is left unprotected
+#define FRAM_WRITE_ENABLE()   ((void)0)
+#define FRAM_WRITE_DISABLE()  ((void)0)
+
+// RTC_C counts on its own: a copy of the calendar is only whole if no
+// second ticked while it was taken
+#define RTC_TICK_PENDING()  (RTCCTL0_L & RTCRDYIFG)
+
+// Main loop pause with the LEDs lit after a wake: 1/16 s at the 8 MHz
+// idle clock
+#define LED_ON_CYCLES       500000UL
+
+#else
+#error "TIGR builds for the MSP430FR2355 or MSP430FR6989 only"
+#endif
+
+#endif /* _TIGR_BOARD_H */
@@ -0,0 +1,116 @@
+// clock.c
+// Dynamic clock scaling (see clock.h)
+
+#include "clock.h"
+#include "tigr_mmc.h"
+#include "UART.h"
+
+volatile unsigned char clock_point = CLOCK_IDLE;
+const unsigned long clock_hz[CLOCK_POINTS] = { CLOCK_IDLE_HZ, CLOCK_BOOST_HZ };
+
+static unsigned char boost_depth = 0;
+
+// Load the MCLK and SMCLK dividers
+static inline void clock_divide(unsigned int dividers) {
+#if TIGR_BOARD == BOARD_FR2355
+    CSCTL5 = (CSCTL5 & ~(DIVM | DIVS)) | dividers;
+#else
+    CSCTL0_H = CSKEY_H;
+    CSCTL3 = DIVA__1 | dividers;
+    CSCTL0_H = 0;
+#endif
+}
+
+// Switch MCLK and SMCLK to an operating point. Wait states go up before
+// the clock does and come down after it; the UART finishes the byte on
+// the wire at the old rate.
+static void clock_set(unsigned char point) {
+#if BOARD_HAS_UART
+    UART1clock_hold();
+#endif
+    if (point == CLOCK_BOOST) {
+        FRCTL0 = FRCTLPW | CLOCK_NWAITS(CLOCK_BOOST_HZ);
+        clock_divide(CLOCK_BOOST_DIVIDERS);
+    } else {
+        clock_divide(CLOCK_IDLE_DIVIDERS);
+        FRCTL0 = FRCTLPW | CLOCK_NWAITS(CLOCK_IDLE_HZ);
+    }
+    clock_point = point;
+    spi_set_clock(point);
+#if BOARD_HAS_UART
+    UART1clock_apply(point);
+#endif
+}
+
+#if TIGR_BOARD == BOARD_FR2355
+// Lock the DCO to CLOCK_DCO_HZ and start at the idle point
+void clock_init(void) {
+    FRCTL0 = FRCTLPW | CLOCK_NWAITS(CLOCK_DCO_HZ);  // In case MCLK gets the full DCO
+
+    __bis_SR_register(SCG0);                // Disable FLL
+    CSCTL3 |= SELREF__REFOCLK;              // FLL reference: REFO
+    CSCTL0 = 0;                             // Clear DCO and MOD
+    CSCTL1 = DCORSEL_7;                     // 24 MHz range
+    CSCTL2 = FLLD_0 + 731;                  // DCOCLKDIV = 32768 x (731 + 1)
+    __delay_cycles(3);
+    __bic_SR_register(SCG0);                // Enable FLL
+    while (CSCTL7 & (FLLUNLOCK0 | FLLUNLOCK1));   // Wait for lock
+
+    CSCTL4 = SELMS__DCOCLKDIV | SELA__REFOCLK;    // MCLK, SMCLK from the DCO
+    clock_set(CLOCK_IDLE);
+}
+#else
+// Set the DCO to CLOCK_DCO_HZ, start the LFXT for ACLK and start at the
+// idle point
+void clock_init(void) {
+    PJSEL0 |= BIT4 | BIT5;                  // PJ.4/PJ.5 to the 32768 Hz crystal
+    FRCTL0 = FRCTLPW | CLOCK_NWAITS(CLOCK_DCO_HZ);  // In case MCLK gets the full DCO
+
+    CSCTL0_H = CSKEY_H;                     // Unlock CS registers
+    CSCTL1 = DCOFSEL_0;                     // Set DCO to 1MHz
+    // Set SMCLK = MCLK = DCO, ACLK = LFXTCLK (VLOCLK if unavailable)
+    CSCTL2 = SELA__LFXTCLK | SELS__DCOCLK | SELM__DCOCLK;
+    // Per Device Errata set divider to 4 before changing frequency to
+    // prevent out of spec operation from overshoot transient
+    CSCTL3 = DIVA__4 | DIVS__4 | DIVM__4;
+    CSCTL1 = DCOFSEL_4 | DCORSEL;           // Set DCO to 16MHz
+    // Delay by ~10us to let DCO settle. 60 cycles = 20 cycles buffer + (10us / (1/4MHz)).
+    __delay_cycles(300);
+    CSCTL3 = DIVA__1 | CLOCK_IDLE_DIVIDERS;
+
+    CSCTL4 &= ~LFXTOFF;
+    do {
+        CSCTL5 &= ~LFXTOFFG;                // Clear XT1 fault flag
+        SFRIFG1 &= ~OFIFG;
+    } while (SFRIFG1 & OFIFG);              // Test oscillator fault flag
+
+    CSCTL0_H = 0;                           // Lock CS registers
+    clock_set(CLOCK_IDLE);
+}
+#endif
+
+// Raise MCLK and SMCLK to the boost point until the matching release
+void clock_boost(void) {
+#if CLOCK_BOOST_ENABLE
+    unsigned short state = __get_interrupt_state();
+
+    __disable_interrupt();
+    if (boost_depth++ == 0) {
+        clock_set(CLOCK_BOOST);
+    }
+    __set_interrupt_state(state);
+#endif
+}
+
+// Undo one clock_boost(); the outermost release returns to idle
+void clock_release(void) {
+#if CLOCK_BOOST_ENABLE
+    unsigned short state = __get_interrupt_state();
+
+    __disable_interrupt();
+    if (boost_depth > 0 && --boost_depth == 0) {
+        clock_set(CLOCK_IDLE);
+    }
+    __set_interrupt_state(state);
+#endif
+}
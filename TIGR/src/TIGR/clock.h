@@ -0,0 +1,95 @@
+// clock.h
+// Dynamic clock scaling
+//
+// MCLK and SMCLK run at the idle point while the CPU only services
+// interrupts and are raised to the boost point while a batch of events is
+// formatted and written to the card. clock_boost() and clock_release()
+// nest: a flush from the detection ISR inside a main-loop flush keeps the
+// boost until the outer release.
+// The DCO stays at CLOCK_DCO_HZ (locked by the FLL on the FR2355); the
+// idle point divides MCLK and SMCLK down by CLOCK_IDLE_DIV, so a
+// transition is a divider write with no DCO retune or settling time.
+// FRAM needs wait states above 8 MHz: they are raised before boosting and
+// dropped after returning to idle.
+// Every transition reloads the SD SPI divisor and busy timeout
+// (spi_set_clock()) and, on the FR6989, the back channel baud rate
+// registers (UART1clock_hold()/UART1clock_apply()). A baud rate the idle
+// clock cannot generate holds the boost while it is in use (UART1setbaud()).
+// ACLK and what runs on it (RTC, tick counter) do not change.
+// Build with -DCLOCK_BOOST_ENABLE=0 to flush at the idle point, or
+// -DCLOCK_IDLE_DIV=1 to run at the boost point throughout.
+
+#ifndef _TIGR_CLOCK_H
+#define _TIGR_CLOCK_H
+
+#include "tigr_config.h"
+
+// Operating points
+#define CLOCK_IDLE          0
+#define CLOCK_BOOST         1
+#define CLOCK_POINTS        2
+
+#if TIGR_BOARD == BOARD_FR2355
+#define CLOCK_DCO_HZ        24000000UL      // FLL: 32768 Hz REFO x 732
+#ifndef CLOCK_IDLE_DIV
+#define CLOCK_IDLE_DIV      16              // 1.5 MHz, close to the reset clock
+#endif
+#else
+#define CLOCK_DCO_HZ        16000000UL
+#ifndef CLOCK_IDLE_DIV
+#define CLOCK_IDLE_DIV      2               // 8 MHz: fastest without FRAM wait states
+#endif
+#endif
+#ifndef CLOCK_BOOST_ENABLE
+#define CLOCK_BOOST_ENABLE  1
+#endif
+
+#define CLOCK_IDLE_HZ       (CLOCK_DCO_HZ / CLOCK_IDLE_DIV)
+#define CLOCK_BOOST_HZ      CLOCK_DCO_HZ
+
+#if CLOCK_IDLE_DIV == 1
+#define CLOCK_IDLE_DIVM     DIVM__1
+#define CLOCK_IDLE_DIVS     DIVS__1
+#elif CLOCK_IDLE_DIV == 2
+#define CLOCK_IDLE_DIVM     DIVM__2
+#define CLOCK_IDLE_DIVS     DIVS__2
+#elif CLOCK_IDLE_DIV == 4
+#define CLOCK_IDLE_DIVM     DIVM__4
+#define CLOCK_IDLE_DIVS     DIVS__4
+#elif CLOCK_IDLE_DIV == 8
+#define CLOCK_IDLE_DIVM     DIVM__8
+#define CLOCK_IDLE_DIVS     DIVS__8
+#elif CLOCK_IDLE_DIV == 16
+#define CLOCK_IDLE_DIVM     DIVM__16
+#define CLOCK_IDLE_DIVS     DIVS__16
+#elif CLOCK_IDLE_DIV == 32
+#define CLOCK_IDLE_DIVM     DIVM__32
+#define CLOCK_IDLE_DIVS     DIVS__32
+#else
+#error "CLOCK_IDLE_DIV must be 1, 2, 4, 8, 16 or 32"
+#endif
+
+#if TIGR_BOARD == BOARD_FR2355
+// SMCLK divides MCLK (CSCTL5), so it follows the MCLK divider
+#define CLOCK_IDLE_DIVIDERS     (CLOCK_IDLE_DIVM | DIVS__1)
+#define CLOCK_BOOST_DIVIDERS    (DIVM__1 | DIVS__1)
+// FRAM wait states for a given MCLK (datasheet: 0 up to 8 MHz, 1 up to
+// 16 MHz, 2 above)
+#define CLOCK_NWAITS(hz)    ((hz) > 16000000UL ? NWAITS_2 : (hz) > 8000000UL ? NWAITS_1 : NWAITS_0)
+#else
+// MCLK and SMCLK both divide the DCO (CSCTL3)
+#define CLOCK_IDLE_DIVIDERS     (CLOCK_IDLE_DIVS | CLOCK_IDLE_DIVM)
+#define CLOCK_BOOST_DIVIDERS    (DIVS__1 | DIVM__1)
+// FRAM wait states for a given MCLK (datasheet: 0 up to 8 MHz, 1 above)
+#define CLOCK_NWAITS(hz)    ((hz) > 8000000UL ? NWAITS_1 : NWAITS_0)
+#endif
+
+extern volatile unsigned char clock_point;          // CLOCK_IDLE or CLOCK_BOOST
+extern const unsigned long clock_hz[CLOCK_POINTS];  // MCLK = SMCLK at each point
+
+// Function prototypes
+void clock_init(void);
+void clock_boost(void);
+void clock_release(void);
+
+#endif /* _TIGR_CLOCK_H */
@@ -0,0 +1,98 @@
+// flush_policy.c
+// Flush policy engine for the SD log (see flush_policy.h)
+
+#include "flush_policy.h"
+#include "histogram.h"
+#include "sd_utils.h"
+#include "supply.h"
+#include "trace.h"
+
+FlushPolicy flush_policy = { MAX_READINGS, FLUSH_DEFAULT_MAX_AGE_S, FLUSH_DEFAULT_LOOKAHEAD_S };
+volatile unsigned char flush_due = 0;
+volatile unsigned int event_rate = 0;
+
+static unsigned int rate_last_count = 0;
+
+// Apply a new policy; the high-water mark is kept within the staging array
+void flush_policy_set(unsigned int high_water, unsigned int max_age_s, unsigned int lookahead_s) {
+    if (high_water < 1) {
+        high_water = 1;
+    }
+    if (high_water > MAX_READINGS) {
+        high_water = MAX_READINGS;
+    }
+    __disable_interrupt();
+    flush_policy.high_water = high_water;
+    flush_policy.max_age_s = max_age_s;
+    flush_policy.lookahead_s = lookahead_s;
+    __enable_interrupt();
+}
+
+// Called from the 1 Hz RTC interrupt: update the rate estimate and flag
+// an age commit. Returns nonzero when the main loop should wake.
+unsigned char flush_second(void) {
+    unsigned int events = muon_count - rate_last_count;
+    unsigned int target;
+
+    rate_last_count = muon_count;
+    if (events > FLUSH_RATE_MAX) {
+        events = FLUSH_RATE_MAX;
+    }
+
+    // Step 1/8 of the way to this second's count, rounding away from the
+    // current estimate so it settles exactly
+    target = events << FLUSH_RATE_SHIFT;
+    if (target > event_rate) {
+        event_rate += (target - event_rate + 7) >> 3;
+    } else {
+        event_rate -= (event_rate - target + 7) >> 3;
+    }
+
+    if (unwritten && flush_policy.max_age_s != 0 &&
+        (unsigned int)(uptime_s - unwritten_since) >= flush_policy.max_age_s) {
+        flush_due = 1;
+        return 1;
+    }
+    return 0;
+}
+
+// Commit the partial sector if its oldest data has reached max_age_s,
+// unless the estimated rate fills the sector within the lookahead. Without
+// a card, or while the supply is low, the sector keeps filling: a partial
+// one would only take a slot in the hold ring (sd_utils.h).
+void flush_service(void) {
+    unsigned int age;
+    unsigned int pending;
+    unsigned int room;
+    unsigned long expected;
+
+    flush_due = 0;
+    __disable_interrupt();
+    age = uptime_s - unwritten_since;
+    if (!unwritten || flush_policy.max_age_s == 0 || age < flush_policy.max_age_s ||
+        sd_paused || !sd_initialized || supply_low) {
+        __enable_interrupt();
+        return;
+    }
+
+    if (age - flush_policy.max_age_s < flush_policy.lookahead_s) {
+        // Log bytes still needed to fill this sector, against those the
+        // estimated rate adds before the lookahead runs out
+        pending = buffer_position + reading_count * EVENT_LINE_LEN;
+        room = (pending < SD_BUFFER_SIZE) ? SD_BUFFER_SIZE - pending : 0;
+        expected = ((unsigned long)event_rate * EVENT_LINE_LEN *
+                    (flush_policy.max_age_s + flush_policy.lookahead_s - age)) >> FLUSH_RATE_SHIFT;
+        if (expected >= room) {
+            __enable_interrupt();
+            TRACE_EVENT(TR_FLUSH_DEFERRED, age);
+            return;
+        }
+    }
+
+    if (hist_due) {
+        hist_service();
+    }
+    write_readings_to_sd();
+    flush_buffer_to_sd(FLUSH_MAX_AGE);
+    __enable_interrupt();
+}
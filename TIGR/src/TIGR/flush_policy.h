@@ -0,0 +1,53 @@
+// flush_policy.h
+// When staged events are formatted and partial sectors are committed
+//
+// Three triggers, all adjustable at runtime through flush_policy:
+//   high water  the detection ISR formats the staged events into sd_buffer
+//               once this many are waiting
+//   max age     the main loop commits the partial sector once the oldest
+//               event not yet on the card is this old, bounding what a
+//               power cut can lose
+//   lookahead   an age commit is put off while the estimated event rate
+//               will fill the sector within this many seconds anyway
+// Full sectors are always written as they fill. A partial sector costs a
+// whole card program for less than 504 bytes of log, so only the age
+// trigger spends energy on padding. Worst-case loss window is
+// max_age_s + lookahead_s.
+
+#ifndef _TIGR_FLUSH_POLICY_H
+#define _TIGR_FLUSH_POLICY_H
+
+#include "tigr_config.h"
+
+typedef struct {
+    unsigned int high_water;     // Staged events that trigger formatting (1 to MAX_READINGS)
+    unsigned int max_age_s;      // Commit unwritten data this old (0 = full sectors only)
+    unsigned int lookahead_s;    // Put off an age commit this long if the sector will fill (0 = off)
+} FlushPolicy;
+
+// Power-up policy, override with -DFLUSH_DEFAULT_MAX_AGE_S=n etc.
+#ifndef FLUSH_DEFAULT_MAX_AGE_S
+#define FLUSH_DEFAULT_MAX_AGE_S     600
+#endif
+#ifndef FLUSH_DEFAULT_LOOKAHEAD_S
+#define FLUSH_DEFAULT_LOOKAHEAD_S   120
+#endif
+
+// Event rate estimate: events per second x 16, averaged over ~8 s
+#define FLUSH_RATE_SHIFT            4
+#define FLUSH_RATE_MAX              2000     // Events/s the estimate saturates at
+
+extern FlushPolicy flush_policy;
+extern volatile unsigned char flush_due;       // Set by the 1 Hz tick when an age commit is due
+extern volatile unsigned int event_rate;       // Events/s << FLUSH_RATE_SHIFT
+
+// Oldest data not yet on the card (maintained by sd_utils.c)
+extern volatile unsigned char unwritten;
+extern volatile unsigned int unwritten_since;  // uptime_s
+
+// Function prototypes
+void flush_policy_set(unsigned int high_water, unsigned int max_age_s, unsigned int lookahead_s);
+unsigned char flush_second(void);
+void flush_service(void);
+
+#endif /* _TIGR_FLUSH_POLICY_H */
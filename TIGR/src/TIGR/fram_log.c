@@ -0,0 +1,175 @@
+// fram_log.c
+// FRAM-only logging (see fram_log.h)
+
+#include <string.h>
+#include "fram_log.h"
+#include "flush_policy.h"
+#include "histogram.h"
+#include "sd_utils.h"
+#include "trace.h"
+
+#if LOG_FRAM
+
+// The records, and where they end. Kept over a reset and a power cycle;
+// only loading a new program or FRAM_LOG empties them.
+#pragma PERSISTENT(fram_log_data)
+#pragma LOCATION(fram_log_data, FRAM_LOG_ADDR)
+static volatile unsigned char fram_log_data[FRAM_LOG_BYTES] = {0};
+#pragma PERSISTENT(fram_log_head)
+volatile unsigned int fram_log_head = 0;
+#pragma PERSISTENT(fram_log_dropped)
+unsigned int fram_log_dropped = 0;
+
+static unsigned char anchored = 0;       // An anchor was written this boot
+static unsigned int anchor_uptime = 0;   // uptime_s at that anchor
+
+// Room for length bytes at the head, or 0 if the log is full. Called
+// with interrupts disabled; the record is committed with commit().
+static volatile unsigned char* reserve(unsigned int length) {
+    if (FRAM_LOG_BYTES - fram_log_head < length) {
+        if (fram_log_dropped++ == 0) {
+            TRACE_EVENT(TR_FRAM_FULL, fram_log_head);
+        }
+        return 0;
+    }
+    return &fram_log_data[fram_log_head];
+}
+
+// Move the head past a record written in full: one word write
+static inline void commit(unsigned int length) {
+    fram_log_head += length;
+}
+
+// Log one detection; an anchor with its RTC time goes first if there is
+// none this boot or the last is too old for the offset
+void fram_log_event(unsigned int muon_number, unsigned char band, unsigned int uptime,
+                    const RtcTime* time) {
+    unsigned short state = __get_interrupt_state();
+    volatile unsigned char* p;
+
+    __disable_interrupt();
+    if (!anchored || (unsigned int)(uptime - anchor_uptime) > FRAM_MAX_OFFSET) {
+        p = reserve(FRAM_ANCHOR_LEN + FRAM_EVENT_LEN);
+        if (p == 0) {
+            __set_interrupt_state(state);
+            return;
+        }
+        p[0] = FRAM_LOG_ANCHOR;
+        p[1] = time->year & 0xFF;
+        p[2] = time->year >> 8;
+        p[3] = time->month;
+        p[4] = time->day;
+        p[5] = time->hour;
+        p[6] = time->minute;
+        p[7] = time->second;
+        commit(FRAM_ANCHOR_LEN);
+        anchored = 1;
+        anchor_uptime = uptime;
+    }
+    p = reserve(FRAM_EVENT_LEN);
+    if (p != 0) {
+        p[0] = band;
+        p[1] = (unsigned char)(uptime - anchor_uptime);
+        p[2] = muon_number & 0xFF;
+        p[3] = muon_number >> 8;
+        commit(FRAM_EVENT_LEN);
+    }
+    __set_interrupt_state(state);
+}
+
+// Write a record of kind with length (up to 255) bytes of data
+static void put_record(unsigned char kind, const unsigned char* data, unsigned int length) {
+    unsigned short state = __get_interrupt_state();
+    volatile unsigned char* p;
+    unsigned int i;
+
+    __disable_interrupt();
+    p = reserve(length + FRAM_RECORD_HEADER);
+    if (p != 0) {
+        p[0] = kind;
+        p[1] = (unsigned char)length;
+        for (i = 0; i < length; i++) {
+            p[2 + i] = data[i];
+        }
+        commit(length + FRAM_RECORD_HEADER);
+    }
+    __set_interrupt_state(state);
+}
+
+// Log one text line as it is
+void fram_log_line(const char* line, unsigned int length) {
+    put_record(FRAM_LOG_LINE, (const unsigned char*)line, length);
+}
+
+// Log this boot's session header
+void fram_log_session(const unsigned char* session, unsigned int length) {
+    put_record(FRAM_LOG_SESSION, session, length);
+}
+
+// Blocks of a dump up to the head: the header and the records
+unsigned int fram_log_blocks(void) {
+    return 1 + (fram_log_head + FRAM_LOG_BLOCK - 1) / FRAM_LOG_BLOCK;
+}
+
+// Copy dump block n to dst. The header takes the head as it is now;
+// records appended meanwhile lie beyond it and are left for the next dump.
+void fram_log_block(unsigned int n, unsigned char* dst) {
+    unsigned long used = fram_log_head;
+    unsigned int i;
+    volatile unsigned char* src;
+
+    if (n == 0) {
+        memset(dst, 0, FRAM_LOG_BLOCK);
+        dst[0] = FRAM_LOG_MAGIC0;
+        dst[1] = FRAM_LOG_MAGIC1;
+        dst[2] = FRAM_LOG_VERSION;
+        dst[4] = used & 0xFF;
+        dst[5] = (used >> 8) & 0xFF;
+        dst[8] = FRAM_LOG_BYTES & 0xFF;
+        dst[9] = (FRAM_LOG_BYTES >> 8) & 0xFF;
+        dst[10] = (FRAM_LOG_BYTES >> 16) & 0xFF;
+        dst[12] = fram_log_dropped & 0xFF;
+        dst[13] = fram_log_dropped >> 8;
+        return;
+    }
+    src = &fram_log_data[(unsigned long)(n - 1) * FRAM_LOG_BLOCK];
+    for (i = 0; i < FRAM_LOG_BLOCK; i++) {
+        dst[i] = src[i];
+    }
+}
+
+// Empty the log if it still ends where the host last saw it (used record
+// bytes), so nothing logged since is lost. Returns nonzero if emptied.
+unsigned char fram_log_clear(unsigned long used) {
+    unsigned short state = __get_interrupt_state();
+    unsigned char cleared = 0;
+
+    __disable_interrupt();
+    if (used == fram_log_head) {
+        fram_log_head = 0;
+        fram_log_dropped = 0;
+        anchored = 0;                  // The next event needs an anchor
+        cleared = 1;
+    }
+    __set_interrupt_state(state);
+    return cleared;
+}
+
+// Hours until the region fills at the current rate. Lines are sized as
+// in log_hours_left() (HIST_LINE_MAX, HK_LINE_MAX) plus their record header.
+unsigned int fram_log_hours_left(void) {
+    unsigned long per_hour;
+    unsigned long hours;
+
+    if (log_mode == LOG_HISTOGRAM) {
+        per_hour = (unsigned long)(HIST_LINE_MAX + FRAM_RECORD_HEADER) * (3600 / hist_policy.bin_s);
+    } else {
+        per_hour = event_rate * ((unsigned long)FRAM_EVENT_LEN * (3600 >> FLUSH_RATE_SHIFT)) +
+                   FRAM_ANCHOR_LEN * (3600 / FRAM_MAX_OFFSET);
+    }
+    per_hour += (unsigned long)(HK_LINE_MAX + FRAM_RECORD_HEADER) * (3600 / HK_INTERVAL_S);
+    hours = (FRAM_LOG_BYTES - fram_log_head) / per_hour;
+    return (hours > 0xFFFF) ? 0xFFFF : (unsigned int)hours;
+}
+
+#endif /* LOG_FRAM */
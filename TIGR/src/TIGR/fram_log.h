@@ -0,0 +1,77 @@
+// fram_log.h
+// FRAM-only logging (LOG_FRAM)
+//
+// For short balloon or cubesat flights the card is the part most likely
+// to fail. Built with -DLOG_FRAM=1 the logger never touches it and logs
+// into a region of FRAM reserved at FRAM_LOG_ADDR instead. Events are
+// binary records, a seventh the size of their text line; the other
+// records (CSV header, HK, PS, RS, H) keep their text:
+//   event   [band 1-4] [seconds after the anchor] [muon number (2)]
+//   anchor  'A' [year (2), month, day, hour, minute, second, BCD]
+//   line    'L' [length] [text]
+//   session 'S' [length] [session header (sd_utils.h)]
+// Each boot starts with a session record. An anchor goes before the
+// first event of each boot and before any event more than 255 s after the
+// last one. A detection is written from the detection ISR, so nothing
+// waits in RAM.
+//
+// A record is written after the head and the head moved past it once it
+// is complete. The head is one word, so a reset at any point leaves the
+// log at a record boundary and loses at most the record being written.
+// When the region is full further records are dropped (counted and
+// traced as FRAM_FULL): the start of a flight is kept.
+//
+// READ over the UART (readout.h) streams the log as 512-byte blocks while
+// logging goes on: block 0 is a header, the records follow from block 1.
+//   [0-1] 'T','F'   [2] version   [3] reserved   [4-7] record bytes used
+//   [8-11] record bytes capacity   [12-13] records dropped
+// (little-endian). FRAM_LOG queries the log or empties it. The extractor
+// (TIGRAnalyzer) turns a dump into the same CSV as a card.
+
+#ifndef _TIGR_FRAM_LOG_H
+#define _TIGR_FRAM_LOG_H
+
+#include "tigr_config.h"
+
+// Region in FRAM2, above the code and data in the lower 48 KB. The
+// address is placed with LOCATION, so the linker keeps everything else
+// out of it; reaching it needs the large data model (cl430
+// --data_model=large, msp430-elf-gcc -mlarge). The host simulator has
+// flat pointers.
+#if LOG_FRAM && !defined(TIGR_SIM) && \
+    !defined(__LARGE_DATA_MODEL__) && !defined(__MSP430X_LARGE__)
+#error "LOG_FRAM needs the large data model: --data_model=large (cl430) or -mlarge (gcc)"
+#endif
+#ifndef FRAM_LOG_ADDR
+#define FRAM_LOG_ADDR       0x10000
+#endif
+#ifndef FRAM_LOG_BYTES
+#define FRAM_LOG_BYTES      65024UL   // Record bytes in whole blocks; the head is one word
+#endif
+
+#define FRAM_LOG_MAGIC0     'T'
+#define FRAM_LOG_MAGIC1     'F'
+#define FRAM_LOG_VERSION    1
+#define FRAM_LOG_BLOCK      SD_BUFFER_SIZE
+#define FRAM_LOG_ANCHOR     'A'
+#define FRAM_LOG_LINE       'L'
+#define FRAM_LOG_SESSION    'S'
+#define FRAM_RECORD_HEADER  2        // Kind and length of a line or session record
+#define FRAM_EVENT_LEN      4
+#define FRAM_ANCHOR_LEN     8
+#define FRAM_MAX_OFFSET     255      // Seconds after the anchor an event can carry
+
+extern volatile unsigned int fram_log_head;   // Record bytes used
+extern unsigned int fram_log_dropped;         // Records that did not fit
+
+// Function prototypes
+void fram_log_event(unsigned int muon_number, unsigned char band, unsigned int uptime,
+                    const RtcTime* time);
+void fram_log_line(const char* line, unsigned int length);
+void fram_log_session(const unsigned char* session, unsigned int length);
+unsigned int fram_log_blocks(void);
+void fram_log_block(unsigned int n, unsigned char* dst);
+unsigned char fram_log_clear(unsigned long used);
+unsigned int fram_log_hours_left(void);
+
+#endif /* _TIGR_FRAM_LOG_H */
@@ -0,0 +1,127 @@
+// histogram.c
+// Histogram logging mode (see histogram.h)
+
+#include "histogram.h"
+#include "flush_policy.h"
+#include "sd_utils.h"
+#include "trace.h"
+
+HistPolicy hist_policy = { HIST_DEFAULT_BIN_S, HIST_DEFAULT_ENTER_RATE, HIST_DEFAULT_EXIT_RATE };
+volatile unsigned char log_mode = LOG_EVENTS;
+volatile unsigned char hist_due = 0;
+HistBin hist_bin;
+const unsigned char hist_band_mask[16] = BOARD_BAND_MASK;
+const unsigned char hist_coinc_slot[16] = {
+    HIST_NO_SLOT, HIST_NO_SLOT, HIST_NO_SLOT, 0, HIST_NO_SLOT, 1, 2, 3,
+    HIST_NO_SLOT, 4, 5, 6, 7, 8, 9, 10
+};
+
+static HistBin hist_ready;               // Closed bin waiting for the main loop
+
+// Apply a new policy; the bin is kept within what 16-bit counts hold and
+// the thresholds within the rate estimate's range
+void hist_policy_set(unsigned int bin_s, unsigned int enter_rate, unsigned int exit_rate) {
+    if (bin_s < 1) {
+        bin_s = 1;
+    }
+    if (bin_s > HIST_BIN_MAX_S) {
+        bin_s = HIST_BIN_MAX_S;
+    }
+    if (enter_rate > FLUSH_RATE_MAX) {
+        enter_rate = FLUSH_RATE_MAX;
+    }
+    if (exit_rate > enter_rate) {
+        exit_rate = enter_rate;
+    }
+    __disable_interrupt();
+    hist_policy.bin_s = bin_s;
+    hist_policy.enter_rate = enter_rate;
+    hist_policy.exit_rate = exit_rate;
+    __enable_interrupt();
+}
+
+// Start an empty bin at the current second
+static void hist_open(void) {
+    unsigned char i;
+
+    for (i = 0; i < 4; i++) {
+        hist_bin.band[i] = 0;
+    }
+    for (i = 0; i < HIST_COINC_MASKS; i++) {
+        hist_bin.coincidence[i] = 0;
+    }
+    hist_bin.seconds = 0;
+    hist_bin.muon_number = muon_count;
+    hist_bin.start.year = RTCYEAR;
+    hist_bin.start.month = RTCMON;
+    hist_bin.start.day = RTCDAY;
+    hist_bin.start.hour = RTCHOUR;
+    hist_bin.start.minute = RTCMIN;
+    hist_bin.start.second = RTCSEC;
+}
+
+static unsigned int add_saturate(unsigned int a, unsigned int b) {
+    return (a + b < a) ? 0xFFFF : a + b;
+}
+
+// Hand the open bin over to be logged. A closed bin not logged yet is
+// extended instead, so no detection goes uncounted.
+static void hist_close(void) {
+    unsigned char i;
+
+    if (!hist_due) {
+        hist_ready = hist_bin;
+        hist_due = 1;
+        return;
+    }
+    for (i = 0; i < 4; i++) {
+        hist_ready.band[i] = add_saturate(hist_ready.band[i], hist_bin.band[i]);
+    }
+    for (i = 0; i < HIST_COINC_MASKS; i++) {
+        hist_ready.coincidence[i] = add_saturate(hist_ready.coincidence[i], hist_bin.coincidence[i]);
+    }
+    hist_ready.seconds += hist_bin.seconds;
+}
+
+// Called from the 1 Hz RTC interrupt after flush_second() has updated the
+// rate estimate and after the RTC has advanced
+void hist_second(void) {
+    if (log_mode == LOG_EVENTS) {
+        if (hist_policy.enter_rate != 0 &&
+            event_rate >= (hist_policy.enter_rate << FLUSH_RATE_SHIFT)) {
+            hist_open();
+            log_mode = LOG_HISTOGRAM;
+            TRACE_EVENT(TR_LOG_MODE, LOG_HISTOGRAM);
+        }
+        return;
+    }
+
+    if (++hist_bin.seconds < hist_policy.bin_s) {
+        return;
+    }
+    hist_close();
+    if (event_rate < (hist_policy.exit_rate << FLUSH_RATE_SHIFT)) {
+        log_mode = LOG_EVENTS;
+        TRACE_EVENT(TR_LOG_MODE, LOG_EVENTS);
+    } else {
+        hist_open();
+    }
+}
+
+// Log the closed bin. Called from the detection ISR or with interrupts
+// disabled.
+void hist_service(void) {
+    hist_due = 0;
+    log_histogram(&hist_ready);
+}
+
+// All coincidences in a bin, capped at 0xFFFF
+unsigned int hist_coinc_total(const HistBin* bin) {
+    unsigned int total = 0;
+    unsigned char i;
+
+    for (i = 0; i < HIST_COINC_MASKS; i++) {
+        total = add_saturate(total, bin->coincidence[i]);
+    }
+    return total;
+}
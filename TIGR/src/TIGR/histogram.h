@@ -0,0 +1,88 @@
+// histogram.h
+// Histogram logging mode for high event rates
+//
+// While the estimated event rate (flush_policy.h) is at or above
+// hist_policy.enter_rate, the detection ISR stops staging events and only
+// counts them: per band (the band an event line would have shown) and,
+// for detections that found more than one band flag pending
+// (coincidences), per set of bands pending together.
+// Every bin_s seconds one bin record, stamped with the start of the bin,
+// goes into the log in place of the event lines:
+//   "H,YYYY-MM-DD,HH:MM:SS,Secs,Band1,Band2,Band3,Band4,Coinc,
+//    C12,C13,C23,C123,C14,C24,C124,C34,C134,C234,C1234\n"
+// (one line) where Coinc is all coincidences and Cxy.. those of bands
+// x, y, .. together.
+// The 1 Hz tick closes the bin; the next detection logs it, so the
+// detection ISR stays the only writer of the log while events come in.
+// Housekeeping and age commits log a bin still waiting.
+// Event lines resume when a bin closes with the rate below exit_rate. The
+// gap between the two thresholds stops a rate near one of them from
+// switching the mode every bin.
+
+#ifndef _TIGR_HISTOGRAM_H
+#define _TIGR_HISTOGRAM_H
+
+#include "tigr_config.h"
+
+// Band masks with more than one band: 3, 5, 6, 7, 9, .., 15
+#define HIST_COINC_MASKS    11
+#define HIST_NO_SLOT        0xFF
+
+typedef struct {
+    unsigned int bin_s;          // Seconds per bin record (1 to HIST_BIN_MAX_S)
+    unsigned int enter_rate;     // Events/s that start histogram mode (0 = never)
+    unsigned int exit_rate;      // Events/s below which event lines resume
+} HistPolicy;
+
+typedef struct {
+    unsigned int band[4];        // Detections per band
+    unsigned int coincidence[HIST_COINC_MASKS];  // Per multi-band mask (hist_coinc_slot)
+    unsigned int seconds;        // Seconds covered by the bin
+    unsigned int muon_number;    // muon_count at the start of the bin
+    RtcTime start;               // RTC at the start of the bin
+} HistBin;
+
+// Log modes
+#define LOG_EVENTS          0    // One line per detection
+#define LOG_HISTOGRAM       1    // One bin record per hist_policy.bin_s
+
+// Power-up policy, override with -DHIST_DEFAULT_BIN_S=n etc.
+#ifndef HIST_DEFAULT_BIN_S
+#define HIST_DEFAULT_BIN_S          10
+#endif
+#ifndef HIST_DEFAULT_ENTER_RATE
+#define HIST_DEFAULT_ENTER_RATE     50
+#endif
+#ifndef HIST_DEFAULT_EXIT_RATE
+#define HIST_DEFAULT_EXIT_RATE      20
+#endif
+
+// 16-bit counts hold 10 s at 6.5 kHz. Secs can still reach 5 digits: a
+// bin waiting through a READ or a card swap keeps growing (histogram.c).
+#define HIST_BIN_MAX_S      10
+#define HIST_LINE_MAX       124  // "H,<timestamp>" then 17 ",65535" and "\n"
+
+extern HistPolicy hist_policy;
+extern volatile unsigned char log_mode;
+extern volatile unsigned char hist_due;       // A closed bin is waiting to be logged
+extern HistBin hist_bin;                      // Bin being counted
+extern const unsigned char hist_band_mask[16];   // BOARD_BAND_MASK (board.h)
+extern const unsigned char hist_coinc_slot[16];  // Band mask to coincidence[] index
+
+// Count one detection into the open bin (detection ISR). flags are the
+// band flags that made up the detection.
+static inline void hist_count(unsigned char band, unsigned char flags) {
+    flags &= BAND_FLAGS;
+    hist_bin.band[band - 1]++;
+    if (flags & (flags - 1)) {
+        hist_bin.coincidence[hist_coinc_slot[hist_band_mask[flags >> 1]]]++;
+    }
+}
+
+// Function prototypes
+void hist_policy_set(unsigned int bin_s, unsigned int enter_rate, unsigned int exit_rate);
+void hist_second(void);
+void hist_service(void);
+unsigned int hist_coinc_total(const HistBin* bin);
+
+#endif /* _TIGR_HISTOGRAM_H */
@@ -0,0 +1,125 @@
+// holdoff.c
+// Retrigger holdoff on the band inputs (see holdoff.h)
+
+#include "holdoff.h"
+#include "prescale.h"
+#include "trace.h"
+
+unsigned int holdoff_us[4] = {
+    HOLDOFF_DEFAULT_US, HOLDOFF_DEFAULT_US, HOLDOFF_DEFAULT_US, HOLDOFF_DEFAULT_US
+};
+volatile unsigned int retrig_counts[4] = { 0, 0, 0, 0 };
+unsigned char holdoff_pins = 0;
+volatile unsigned char holdoff_active = 0;
+
+static unsigned int holdoff_ticks[4];     // holdoff_us in timer ticks
+static unsigned int holdoff_end[4];       // Timer count that ends the window
+
+// P2 input of each band (board.h)
+static const unsigned char band_pin[4] = BOARD_BAND_PINS;
+
+// Window lengths in timer ticks, rounded up. At least two ticks, so the
+// compare is never set to a count the timer has already reached.
+static void holdoff_update(void) {
+    unsigned char i;
+    
+    holdoff_pins = 0;
+    for (i = 0; i < 4; i++) {
+        holdoff_ticks[i] = 0;
+        if (holdoff_us[i]) {
+            holdoff_ticks[i] = ((unsigned long)holdoff_us[i] * HOLDOFF_TIMER_HZ + 999999UL) / 1000000UL;
+            if (holdoff_ticks[i] < 2) {
+                holdoff_ticks[i] = 2;
+            }
+            holdoff_pins |= band_pin[i];
+        }
+    }
+}
+
+// The holdoff timer (board.h) free-running from ACLK; the compare is only enabled while a
+// band is held off
+void holdoff_init(void) {
+    HOLDOFF_CCTL = 0;
+    HOLDOFF_TCTL = HOLDOFF_TSTART;
+    holdoff_update();
+}
+
+// New holdoff per band in microseconds, limited to HOLDOFF_MAX_US. Bands
+// held off now keep their current window.
+void holdoff_set(const unsigned int* us) {
+    unsigned char i;
+    
+    __disable_interrupt();
+    for (i = 0; i < 4; i++) {
+        holdoff_us[i] = (us[i] > HOLDOFF_MAX_US) ? HOLDOFF_MAX_US : us[i];
+    }
+    holdoff_update();
+    band_config_changed = 1;      // Logged in the next PS record
+    __enable_interrupt();
+}
+
+// Mask pin and open its window (detection ISR, interrupts disabled)
+void holdoff_start(unsigned char pin) {
+    unsigned char i;
+    
+    for (i = 0; band_pin[i] != pin; i++) {
+    }
+    P2IE &= ~pin;
+    holdoff_end[i] = HOLDOFF_TR + holdoff_ticks[i];
+    if (!holdoff_active || (int)(holdoff_end[i] - HOLDOFF_CCR) < 0) {
+        HOLDOFF_CCR = holdoff_end[i];     // Earliest window end
+    }
+    holdoff_active |= pin;
+    HOLDOFF_CCTL |= CCIE;
+}
+
+// Retriggers held off since the last call, all bands (housekeeping)
+unsigned int retrig_take(void) {
+    unsigned int total = 0;
+    unsigned char i;
+    
+    for (i = 0; i < 4; i++) {
+        total += retrig_counts[i];
+        retrig_counts[i] = 0;
+    }
+    return total;
+}
+
+// ISR for the holdoff compare - end of a holdoff window. Bands within a tick of
+// their end are released together; the compare moves on to the next.
+#pragma vector=HOLDOFF_VECTOR
+__interrupt void Holdoff_ISR(void) {
+    unsigned int now = HOLDOFF_TR;
+    unsigned int next = 0;
+    unsigned char waiting = 0;
+    unsigned char pin;
+    unsigned char i;
+    
+    for (i = 0; i < 4; i++) {
+        pin = band_pin[i];
+        if (!(holdoff_active & pin)) {
+            continue;
+        }
+        if ((int)(holdoff_end[i] - now) > 1) {
+            if (!waiting || (int)(holdoff_end[i] - next) < 0) {
+                next = holdoff_end[i];
+            }
+            waiting = 1;
+            continue;
+        }
+        holdoff_active &= ~pin;
+        if (P2IFG & pin) {
+            retrig_counts[i]++;       // Edge inside the window: ringing
+            P2IFG &= ~pin;
+            TRACE_VERBOSE(TR_RETRIGGER, i + 1);
+        }
+        if (band_config.enable & (1 << i)) {
+            P2IE |= pin;
+        }
+    }
+    if (waiting) {
+        HOLDOFF_CCR = next;
+    } else {
+        HOLDOFF_CCTL = 0;
+    }
+}
@@ -0,0 +1,50 @@
+// holdoff.h
+// Retrigger holdoff on the band inputs
+//
+// Comparator ringing on one muon can give a band several falling edges,
+// and each would cost a detection ISR pass and a logged event. Once P2IV
+// hands out a band's flag, the band's P2IE bit is cleared for
+// holdoff_us[n-1] microseconds, timed by a compare on the holdoff timer
+// (board.h) running from ACLK (30.5 us steps, rounded up). When the window
+// ends, a flag set meanwhile is counted in retrig_counts[n-1] and cleared
+// instead of being taken as a detection. The flag latches, so a window
+// counts at most one retrigger however often the input rang. A holdoff of
+// 0 leaves the band unmasked.
+// The settings go into the PS record with the band settings (prescale.h),
+// logged at the start of each session and whenever they change; each
+// housekeeping record gives the retriggers since the previous one.
+// Change them with holdoff_set() (UART SET_BANDS on the FR6989, readout.h).
+
+#ifndef _TIGR_HOLDOFF_H
+#define _TIGR_HOLDOFF_H
+
+#include "tigr_config.h"
+
+#define HOLDOFF_TIMER_HZ    32768UL
+#define HOLDOFF_MAX_US      50000    // Well inside the 2 s timer wrap
+
+// Power-up holdoff for every band, override with -DHOLDOFF_DEFAULT_US=n
+#ifndef HOLDOFF_DEFAULT_US
+#define HOLDOFF_DEFAULT_US  0
+#endif
+
+extern unsigned int holdoff_us[4];                // Per band, 0 = off
+extern volatile unsigned int retrig_counts[4];    // Retriggers held off since the last HK record
+extern unsigned char holdoff_pins;                // P2 pins with a holdoff set
+extern volatile unsigned char holdoff_active;     // P2 pins held off now, re-enabled by Holdoff_ISR
+
+void holdoff_start(unsigned char pin);
+
+// A band flag was handed out by P2IV (detection ISR): hold the pin off
+static inline void holdoff_edge(unsigned char pin) {
+    if (holdoff_pins & pin) {
+        holdoff_start(pin);
+    }
+}
+
+// Function prototypes
+void holdoff_init(void);
+void holdoff_set(const unsigned int* us);
+unsigned int retrig_take(void);
+
+#endif /* _TIGR_HOLDOFF_H */
@@ -0,0 +1,270 @@
+// log_manager.c
+// Card capacity and the log ring on the card (see log_manager.h)
+
+#include <string.h>
+#include "log_manager.h"
+#include "tigr_mmc.h"
+#include "sd_utils.h"
+#include "flush_policy.h"
+#include "histogram.h"
+#include "trace.h"
+
+unsigned char log_policy = LOG_POLICY;
+unsigned long log_capacity = 0;
+unsigned long log_written = 0;
+
+static unsigned long log_tail = LOG_FIRST_SECTOR;
+static unsigned int log_sessions = 0;
+static unsigned char since_meta = 0;     // Sectors written since the metadata
+
+// Metadata sector image, including the session table. In FRAM, RAM is
+// short; on the FR2355 program FRAM is write protected outside
+// FRAM_WRITE_ENABLE()/FRAM_WRITE_DISABLE() (board.h).
+#pragma PERSISTENT(log_meta)
+static unsigned char log_meta[SD_BUFFER_SIZE] = {0};
+
+// Read a little-endian 32-bit value
+static unsigned long get_u32(const unsigned char* p) {
+    return (unsigned long)p[0] | ((unsigned long)p[1] << 8) |
+           ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+// Store a little-endian 32-bit value
+static void put_u32(unsigned char* p, unsigned long v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static unsigned int meta_sum(void) {
+    unsigned int sum = 0;
+    unsigned int i;
+
+    for (i = 0; i < LOG_META_SUM; i++) {
+        sum += log_meta[i];
+    }
+    return sum;
+}
+
+// Sector after s in the ring
+static unsigned long ring_next(unsigned long s) {
+    return (++s == log_capacity) ? LOG_FIRST_SECTOR : s;
+}
+
+// Whether the image just read from the card is a metadata sector for
+// this card that the firmware can continue
+static unsigned char meta_valid(void) {
+    unsigned long head = get_u32(&log_meta[8]);
+    unsigned long tail = get_u32(&log_meta[12]);
+    unsigned int sessions = log_meta[20] | (log_meta[21] << 8);
+
+    return log_meta[0] == LOG_META_MAGIC0 && log_meta[1] == LOG_META_MAGIC1 &&
+           log_meta[2] == LOG_META_VERSION &&
+           (log_meta[LOG_META_SUM] | (log_meta[LOG_META_SUM + 1] << 8)) == meta_sum() &&
+           get_u32(&log_meta[4]) == log_capacity &&
+           head >= LOG_FIRST_SECTOR && head < log_capacity &&
+           tail >= LOG_FIRST_SECTOR && tail < log_capacity &&
+           sessions <= LOG_MAX_SESSIONS;
+}
+
+// Write the metadata sector. seq is the sequence number of the sector
+// that will go to the head.
+static unsigned char meta_write(unsigned long seq) {
+    unsigned int sum;
+    unsigned char result;
+
+    FRAM_WRITE_ENABLE();
+    log_meta[0] = LOG_META_MAGIC0;
+    log_meta[1] = LOG_META_MAGIC1;
+    log_meta[2] = LOG_META_VERSION;
+    log_meta[3] = log_policy;
+    put_u32(&log_meta[4], log_capacity);
+    put_u32(&log_meta[8], current_sector);
+    put_u32(&log_meta[12], log_tail);
+    put_u32(&log_meta[16], seq);
+    log_meta[20] = log_sessions & 0xFF;
+    log_meta[21] = log_sessions >> 8;
+    log_meta[22] = 0;
+    log_meta[23] = 0;
+    sum = meta_sum();
+    log_meta[LOG_META_SUM] = sum & 0xFF;
+    log_meta[LOG_META_SUM + 1] = sum >> 8;
+    FRAM_WRITE_DISABLE();
+    result = mmc_write_sector(LOG_META_SECTOR, log_meta);
+    // A failed write is retried on the next log sector
+    if (result == MMC_SUCCESS) {
+        since_meta = 0;
+    }
+    return result;
+}
+
+// Free ring space by moving the tail: past the oldest session, or by
+// LOG_META_INTERVAL sectors if only one is left
+static void drop_oldest(void) {
+    unsigned int i;
+
+    FRAM_WRITE_ENABLE();
+    if (log_sessions > 1) {
+        log_sessions--;
+        memmove(&log_meta[LOG_META_TABLE], &log_meta[LOG_META_TABLE + 4], log_sessions * 4);
+        log_tail = get_u32(&log_meta[LOG_META_TABLE]);
+    } else {
+        for (i = 0; i < LOG_META_INTERVAL && log_tail != current_sector; i++) {
+            log_tail = ring_next(log_tail);
+        }
+        put_u32(&log_meta[LOG_META_TABLE], log_tail);
+    }
+    FRAM_WRITE_DISABLE();
+    TRACE_EVENT(TR_LOG_DROP, log_sessions);
+}
+
+// Read the capacity and metadata of a freshly initialized card and open a
+// session at its head. seq is the sequence number of the first sector the
+// session will get. Returns MMC_SUCCESS, LOG_CARD_FULL under LOG_STOP, or
+// an MMC_ error.
+unsigned char log_open(unsigned long seq) {
+    unsigned char header[SECTOR_HEADER_LEN];
+    unsigned long head_seq;
+    unsigned char result;
+
+    log_capacity = mmc_read_card_size();
+    if (log_capacity < LOG_MIN_SECTORS) {
+        log_capacity = 0;
+        return MMC_OTHER_ERROR;
+    }
+    FRAM_WRITE_ENABLE();
+    result = mmc_read_sector(LOG_META_SECTOR, log_meta);
+    FRAM_WRITE_DISABLE();
+    if (result != MMC_SUCCESS) {
+        return result;
+    }
+
+    if (meta_valid()) {
+        current_sector = get_u32(&log_meta[8]);
+        log_tail = get_u32(&log_meta[12]);
+        head_seq = get_u32(&log_meta[16]);
+        log_sessions = log_meta[20] | (log_meta[21] << 8);
+        // Sectors written after the last metadata update carry on the
+        // recorded sequence. Failed metadata writes can leave it more than
+        // LOG_META_INTERVAL sectors behind, so follow it until it breaks.
+        while (ring_next(current_sector) != log_tail) {
+            if (mmc_read_sector_head(current_sector, header, SECTOR_HEADER_LEN) != MMC_SUCCESS ||
+                header[0] != SECTOR_MAGIC0 || header[1] != SECTOR_MAGIC1 ||
+                get_u32(&header[2]) - head_seq >= LOG_SEQ_SLACK) {
+                break;
+            }
+            head_seq = get_u32(&header[2]) + 1;
+            current_sector = ring_next(current_sector);
+        }
+    } else {
+        // Blank card, or one written before the log manager: start over
+        current_sector = LOG_FIRST_SECTOR;
+        log_tail = LOG_FIRST_SECTOR;
+        log_sessions = 0;
+    }
+
+    if (log_sessions == LOG_MAX_SESSIONS) {
+        if (log_policy == LOG_STOP) {
+            return LOG_CARD_FULL;
+        }
+        drop_oldest();
+    }
+    if (log_policy == LOG_STOP && ring_next(current_sector) == log_tail) {
+        return LOG_CARD_FULL;
+    }
+    // A session that never got a sector is reused
+    if (log_sessions == 0 ||
+        get_u32(&log_meta[LOG_META_TABLE + 4 * (log_sessions - 1)]) != current_sector) {
+        FRAM_WRITE_ENABLE();
+        put_u32(&log_meta[LOG_META_TABLE + 4 * log_sessions], current_sector);
+        FRAM_WRITE_DISABLE();
+        log_sessions++;
+    }
+    if (log_sessions == 1) {
+        log_tail = get_u32(&log_meta[LOG_META_TABLE]);
+    }
+
+    TRACE_EVENT(TR_LOG_OPEN, log_sessions);
+    return meta_write(seq);
+}
+
+// Write one log sector at the head. Returns MMC_SUCCESS, LOG_CARD_FULL
+// (nothing written) or the MMC_ error of a failed write.
+unsigned char log_write(unsigned char* sector) {
+    unsigned long seq = get_u32(&sector[2]);
+    unsigned long next = ring_next(current_sector);
+    unsigned char result;
+
+    if (next == log_tail) {
+        if (log_policy == LOG_STOP) {
+            return LOG_CARD_FULL;
+        }
+        // The card must not point at data about to be overwritten
+        drop_oldest();
+        result = meta_write(seq);
+        if (result != MMC_SUCCESS) {
+            return result;
+        }
+    }
+
+    result = mmc_write_sector(current_sector, sector);
+    if (result == MMC_SUCCESS) {
+        TRACE_EVENT(TR_SD_WRITE_OK, current_sector);
+        current_sector = next;
+        log_written++;
+        if (++since_meta >= LOG_META_INTERVAL) {
+            meta_write(seq + 1);
+        }
+    }
+    return result;
+}
+
+// Change the policy. A card stopped full is reopened under LOG_WRAP.
+void log_policy_set(unsigned char policy) {
+    unsigned short state = __get_interrupt_state();
+
+    __disable_interrupt();
+    log_policy = (policy == LOG_STOP) ? LOG_STOP : LOG_WRAP;
+    if (log_policy == LOG_WRAP && sd_state == SD_FULL) {
+        sd_card_detect();
+    }
+    __set_interrupt_state(state);
+}
+
+unsigned int log_session_count(void) {
+    return log_sessions;
+}
+
+unsigned long log_tail_sector(void) {
+    return log_tail;
+}
+
+// Sectors the head can advance before it reaches the tail
+unsigned long log_free_sectors(void) {
+    unsigned long ring = log_capacity - LOG_FIRST_SECTOR;
+
+    if (log_capacity == 0) {
+        return 0;
+    }
+    return (log_tail + ring - current_sector - 1) % ring;
+}
+
+// Hours until the card fills (LOG_STOP) or the oldest session starts to
+// be overwritten (LOG_WRAP) at the current event rate, rounded down and
+// capped at 0xFFFF. Event lines, or histogram bins while they replace
+// them, plus one housekeeping record per HK_INTERVAL_S.
+unsigned int log_hours_left(void) {
+    unsigned long per_hour;
+    unsigned long hours;
+
+    if (log_mode == LOG_HISTOGRAM) {
+        per_hour = (unsigned long)HIST_LINE_MAX * (3600 / hist_policy.bin_s);
+    } else {
+        per_hour = event_rate * ((unsigned long)EVENT_LINE_LEN * (3600 >> FLUSH_RATE_SHIFT));
+    }
+    per_hour += (unsigned long)HK_LINE_MAX * (3600 / HK_INTERVAL_S);
+    per_hour = (per_hour + SECTOR_PAYLOAD - 1) / SECTOR_PAYLOAD;   // Sectors
+    hours = log_free_sectors() / per_hour;
+    return (hours > 0xFFFF) ? 0xFFFF : (unsigned int)hours;
+}
@@ -0,0 +1,70 @@
+// log_manager.h
+// Card capacity and the log ring on the card
+//
+// The capacity is read from the CSD when the card is initialized. Sector
+// LOG_META_SECTOR holds the metadata below; log sectors (sd_utils.h) fill
+// the ring [LOG_FIRST_SECTOR, capacity) from the tail, the oldest sector
+// kept, up to the head (current_sector), the next one written. One sector
+// always stays free, so head == tail means empty. Every boot or card
+// insertion opens a session at the head. When the head comes round to the
+// tail, log_policy decides:
+//   LOG_STOP  the card is full (SD_FULL) and takes no more sectors until
+//             it is replaced
+//   LOG_WRAP  the oldest session is dropped and overwritten; a session
+//             that is the only one left loses LOG_META_INTERVAL sectors
+//             at a time
+// The metadata is rewritten when a session opens, before the tail moves,
+// and every LOG_META_INTERVAL sectors; a failed update is retried with
+// every following sector. After a reset the head is found by following
+// sectors with the expected sequence numbers from the recorded one until
+// the sequence breaks.
+//
+// Metadata sector (little-endian):
+//   [0-1] 'T','M'   [2] version   [3] policy   [4-7] capacity (sectors)
+//   [8-11] head   [12-15] tail   [16-19] sequence number at the head
+//   [20-21] sessions   [22-23] reserved
+//   [24-...] first sector of each session, oldest first (4 each); the
+//            first is the tail
+//   [510-511] sum of bytes 0-509
+
+#ifndef _TIGR_LOG_MANAGER_H
+#define _TIGR_LOG_MANAGER_H
+
+#include "tigr_config.h"
+
+#define LOG_META_SECTOR     0
+#define LOG_FIRST_SECTOR    1
+#define LOG_META_MAGIC0     'T'
+#define LOG_META_MAGIC1     'M'
+#define LOG_META_VERSION    1
+#define LOG_META_TABLE      24
+#define LOG_META_SUM        (SD_BUFFER_SIZE - 2)
+#define LOG_MAX_SESSIONS    ((LOG_META_SUM - LOG_META_TABLE) / 4)
+#define LOG_META_INTERVAL   64   // Sectors between metadata updates
+#define LOG_SEQ_SLACK       8    // Failed writes tolerated between two sectors when finding the head
+#define LOG_MIN_SECTORS     (LOG_FIRST_SECTOR + 4 * LOG_META_INTERVAL)
+
+// Policies when the head reaches the tail
+#define LOG_STOP            0
+#define LOG_WRAP            1
+#ifndef LOG_POLICY
+#define LOG_POLICY          LOG_WRAP
+#endif
+
+// log_open() and log_write() result besides the MMC_ error codes
+#define LOG_CARD_FULL       0x20
+
+extern unsigned char log_policy;
+extern unsigned long log_capacity;     // Card size in sectors, 0 before log_open()
+extern unsigned long log_written;      // Log sectors written since start-up
+
+// Function prototypes
+unsigned char log_open(unsigned long seq);
+unsigned char log_write(unsigned char* sector);
+void log_policy_set(unsigned char policy);
+unsigned int log_session_count(void);
+unsigned long log_tail_sector(void);
+unsigned long log_free_sectors(void);
+unsigned int log_hours_left(void);
+
+#endif /* _TIGR_LOG_MANAGER_H */
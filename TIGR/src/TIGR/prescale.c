@@ -0,0 +1,57 @@
+// prescale.c
+// Per-band prescaling and enables (see prescale.h)
+
+#include "prescale.h"
+#include "holdoff.h"
+
+BandConfig band_config = {
+    BAND_DEFAULT_ENABLE,
+    { BAND_DEFAULT_PRESCALE1, BAND_DEFAULT_PRESCALE2,
+      BAND_DEFAULT_PRESCALE3, BAND_DEFAULT_PRESCALE4 }
+};
+volatile unsigned int band_counts[4] = { 0, 0, 0, 0 };
+volatile unsigned char band_config_changed = 0;
+unsigned char prescale_phase[4] = { 0, 0, 0, 0 };
+
+// P2 input of each band (board.h)
+static const unsigned char band_pin[4] = BOARD_BAND_PINS;
+
+// Enable or disable each band's pin interrupt to match band_config;
+// previous holds the enables before the change. Only a band being enabled
+// has a stale flag cleared: one pending on a band already enabled is a
+// detection still to be serviced. A pin in a holdoff window stays masked;
+// Holdoff_ISR enables it when the window ends, so an edge meanwhile still
+// counts as a retrigger.
+void band_config_apply(unsigned char previous) {
+    unsigned char i;
+
+    for (i = 0; i < 4; i++) {
+        if (holdoff_active & band_pin[i]) {
+            continue;
+        }
+        if (band_config.enable & (1 << i)) {
+            if (!(previous & (1 << i))) {
+                P2IFG &= ~band_pin[i];
+            }
+            P2IE |= band_pin[i];
+        } else {
+            P2IE &= ~band_pin[i];
+        }
+    }
+}
+
+// Apply new band settings; a prescale of 0 is taken as 1
+void band_config_set(unsigned char enable, const unsigned char* prescale) {
+    unsigned char previous = band_config.enable;
+    unsigned char i;
+
+    __disable_interrupt();
+    band_config.enable = enable & BAND_ALL;
+    for (i = 0; i < 4; i++) {
+        band_config.prescale[i] = prescale[i] ? prescale[i] : 1;
+        prescale_phase[i] = 0;
+    }
+    band_config_apply(previous);
+    band_config_changed = 1;
+    __enable_interrupt();
+}
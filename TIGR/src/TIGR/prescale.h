@@ -0,0 +1,67 @@
+// prescale.h
+// Per-band prescaling and enables
+//
+// Every detection of an enabled band is counted in band_counts, but only
+// one event in band_config.prescale[n-1] of band n is staged for an event
+// line; the others are skipped. The exact counts go into each
+// housekeeping record, and a "PS" record logs the settings whenever they
+// change, so the analyzer can weight each event line by its prescale:
+//   "PS,YYYY-MM-DD,HH:MM:SS,Enable,N1,N2,N3,N4,H1,H2,H3,H4\n"
+// H1-H4 are the retrigger holdoffs in microseconds (holdoff.h).
+// A disabled band has its P2IE bit cleared and costs no interrupts.
+// Histogram bins (histogram.h) count every event regardless of prescale.
+// Change the settings with band_config_set() (UART SET_BANDS on the
+// FR6989, readout.h; the debugger on the FR2355, where writing band_config
+// directly takes effect without a PS record).
+
+#ifndef _TIGR_PRESCALE_H
+#define _TIGR_PRESCALE_H
+
+#include "tigr_config.h"
+
+typedef struct {
+    unsigned char enable;        // Bit n-1 set: band n interrupts enabled
+    unsigned char prescale[4];   // Log 1 of every N events of band n (1 = all)
+} BandConfig;
+
+#define BAND_ALL            0x0F
+
+// Power-up settings, override with -DBAND_DEFAULT_PRESCALE1=n etc.
+#ifndef BAND_DEFAULT_ENABLE
+#define BAND_DEFAULT_ENABLE         BAND_ALL
+#endif
+#ifndef BAND_DEFAULT_PRESCALE1
+#define BAND_DEFAULT_PRESCALE1      1
+#endif
+#ifndef BAND_DEFAULT_PRESCALE2
+#define BAND_DEFAULT_PRESCALE2      1
+#endif
+#ifndef BAND_DEFAULT_PRESCALE3
+#define BAND_DEFAULT_PRESCALE3      1
+#endif
+#ifndef BAND_DEFAULT_PRESCALE4
+#define BAND_DEFAULT_PRESCALE4      1
+#endif
+
+#define PS_LINE_MAX         66   // "PS,<timestamp>,15,255,255,255,255,50000,50000,50000,50000\n"
+
+extern BandConfig band_config;
+extern volatile unsigned int band_counts[4];        // Detections per band since the last HK record
+extern volatile unsigned char band_config_changed;  // A PS record is due
+extern unsigned char prescale_phase[4];
+
+// Count one detection of band and decide whether to stage it (detection
+// ISR). Returns nonzero for the one event in N that is logged.
+static inline unsigned char prescale_keep(unsigned char band) {
+    if (++prescale_phase[band - 1] < band_config.prescale[band - 1]) {
+        return 0;
+    }
+    prescale_phase[band - 1] = 0;
+    return 1;
+}
+
+// Function prototypes
+void band_config_set(unsigned char enable, const unsigned char* prescale);
+void band_config_apply(unsigned char previous);
+
+#endif /* _TIGR_PRESCALE_H */
@@ -0,0 +1,384 @@
+// readout.c
+// Bulk SD card readout over the back channel UART
+// See readout.h for the protocol.
+
+#include "readout.h"
+#include "tigr_config.h"
+#include "tigr_mmc.h"
+#include "sd_utils.h"
+#include "telemetry.h"
+#include "UART.h"
+#include "trace.h"
+#include "flush_policy.h"
+#include "prescale.h"
+#include "holdoff.h"
+#include "log_manager.h"
+#include "recovery.h"
+#include "fram_log.h"
+
+#if BOARD_HAS_UART
+
+static unsigned char cmd_frame[UART_RX_FRAME_SIZE];
+
+// Read a little-endian 32-bit value
+static unsigned long get_u32(const unsigned char* p) {
+    return (unsigned long)p[0] | ((unsigned long)p[1] << 8) |
+           ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+// Store a little-endian 32-bit value
+static void put_u32(unsigned char* p, unsigned long v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+// Take the waiting RX frame, if any, and decode it into cmd_frame
+// Returns the decoded length (type + seq + payload), 0 if none or bad
+static unsigned int take_command(void) {
+    unsigned int n;
+    
+    if (uart_rx_frame_length == 0) {
+        return 0;
+    }
+    n = tlm_decode_frame(uart_rx_frame, uart_rx_frame_length, cmd_frame);
+    uart_rx_frame_length = 0;                 // Release for the next frame
+    return n;
+}
+
+// Wait up to timeout ticks for a valid command frame
+static unsigned int wait_command(unsigned int timeout) {
+    unsigned int start = TICK_NOW();
+    unsigned int n;
+    
+    while ((unsigned int)(TICK_NOW() - start) < timeout) {
+        n = take_command();
+        if (n > 0) {
+            return n;
+        }
+    }
+    return 0;
+}
+
+// Echo a PING payload back
+static void send_pong(unsigned int length) {
+    tlm_send_frame_blocking(TLM_TYPE_PONG, 0, 0, &cmd_frame[2], length - 2);
+}
+
+// Switch baud rate; fall back to the default if the host does not
+// reach us at the new rate within READOUT_BAUD_TIMEOUT
+static void set_baud(unsigned int length) {
+    unsigned long baud;
+    unsigned char ok;
+    unsigned int n;
+    
+    if (length < 6) {
+        return;
+    }
+    baud = get_u32(&cmd_frame[2]);
+    ok = (baud == 115200UL || baud == 230400UL || baud == 460800UL || baud == 921600UL);
+    tlm_send_frame_blocking(TLM_TYPE_BAUD_ACK, &ok, 1, 0, 0);
+    if (!ok) {
+        return;
+    }
+    
+    UART1setbaud(baud);
+    n = wait_command(READOUT_BAUD_TIMEOUT);
+    if (n > 0 && cmd_frame[0] == TLM_CMD_PING) {
+        send_pong(n);
+        return;
+    }
+    UART1setbaud(READOUT_DEFAULT_BAUD);
+}
+
+// Collect ACKs before sending block sent; block only when the window
+// is full. Returns the readout status.
+static unsigned char collect_acks(unsigned long sent, unsigned long* acked, unsigned char window) {
+    unsigned char status = READOUT_OK;
+    unsigned int n;
+    
+    do {
+        n = (sent - *acked >= window) ? wait_command(READOUT_ACK_TIMEOUT) : take_command();
+        if (n >= 6 && cmd_frame[0] == TLM_CMD_ACK) {
+            *acked = get_u32(&cmd_frame[2]);
+        } else if (n > 0 && cmd_frame[0] == TLM_CMD_ABORT) {
+            status = READOUT_ABORTED;
+        } else if (n == 0 && sent - *acked >= window) {
+            status = READOUT_TIMEOUT;
+        }
+    } while (status == READOUT_OK && sent - *acked >= window);
+    return status;
+}
+
+// End a readout with its status and the blocks sent
+static void send_done(unsigned char status, unsigned long sent) {
+    unsigned char header[5];
+    
+    TRACE_EVENT(TR_READOUT_DONE, status);
+    header[0] = status;
+    put_u32(&header[1], sent);
+    tlm_send_frame_blocking(TLM_TYPE_READ_DONE, header, 5, 0, 0);
+    UART1flush();
+}
+
+#if LOG_FRAM
+// Stream FRAM log blocks [start, start + count) with the same protocol
+// (count 0 = up to the head). The log is only read, so logging goes on;
+// sd_buffer is free since no card is used.
+static void read_sectors(unsigned int length) {
+    unsigned long start, count, blocks, sent = 0, acked = 0;
+    unsigned char window;
+    unsigned char status = READOUT_OK;
+    unsigned char header[4];
+    
+    if (length < 11) {
+        return;
+    }
+    start = get_u32(&cmd_frame[2]);
+    count = get_u32(&cmd_frame[6]);
+    window = cmd_frame[10];
+    if (window == 0 || window > READOUT_MAX_WINDOW) {
+        window = READOUT_MAX_WINDOW;
+    }
+    
+    blocks = fram_log_blocks();
+    if (start >= blocks) {
+        count = 0;
+    } else if (count == 0 || count > blocks - start) {
+        count = blocks - start;
+    }
+    uart_exclusive = 1;
+    TRACE_EVENT(TR_READOUT_START, count);
+    
+    while (sent < count) {
+        WDT_KICK();
+        status = collect_acks(sent, &acked, window);
+        if (status != READOUT_OK) {
+            break;
+        }
+        fram_log_block(start + sent, sd_buffer);
+        put_u32(header, start + sent);
+        tlm_send_frame_blocking(TLM_TYPE_SECTOR, header, 4, sd_buffer, FRAM_LOG_BLOCK);
+        sent++;
+    }
+    
+    send_done(status, sent);
+    uart_exclusive = 0;
+}
+
+// Empty the FRAM log if the host gives the used bytes it last saw, then
+// report it
+static void fram_log_command(unsigned int length) {
+    unsigned char p[13];
+    unsigned int hours;
+    
+    p[12] = (length >= 6) ? fram_log_clear(get_u32(&cmd_frame[2])) : 0;
+    hours = fram_log_hours_left();
+    put_u32(&p[0], fram_log_head);
+    put_u32(&p[4], FRAM_LOG_BYTES);
+    p[8] = fram_log_dropped & 0xFF;
+    p[9] = fram_log_dropped >> 8;
+    p[10] = hours & 0xFF;
+    p[11] = hours >> 8;
+    tlm_send_frame_blocking(TLM_TYPE_FRAM_LOG, 0, 0, p, sizeof(p));
+}
+#else
+// Stream sectors [start, start + count) with a windowed ACK protocol
+static void read_sectors(unsigned int length) {
+    unsigned long start, count, sent = 0, acked = 0;
+    unsigned char window;
+    unsigned char status = READOUT_OK;
+    unsigned char header[4];
+    
+    if (length < 11) {
+        return;
+    }
+    start = get_u32(&cmd_frame[2]);
+    count = get_u32(&cmd_frame[6]);
+    window = cmd_frame[10];
+    if (window == 0 || window > READOUT_MAX_WINDOW) {
+        window = READOUT_MAX_WINDOW;
+    }
+    
+    // Commit staged data, then borrow sd_buffer as the sector buffer
+    __disable_interrupt();
+    sd_paused = 1;
+    write_readings_to_sd();
+    flush_buffer_to_sd(FLUSH_READOUT);
+    __enable_interrupt();
+    uart_exclusive = 1;
+    
+    if (count == 0) {
+        count = (current_sector > start) ? current_sector - start : 0;
+    }
+    TRACE_EVENT(TR_READOUT_START, count);
+    
+    if (!sd_initialized ||
+        (count > 0 && mmc_read_multiple_begin(mmc_sector_address(start)) != MMC_SUCCESS)) {
+        status = READOUT_CARD_ERROR;
+        count = 0;
+    }
+    
+    while (sent < count) {
+        WDT_KICK();               // A long readout holds up the main loop
+        
+        status = collect_acks(sent, &acked, window);
+        if (status != READOUT_OK) {
+            break;
+        }
+        
+        if (mmc_read_multiple_next(sd_buffer) != MMC_SUCCESS) {
+            status = READOUT_CARD_ERROR;
+            break;
+        }
+        put_u32(header, start + sent);
+        tlm_send_frame_blocking(TLM_TYPE_SECTOR, header, 4, sd_buffer, MMC_BLOCK_SIZE);
+        sent++;
+    }
+    
+    if (count > 0 && status != READOUT_CARD_ERROR) {
+        mmc_read_multiple_end();
+    }
+    
+    send_done(status, sent);
+    
+    // Resume logging in a fresh sector
+    __disable_interrupt();
+    buffer_position = SECTOR_HEADER_LEN;
+    uart_exclusive = 0;
+    sd_paused = 0;
+    __enable_interrupt();
+}
+#endif
+
+// Apply a new flush policy if one is given, then report the one in effect
+static void set_flush(unsigned int length) {
+    unsigned char p[8];
+    
+    if (length >= 8) {
+        flush_policy_set(cmd_frame[2] | (cmd_frame[3] << 8),
+                         cmd_frame[4] | (cmd_frame[5] << 8),
+                         cmd_frame[6] | (cmd_frame[7] << 8));
+    }
+    p[0] = flush_policy.high_water & 0xFF;
+    p[1] = flush_policy.high_water >> 8;
+    p[2] = flush_policy.max_age_s & 0xFF;
+    p[3] = flush_policy.max_age_s >> 8;
+    p[4] = flush_policy.lookahead_s & 0xFF;
+    p[5] = flush_policy.lookahead_s >> 8;
+    p[6] = event_rate & 0xFF;
+    p[7] = event_rate >> 8;
+    tlm_send_frame_blocking(TLM_TYPE_FLUSH_POLICY, 0, 0, p, sizeof(p));
+}
+
+// Apply new band settings if given, and holdoffs if they follow, then
+// report them with the per-band counts and retriggers since the last
+// housekeeping record
+static void set_bands(unsigned int length) {
+    unsigned char p[29];
+    unsigned int us[4];
+    unsigned char i;
+    
+    if (length >= 7) {
+        band_config_set(cmd_frame[2], &cmd_frame[3]);
+    }
+    if (length >= 15) {
+        for (i = 0; i < 4; i++) {
+            us[i] = cmd_frame[7 + 2 * i] | ((unsigned int)cmd_frame[8 + 2 * i] << 8);
+        }
+        holdoff_set(us);
+    }
+    p[0] = band_config.enable;
+    for (i = 0; i < 4; i++) {
+        p[1 + i] = band_config.prescale[i];
+        p[5 + 2 * i] = band_counts[i] & 0xFF;
+        p[6 + 2 * i] = band_counts[i] >> 8;
+        p[13 + 2 * i] = holdoff_us[i] & 0xFF;
+        p[14 + 2 * i] = holdoff_us[i] >> 8;
+        p[21 + 2 * i] = retrig_counts[i] & 0xFF;
+        p[22 + 2 * i] = retrig_counts[i] >> 8;
+    }
+    tlm_send_frame_blocking(TLM_TYPE_BANDS, 0, 0, p, sizeof(p));
+}
+
+// Apply a new log policy if one is given, then report the log ring
+static void set_log(unsigned int length) {
+    unsigned char p[22];
+    unsigned int sessions;
+    unsigned int hours;
+    
+    if (length >= 3) {
+        log_policy_set(cmd_frame[2]);
+    }
+    sessions = log_session_count();
+    hours = log_hours_left();
+    p[0] = log_policy;
+    p[1] = sd_state;
+    put_u32(&p[2], log_capacity);
+    put_u32(&p[6], current_sector);
+    put_u32(&p[10], log_tail_sector());
+    p[14] = sessions & 0xFF;
+    p[15] = sessions >> 8;
+    put_u32(&p[16], log_free_sectors());
+    p[20] = hours & 0xFF;
+    p[21] = hours >> 8;
+    tlm_send_frame_blocking(TLM_TYPE_LOG, 0, 0, p, sizeof(p));
+}
+
+// Send the trace ring, oldest entry first (empty when compiled out)
+static void send_trace(void) {
+    unsigned char header[2] = {0, 0};
+#if TRACE_LEVEL > TRACE_LEVEL_FLIGHT
+    TraceEntry entries[TRACE_RING_SIZE];
+    unsigned int count = trace_snapshot(entries);
+    
+    header[0] = trace_total & 0xFF;
+    header[1] = trace_total >> 8;
+    tlm_send_frame_blocking(TLM_TYPE_TRACE, header, 2,
+                            (unsigned char*)entries, count * sizeof(TraceEntry));
+#else
+    tlm_send_frame_blocking(TLM_TYPE_TRACE, header, 2, 0, 0);
+#endif
+}
+
+// Handle a waiting command frame (called from the main loop)
+void readout_service(void) {
+    unsigned int n = take_command();
+    
+    if (n < 2) {
+        return;
+    }
+    switch (cmd_frame[0]) {
+        case TLM_CMD_PING:
+            send_pong(n);
+            break;
+        case TLM_CMD_SET_BAUD:
+            set_baud(n);
+            break;
+        case TLM_CMD_READ:
+            read_sectors(n);
+            break;
+        case TLM_CMD_TRACE_DUMP:
+            send_trace();
+            break;
+        case TLM_CMD_SET_FLUSH:
+            set_flush(n);
+            break;
+        case TLM_CMD_SET_BANDS:
+            set_bands(n);
+            break;
+        case TLM_CMD_SET_LOG:
+            set_log(n);
+            break;
+#if LOG_FRAM
+        case TLM_CMD_FRAM_LOG:
+            fram_log_command(n);
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
+#endif /* BOARD_HAS_UART */
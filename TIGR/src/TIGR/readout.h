@@ -0,0 +1,46 @@
+// readout.h
+// Bulk SD card readout over the back channel UART
+//
+// The host (TIGRAnalyzer/tigr_uart_readout.py) sends telemetry-framed
+// commands (see telemetry.h). Typical session:
+//   PING -> PONG                 link check at 115200
+//   SET_BAUD -> BAUD_ACK         both sides switch; the next frame must
+//   PING -> PONG                 arrive within READOUT_BAUD_TIMEOUT or
+//                                the MCU falls back to 115200
+//   READ -> SECTOR ... READ_DONE sectors stream with a CMD18 multi-block
+//                                read; the host ACKs as they arrive and the
+//                                MCU keeps at most <window> unacknowledged
+//   TRACE_DUMP -> TRACE          trace ring contents (trace.h)
+//   SET_FLUSH -> FLUSH_POLICY    change or query the flush policy
+//                                (flush_policy.h)
+//   SET_BANDS -> BANDS           change or query the band enables,
+//                                prescales (prescale.h) and retrigger
+//                                holdoffs (holdoff.h)
+//   SET_LOG -> LOG               change the log ring policy or query the
+//                                ring and card time left (log_manager.h)
+//   FRAM_LOG -> FRAM_LOG         query or empty the FRAM log (LOG_FRAM
+//                                builds, fram_log.h)
+// While a readout runs the SD writer is paused and other UART output is
+// suppressed. Muon events keep staging in RAM. In LOG_FRAM builds READ
+// streams the FRAM log as blocks instead, and logging goes on.
+
+#ifndef _TIGR_READOUT_H
+#define _TIGR_READOUT_H
+
+#include "tigr_config.h"
+
+#define READOUT_DEFAULT_BAUD   115200UL
+#define READOUT_BAUD_TIMEOUT   TICK_HZ          // 1 s to confirm a new baud rate
+#define READOUT_ACK_TIMEOUT    (2 * TICK_HZ)    // 2 s without an ACK aborts
+#define READOUT_MAX_WINDOW     32
+
+// READ_DONE status codes
+#define READOUT_OK             0x00
+#define READOUT_ABORTED        0x01
+#define READOUT_TIMEOUT        0x02
+#define READOUT_CARD_ERROR     0x03
+
+// Function prototypes
+void readout_service(void);
+
+#endif /* _TIGR_READOUT_H */
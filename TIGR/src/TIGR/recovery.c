@@ -0,0 +1,86 @@
+// recovery.c
+// Watchdog and recovery over a reset (see recovery.h)
+
+#include "recovery.h"
+#include "sd_utils.h"
+#include "tigr_utils.h"
+#include "trace.h"
+
+#define RECOVERY_MAGIC      0x5257
+
+// RTC and muon count at the last kick
+typedef struct {
+    unsigned int magic;          // RECOVERY_MAGIC while valid
+    unsigned int muon_count;
+    RtcTime time;
+} RecoveryClock;
+
+#pragma PERSISTENT(recovery_record)
+static RecoveryClock recovery_record = {0};
+
+unsigned int reset_cause = 0;
+static unsigned int checkpoint_at = 0;   // uptime_s of the last log checkpoint
+
+// Read the reset cause, with the watchdog still held. SYSRSTIV hands out
+// pending causes highest priority first; the rest are read off so the
+// next reset reports its own.
+void recovery_init(void) {
+    reset_cause = SYSRSTIV;
+    while (SYSRSTIV != 0) {
+    }
+}
+
+// Carry the RTC and muon count over a reset. Called while the RTC is
+// being set, after the start-up defaults and before it ticks.
+void recovery_clock(void) {
+    RtcTime time;
+    
+    if (recovery_record.magic != RECOVERY_MAGIC) {
+        return;
+    }
+    time = recovery_record.time;
+    if (reset_cause == RESET_WDT_TIMEOUT) {
+        rtc_time_add_seconds(&time, WDT_PERIOD_S);
+    }
+    RTCYEAR = time.year;
+    RTCMON = time.month;
+    RTCDAY = time.day;
+    RTCHOUR = time.hour;
+    RTCMIN = time.minute;
+    RTCSEC = time.second;
+    muon_count = recovery_record.muon_count;
+}
+
+// Start the watchdog once the log is running, with a first checkpoint
+void recovery_start(void) {
+    WDT_KICK();
+    checkpoint_at = uptime_s;
+    sd_rescue_save();
+}
+
+// Main loop pass: kick the watchdog, record the RTC and muon count, and
+// checkpoint the log every RECOVERY_PERIOD_S
+void recovery_kick(void) {
+    WDT_KICK();
+    
+    __disable_interrupt();
+    FRAM_WRITE_ENABLE();                 // recovery_record is in program FRAM
+    recovery_record.magic = 0;
+    recovery_record.muon_count = muon_count;
+    do {                                 // Again if RTC_C ticked meanwhile
+        recovery_record.time.year = RTCYEAR;
+        recovery_record.time.month = RTCMON;
+        recovery_record.time.day = RTCDAY;
+        recovery_record.time.hour = RTCHOUR;
+        recovery_record.time.minute = RTCMIN;
+        recovery_record.time.second = RTCSEC;
+    } while (recovery_record.time.second != RTCSEC);
+    recovery_record.magic = RECOVERY_MAGIC;
+    FRAM_WRITE_DISABLE();
+    __enable_interrupt();
+    
+    if ((unsigned int)(uptime_s - checkpoint_at) >= RECOVERY_PERIOD_S) {
+        checkpoint_at = uptime_s;
+        sd_rescue_save();
+    }
+}
@@ -0,0 +1,55 @@
+// recovery.h
+// Watchdog and recovery over a reset
+//
+// The watchdog runs from ACLK in watchdog mode and resets the CPU if the
+// main loop does not come round within WDT_PERIOD_S, e.g. when a card
+// stops answering. The main loop wakes at least every HK_INTERVAL_S and
+// kicks it on each pass with recovery_kick(), which also records the RTC
+// and muon count in FRAM. Long work in the main loop (a UART readout on
+// the FR6989) kicks with WDT_KICK() as it goes.
+//
+// After a reset:
+//   - the cause is read from SYSRSTIV (reset_cause), traced and logged as
+//     an "RS,YYYY-MM-DD,HH:MM:SS,Cause" record after the CSV header
+//   - the RTC and muon count carry on from the last kick; after a
+//     watchdog timeout the RTC is moved on by WDT_PERIOD_S to when the
+//     reset happened. After a power loss the time stood still meanwhile.
+//   - the log carries on (sd_utils.h): the sector sequence number and the
+//     hold ring are kept in FRAM as they change, and the staged events and
+//     partial sector come back from the last checkpoint, taken every
+//     RECOVERY_PERIOD_S on a main loop pass (more often while the supply
+//     is low, supply.h). Events after it are lost; the muon numbers skip
+//     them.
+// The log sessions on the card are joined by the extractor, since the
+// sequence numbers go on.
+
+#ifndef _TIGR_RECOVERY_H
+#define _TIGR_RECOVERY_H
+
+#include "tigr_config.h"
+
+// Watchdog mode, ACLK / 2^23 = 256 s
+#define WDT_PERIOD_S        256
+#define WDT_CONFIG          (WDTPW | WDTSSEL__ACLK | WDTIS__8192K)
+#define WDT_KICK()          (WDTCTL = WDT_CONFIG | WDTCNTCL)
+
+// SYSRSTIV values (the same on both parts)
+#define RESET_BOR           0x02     // Power-on or brownout
+#define RESET_PIN           0x04     // RST pin
+#define RESET_SVSH          0x0E     // SVSH: supply fell below the supervisor level
+#define RESET_WDT_TIMEOUT   0x16     // Watchdog not kicked in time
+#define RESET_WDT_PASSWORD  0x18     // WDTCTL written without the password
+
+#ifndef RECOVERY_PERIOD_S
+#define RECOVERY_PERIOD_S   10       // Seconds between log checkpoints
+#endif
+
+extern unsigned int reset_cause;     // First SYSRSTIV value read at boot
+
+// Function prototypes
+void recovery_init(void);
+void recovery_clock(void);
+void recovery_start(void);
+void recovery_kick(void);
+
+#endif /* _TIGR_RECOVERY_H */
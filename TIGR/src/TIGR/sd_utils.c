@@ -0,0 +1,751 @@
+// sd_utils.c
+// SD Card data logging implementation for TIGR project
+
+#include <string.h>
+#include "sd_utils.h"
+#include "tigr_config.h"
+#include "tigr_mmc.h"
+#include "tigr_utils.h"
+#include "temp_utils.h"
+#include "UART.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "flush_policy.h"
+#include "histogram.h"
+#include "prescale.h"
+#include "clock.h"
+#include "log_manager.h"
+#include "supply.h"
+#include "holdoff.h"
+#include "recovery.h"
+#include "fram_log.h"
+
+volatile unsigned char sd_paused = 0;        // Set while a UART readout or card init owns the bus
+volatile unsigned int events_dropped = 0;    // Events lost because staging was full
+
+#if BOARD_HAS_UART
+// Display buffer contents to UART (for debugging)
+void display_buffer_contents(void) {
+    unsigned int i;
+    
+    UART1string("\r\n========== SD BUFFER CONTENTS ==========\r\n");
+    UART1string("Sector: ");
+    char sector_str[12];
+    uint_to_string((unsigned int)current_sector, sector_str);
+    UART1string((unsigned char*)sector_str);
+    UART1string("\r\n");
+    UART1string("Buffer Position: ");
+    char pos_str[12];
+    uint_to_string(buffer_position, pos_str);
+    UART1string((unsigned char*)pos_str);
+    UART1string(" bytes\r\n");
+    UART1string("--------------------------------------------\r\n");
+    
+    // Display the log text after the sector header
+    for (i = SECTOR_HEADER_LEN; i < buffer_position; i++) {
+        UART1send(sd_buffer[i]);
+    }
+    
+    UART1string("\r\n========================================\r\n\r\n");
+}
+#endif
+
+volatile unsigned char unwritten = 0;        // Log data not yet on the card
+volatile unsigned int unwritten_since = 0;   // uptime_s of the oldest of it
+
+// Start the age of unwritten data if nothing was waiting
+static inline void mark_unwritten(unsigned int uptime) {
+    if (!unwritten) {
+        unwritten = 1;
+        unwritten_since = uptime;
+    }
+}
+
+volatile unsigned char sd_state = SD_NO_CARD;
+volatile unsigned char sd_service_due = 0;   // Set when sd_service() has work
+static unsigned char sd_wait = 0;            // Seconds until the next init attempt
+static unsigned char sd_tries = 0;           // Init attempts since insertion
+
+// Sectors the card could not take yet, oldest first. They stay in FRAM so
+// a long absence does not cost RAM, and with the ring position they are
+// kept over a reset.
+#pragma PERSISTENT(sd_hold)
+static unsigned char sd_hold[SD_HOLD_SECTORS][SD_BUFFER_SIZE] = {{0}};
+#pragma PERSISTENT(hold_first)
+static unsigned char hold_first = 0;
+#pragma PERSISTENT(hold_count)
+static volatile unsigned char hold_count = 0;
+
+// Write one finished sector at the head of the log ring. Returns 0 if
+// the card was pulled before it took the sector, or is full under
+// LOG_STOP; the sector is then kept for later. Any other failure
+// consumes the sector.
+static unsigned char card_write(unsigned char* sector) {
+    unsigned char result;
+    
+    clock_boost();                     // SPI at the boost clock's bit rate
+    result = log_write(sector);
+    clock_release();
+    if (result == LOG_CARD_FULL) {
+        sd_initialized = 0;
+        sd_state = SD_FULL;
+        TRACE_EVENT(TR_SD_STATE, sd_state);
+        return 0;
+    } else if (result != MMC_SUCCESS) {
+        if (!CARD_PRESENT()) {
+            return 0;
+        }
+        TRACE_EVENT(TR_SD_WRITE_FAIL, current_sector);
+    }
+    return 1;
+}
+
+// Write the oldest held sector. Called with interrupts disabled.
+static void release_held(void) {
+    if (card_write(sd_hold[hold_first])) {
+        FRAM_WRITE_ENABLE();           // Program FRAM writable
+        hold_first = (hold_first + 1) % SD_HOLD_SECTORS;
+        hold_count--;
+        FRAM_WRITE_DISABLE();
+        TRACE_EVENT(TR_SD_HELD, hold_count);
+    }
+}
+
+// Keep sd_buffer in the hold ring; dropped if the ring is full
+static void hold_sector(unsigned int used) {
+    if (hold_count == SD_HOLD_SECTORS) {
+        TRACE_EVENT(TR_SD_NO_CARD, used);
+#if BOARD_HAS_UART
+        // Debug mode: show what would have been written
+        display_buffer_contents();
+#endif
+        return;
+    }
+    FRAM_WRITE_ENABLE();               // Program FRAM writable
+    memcpy(sd_hold[(hold_first + hold_count) % SD_HOLD_SECTORS], sd_buffer, SD_BUFFER_SIZE);
+    hold_count++;
+    FRAM_WRITE_DISABLE();
+    TRACE_EVENT(TR_SD_HELD, hold_count);
+}
+
+// Write the sector buffer as the next log sector and start a new one.
+// used is the payload length; only a partial flush writes less than
+// SECTOR_PAYLOAD. A failed write still consumes a sequence number, so the
+// extractor sees the gap and drops the line cut by it. While the card is
+// not ready, the supply is low, or earlier sectors are still held, the
+// sector joins the hold ring instead; a full ring makes room by writing
+// its oldest sector.
+static void write_sector(unsigned int used, unsigned char reason) {
+    used |= (unsigned int)reason << SECTOR_REASON_SHIFT;
+    TRACE_EVENT(TR_SD_FLUSH, used);
+    
+    sd_buffer[0] = SECTOR_MAGIC0;
+    sd_buffer[1] = SECTOR_MAGIC1;
+    sd_buffer[2] = (unsigned char)sector_seq;
+    sd_buffer[3] = (unsigned char)(sector_seq >> 8);
+    sd_buffer[4] = (unsigned char)(sector_seq >> 16);
+    sd_buffer[5] = (unsigned char)(sector_seq >> 24);
+    sd_buffer[6] = (unsigned char)used;
+    sd_buffer[7] = (unsigned char)(used >> 8);
+    FRAM_WRITE_ENABLE();               // sector_seq is in program FRAM
+    sector_seq++;
+    FRAM_WRITE_DISABLE();
+    
+    if (sd_initialized && hold_count == SD_HOLD_SECTORS) {
+        release_held();                // Make room, oldest first
+    }
+    if (!sd_initialized || supply_low || hold_count > 0 || !card_write(sd_buffer)) {
+        hold_sector(used);
+    }
+    
+    // Bytes past used are never read back, so the buffer is not cleared
+    buffer_position = SECTOR_HEADER_LEN;
+    
+    // Staged events left over are no younger than their anchor
+    unwritten = (reading_count > 0);
+    unwritten_since = stage_anchor.uptime;
+}
+
+#if LOG_FRAM
+// Lines go to the FRAM log as they are (fram_log.h)
+static void append_bytes(const char* src, unsigned int length) {
+    fram_log_line(src, length);
+}
+#else
+// Append bytes to the log, continuing in the next sector when this one fills
+static void append_bytes(const char* src, unsigned int length) {
+    while (length--) {
+        sd_buffer[buffer_position++] = *src++;
+        if (buffer_position == SD_BUFFER_SIZE) {
+            write_sector(SECTOR_PAYLOAD, FLUSH_FULL);
+        }
+    }
+    if (buffer_position > SECTOR_HEADER_LEN) {
+        mark_unwritten(uptime_s);
+    }
+}
+#endif
+
+// Write "YYYY-MM-DD,HH:MM:SS" from BCD fields at dst
+static char* put_timestamp(char* dst, unsigned int year, unsigned char month, unsigned char day,
+                           unsigned char hour, unsigned char minute, unsigned char second) {
+    dst = put_bcd4(dst, year);
+    *dst++ = '-';
+    dst = put_bcd2(dst, month);
+    *dst++ = '-';
+    dst = put_bcd2(dst, day);
+    *dst++ = ',';
+    dst = put_bcd2(dst, hour);
+    *dst++ = ':';
+    dst = put_bcd2(dst, minute);
+    *dst++ = ':';
+    return put_bcd2(dst, second);
+}
+
+// Write one event line at dst, return the next free position
+// Format: "MMMMM,B,YYYY-MM-DD,HH:MM:SS\n" (EVENT_LINE_LEN bytes, muon number zero-padded)
+char* format_event(char* dst, unsigned int muon_number, unsigned char band, const RtcTime* time) {
+    dst = put_uint5(dst, muon_number);
+    dst[0] = ',';
+    dst[1] = '0' + band;
+    dst[2] = ',';
+    dst = put_timestamp(dst + 3, time->year, time->month, time->day,
+                        time->hour, time->minute, time->second);
+    *dst++ = '\n';
+    return dst;
+}
+
+// Band logged for a staged band mask: the highest band set, as the ISR
+// would have reported it
+static const unsigned char mask_band[16] = { 0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+
+// Format staged readings into the log and empty the staging array.
+// Sectors are written as they fill; the partial one stays in sd_buffer.
+static void append_readings(void) {
+    unsigned int i;
+    unsigned int muon_number = stage_anchor.muon_number;
+    unsigned char offset = 0;
+    RtcTime time = stage_anchor.time;
+#if !LOG_FRAM
+    char line[EVENT_LINE_LEN];
+#endif
+    
+    for (i = 0; i < reading_count; i++, muon_number++) {
+        muon_number += readings[i].band_mask >> STAGE_SKIP_SHIFT;
+        // Offsets never decrease within a batch
+        if (readings[i].second_offset != offset) {
+            rtc_time_add_seconds(&time, readings[i].second_offset - offset);
+            offset = readings[i].second_offset;
+        }
+#if LOG_FRAM
+        fram_log_event(muon_number, mask_band[readings[i].band_mask & 0x0F],
+                       stage_anchor.uptime + offset, &time);
+#else
+        if (buffer_position <= SD_BUFFER_SIZE - EVENT_LINE_LEN) {
+            // Line fits: format it in place
+            format_event((char*)&sd_buffer[buffer_position], muon_number,
+                         mask_band[readings[i].band_mask & 0x0F], &time);
+            buffer_position += EVENT_LINE_LEN;
+            if (buffer_position == SD_BUFFER_SIZE) {
+                write_sector(SECTOR_PAYLOAD, FLUSH_FULL);
+            }
+        } else {
+            // Line continues in the next sector
+            format_event(line, muon_number, mask_band[readings[i].band_mask & 0x0F], &time);
+            append_bytes(line, EVENT_LINE_LEN);
+        }
+#endif
+    }
+    reading_count = 0;
+}
+
+static unsigned int last_tick = 0;       // TICK_NOW() at the previous event
+static unsigned int last_uptime = 0;     // uptime_s at the previous event
+static unsigned int stage_next = 0;      // Muon number after the last staged event
+static unsigned char stage_skipped = 0;  // Events prescaled away since then
+
+// Function to save current reading. The first event of a batch records
+// the anchor (muon number and RTC); the rest store only their offsets.
+// Events the band's prescale skips are only counted.
+void save_reading(unsigned char band) {
+    unsigned int now;
+    unsigned int uptime;
+    unsigned int offset;
+    StagedEvent* event;
+    
+    if (!prescale_keep(band)) {
+        if (stage_skipped < 0xFF) {
+            stage_skipped++;
+        }
+        return;
+    }
+    
+    now = TICK_NOW();
+    uptime = uptime_s;
+    
+    // The RTC registers have already ticked if RTC_ISR is still pending
+    if (RTC_TICK_PENDING()) {
+        uptime++;
+    }
+    offset = uptime - stage_anchor.uptime;
+    
+    if (reading_count > 0 && (offset > STAGE_MAX_OFFSET || stage_skipped > STAGE_MAX_SKIP ||
+                              stage_next + stage_skipped != muon_count)) {
+        if (sd_paused) {
+            events_dropped++;        // Writer paused, batch cannot be logged
+            TRACE_EVENT(TR_EVENT_DROPPED, events_dropped);
+            return;
+        }
+        // Offset or skip count would not fit, or detections were counted
+        // into histogram bins since: log this batch and start another
+        append_readings();
+    }
+    if (reading_count >= MAX_READINGS) {
+        events_dropped++;            // Writer paused and staging full
+        TRACE_EVENT(TR_EVENT_DROPPED, events_dropped);
+        return;
+    }
+    if (reading_count == 0) {
+        stage_anchor.muon_number = muon_count;
+        stage_anchor.uptime = uptime;
+        // Read current RTC values (they are in BCD format)
+        stage_anchor.time.year = RTCYEAR;
+        stage_anchor.time.month = RTCMON;
+        stage_anchor.time.day = RTCDAY;
+        stage_anchor.time.hour = RTCHOUR;
+        stage_anchor.time.minute = RTCMIN;
+        stage_anchor.time.second = RTCSEC;
+        offset = 0;
+        mark_unwritten(uptime);
+    }
+    
+    // The 16-bit tick counter wraps every 16 s
+    event = &readings[reading_count];
+    event->tick_delta = (uptime - last_uptime < 15) ? now - last_tick : TICK_DELTA_LONG;
+    event->band_mask = (1 << (band - 1)) |
+                       (reading_count ? stage_skipped << STAGE_SKIP_SHIFT : 0);
+    event->second_offset = (unsigned char)offset;
+    last_tick = now;
+    last_uptime = uptime;
+    stage_next = muon_count + 1;
+    stage_skipped = 0;
+    
+#if TLM_EVENTS
+    // Live binary telemetry
+    tlm_send_event(muon_count, band);
+#endif
+    TRACE_VERBOSE(TR_READING_SAVED, muon_count);
+    
+    reading_count++;
+#if LOG_FRAM
+    // Nothing waits in RAM: the event goes to FRAM at once
+    append_readings();
+    unwritten = 0;
+#endif
+}
+
+// Write readings to SD card, formatting the batch at the boost clock
+void write_readings_to_sd(void) {
+    clock_boost();
+    append_readings();
+    clock_release();
+}
+
+// Commit the partially filled sector; the log continues in the next one
+void flush_buffer_to_sd(unsigned char reason) {
+    if (buffer_position > SECTOR_HEADER_LEN) {
+        write_sector(buffer_position - SECTOR_HEADER_LEN, reason);
+    }
+}
+
+// Little-endian word at dst, return the next free position
+static unsigned char* put_word(unsigned char* dst, unsigned int value) {
+    dst[0] = (unsigned char)value;
+    dst[1] = (unsigned char)(value >> 8);
+    return dst + 2;
+}
+
+// Fill the session header (sd_utils.h) at p, return its length
+static unsigned int format_session(unsigned char* p) {
+    unsigned char* q;
+    unsigned char i;
+    
+    memset(p, 0, SESSION_LEN);
+    p[0] = SESSION_MAGIC0;
+    p[1] = SESSION_MAGIC1;
+    p[2] = SESSION_VERSION;
+    p[3] = TIGR_BOARD;
+    put_word(&p[4], TIGR_FW_VERSION);
+    put_word(&p[6], DETECTOR_ID);
+    put_word(&p[8], RTCYEAR);
+    p[10] = RTCMON;
+    p[11] = RTCDAY;
+    p[12] = RTCHOUR;
+    p[13] = RTCMIN;
+    p[14] = RTCSEC;
+    p[15] = log_policy;
+    put_word(&p[16], reset_cause);
+    put_word(&p[18], muon_count);
+    p[20] = band_config.enable;
+    memcpy(&p[21], band_config.prescale, 4);
+#if LOG_FRAM
+    p[25] |= SESSION_LOG_FRAM;
+#endif
+#if TLM_EVENTS
+    p[25] |= SESSION_TLM_EVENTS;
+#endif
+    q = &p[26];
+    for (i = 0; i < 4; i++) {
+        q = put_word(q, holdoff_us[i]);
+    }
+    q = put_word(q, flush_policy.high_water);
+    q = put_word(q, flush_policy.max_age_s);
+    q = put_word(q, flush_policy.lookahead_s);
+    q = put_word(q, hist_policy.bin_s);
+    q = put_word(q, hist_policy.enter_rate);
+    q = put_word(q, hist_policy.exit_rate);
+    q = put_word(q, SUPPLY_LOW_MV);
+    q = put_word(q, SUPPLY_OK_MV);
+    q = put_word(q, HK_INTERVAL_S);
+    return q - p;
+}
+
+// Start this boot's log: the partial sector sd_rescue_restore() took back
+// is committed, then come a session header sector and the CSV header
+void sd_log_begin(void) {
+    unsigned char* session = &sd_buffer[SECTOR_HEADER_LEN];
+    unsigned int length;
+    
+    __disable_interrupt();
+#if LOG_FRAM
+    length = format_session(session);
+    fram_log_session(session, length);
+#else
+    flush_buffer_to_sd(FLUSH_BOOT);
+    length = format_session(session);
+    write_sector(length, FLUSH_SESSION);
+#endif
+    append_bytes(LOG_CSV_HEADER, sizeof(LOG_CSV_HEADER) - 1);
+    __enable_interrupt();
+}
+
+// Arm card detect and, if a card is already in, start bringing it up.
+// Logging starts without waiting: sectors are held until the card is ready.
+void sd_card_start(void) {
+    __disable_interrupt();
+    sd_card_detect();
+    __enable_interrupt();
+}
+
+// Card-detect change (port ISR, or sd_card_start()). The writer stops at
+// once; a card that is in is given SD_SETTLE_S seconds before the first
+// init attempt.
+void sd_card_detect(void) {
+    sd_initialized = 0;
+    if (mmc_detect_arm()) {
+        sd_state = SD_SETTLING;
+        sd_wait = SD_SETTLE_S;
+        sd_tries = 0;
+    } else {
+        sd_state = SD_NO_CARD;
+    }
+    TRACE_EVENT(TR_SD_STATE, sd_state);
+}
+
+// Called from the 1 Hz RTC interrupt. Returns nonzero when sd_service()
+// is due and the main loop has to wake.
+unsigned char sd_card_second(void) {
+    if (sd_state != SD_SETTLING || --sd_wait != 0) {
+        return 0;
+    }
+    sd_state = SD_INITIALIZING;
+    sd_service_due = 1;
+    return 1;
+}
+
+// Main loop side of the card: initialize it and open a log session with
+// interrupts enabled, then write out the held sectors one at a time. The
+// writer stays paused meanwhile, so no flush from the detection ISR
+// touches the SPI bus; a card-detect change meanwhile discards the result.
+void sd_service(void) {
+    unsigned char result;
+    unsigned long seq;
+    
+    sd_service_due = 0;
+    if (sd_state == SD_INITIALIZING) {
+        sd_paused = 1;
+        // The session starts with the oldest sector still to be written
+        seq = hold_count ? (unsigned long)sd_hold[hold_first][2] |
+                           ((unsigned long)sd_hold[hold_first][3] << 8) |
+                           ((unsigned long)sd_hold[hold_first][4] << 16) |
+                           ((unsigned long)sd_hold[hold_first][5] << 24)
+                         : sector_seq;
+        result = mmc_init();
+        if (result == MMC_SUCCESS) {
+            result = log_open(seq);
+        }
+        __disable_interrupt();
+        sd_paused = 0;
+        if (sd_state == SD_INITIALIZING) {
+            if (result == MMC_SUCCESS) {
+                sd_state = SD_READY;
+                sd_initialized = 1;
+            } else if (result == LOG_CARD_FULL) {
+                sd_state = SD_FULL;
+            } else if (++sd_tries < SD_INIT_TRIES) {
+                sd_state = SD_SETTLING;    // Try again next second
+                sd_wait = 1;
+            } else {
+                sd_state = SD_FAILED;      // Until the card is reinserted
+            }
+            TRACE_EVENT(TR_SD_STATE, sd_state);
+        }
+        __enable_interrupt();
+    }
+    
+    while (hold_count > 0) {
+        __disable_interrupt();
+        if (!sd_initialized || supply_low || hold_count == 0) {
+            __enable_interrupt();
+            break;
+        }
+        release_held();
+        __enable_interrupt();
+    }
+}
+
+// Checkpoint of the log state held in RAM (see sd_utils.h)
+#pragma PERSISTENT(sd_rescue)
+SdRescue sd_rescue = {0};
+
+// Commit staged events and the partial sector to FRAM. The record is
+// invalid while it is being copied, so a reset meanwhile loses this
+// checkpoint rather than restoring half of it.
+void sd_rescue_save(void) {
+    __disable_interrupt();
+    FRAM_WRITE_ENABLE();               // Program FRAM writable
+    sd_rescue.magic = 0;
+    sd_rescue.muon_count = muon_count;
+    sd_rescue.sector_seq = sector_seq;
+    sd_rescue.buffer_position = buffer_position;
+    sd_rescue.reading_count = reading_count;
+    sd_rescue.stage_anchor = stage_anchor;
+    memcpy(sd_rescue.readings, readings, reading_count * sizeof(StagedEvent));
+    memcpy(sd_rescue.buffer, sd_buffer, buffer_position);
+    sd_rescue.magic = SD_RESCUE_MAGIC;
+    FRAM_WRITE_DISABLE();
+    __enable_interrupt();
+    
+    TRACE_EVENT(TR_SD_RESCUED, buffer_position - SECTOR_HEADER_LEN);
+}
+
+// At boot, before sd_log_begin(): take back the last checkpoint. It only
+// still applies if no sector was finished after it; that sector already
+// holds the checkpointed text. Returns nonzero if it was taken back.
+unsigned char sd_rescue_restore(void) {
+    unsigned char restored = 0;
+    
+    __disable_interrupt();
+    if (sd_rescue.magic == SD_RESCUE_MAGIC && sd_rescue.sector_seq == sector_seq &&
+        sd_rescue.buffer_position >= SECTOR_HEADER_LEN &&
+        sd_rescue.buffer_position < SD_BUFFER_SIZE &&
+        sd_rescue.reading_count <= MAX_READINGS) {
+        buffer_position = sd_rescue.buffer_position;
+        memcpy(sd_buffer, sd_rescue.buffer, buffer_position);
+        reading_count = sd_rescue.reading_count;
+        stage_anchor = sd_rescue.stage_anchor;
+        memcpy(readings, sd_rescue.readings, reading_count * sizeof(StagedEvent));
+        // Muon numbers are those of the old batch: it goes into the log now
+        append_readings();
+        unwritten = 0;                 // Aged from sd_log_begin() on
+        restored = 1;
+    }
+    FRAM_WRITE_ENABLE();               // Program FRAM writable
+    sd_rescue.magic = 0;
+    FRAM_WRITE_DISABLE();
+    __enable_interrupt();
+    
+    TRACE_EVENT(TR_SD_RESTORED, hold_count);
+    return restored;
+}
+
+// Append a housekeeping record to the log
+// Format: "HK,YYYY-MM-DD,HH:MM:SS,TempC,SupplymV,DeadMs,Events,B1,B2,B3,B4,HoursLeft,Retrig\n"
+// DeadMs is the time spent in the detection ISR since the previous record,
+// HoursLeft the card (or FRAM log) time left at the current rate,
+// Retrig the band retriggers held off since the previous record (holdoff.h).
+// The record stays in sd_buffer until its sector fills.
+void log_housekeeping(void) {
+    char line[HK_LINE_MAX];
+    char* p;
+    unsigned long dead_ms;
+    unsigned char i;
+    
+    // ADC conversions run before interrupts are masked
+    int temperature = read_temperature();
+    unsigned int supply_mv = read_supply_voltage();
+    
+    __disable_interrupt();
+    
+    // Convert ticks to ms: ms = ticks * 1000 / 4096 = ticks * 125 / 512
+    dead_ms = (dead_ticks * 125) >> 9;
+    dead_ticks = 0;
+    if (dead_ms > 0xFFFF) {
+        dead_ms = 0xFFFF;
+    }
+    
+    // A closed histogram bin and staged events precede this record in time
+    if (hist_due) {
+        hist_service();
+    }
+    append_readings();
+    
+    memcpy(line, "HK,", 3);
+    p = put_timestamp(&line[3], RTCYEAR, RTCMON, RTCDAY, RTCHOUR, RTCMIN, RTCSEC);
+    *p++ = ',';
+    int_to_string(temperature, p);
+    p += strlen(p);
+    *p++ = ',';
+    uint_to_string(supply_mv, p);
+    p += strlen(p);
+    *p++ = ',';
+    uint_to_string((unsigned int)dead_ms, p);
+    p += strlen(p);
+    *p++ = ',';
+    uint_to_string(muon_count, p);
+    p += strlen(p);
+    // Exact per-band detections, prescaled or not
+    for (i = 0; i < 4; i++) {
+        *p++ = ',';
+        uint_to_string(band_counts[i], p);
+        p += strlen(p);
+        band_counts[i] = 0;
+    }
+    *p++ = ',';
+#if LOG_FRAM
+    uint_to_string(fram_log_hours_left(), p);
+#else
+    uint_to_string(log_hours_left(), p);
+#endif
+    p += strlen(p);
+    *p++ = ',';
+    uint_to_string(retrig_take(), p);
+    p += strlen(p);
+    *p++ = '\n';
+    append_bytes(line, p - line);
+    
+    __enable_interrupt();
+    
+    // While low, this record goes to FRAM with the rest
+    supply_check(supply_mv);
+    
+#if BOARD_HAS_UART
+    tlm_send_housekeeping(temperature, supply_mv, (unsigned int)dead_ms, muon_count);
+    tlm_send_stats();
+#endif
+    
+    TRACE_EVENT(TR_HOUSEKEEPING, muon_count);
+    TRACE_EVENT(TR_SUPPLY_MV, supply_mv);
+}
+
+// Append a histogram bin record to the log (see histogram.h), with
+// interrupts disabled
+// Format: "H,YYYY-MM-DD,HH:MM:SS,Secs,Band1,Band2,Band3,Band4,Coinc,
+//          C12,C13,C23,C123,C14,C24,C124,C34,C134,C234,C1234\n"
+void log_histogram(const HistBin* bin) {
+    char line[HIST_LINE_MAX];
+    char* p;
+    unsigned char i;
+    unsigned int total = 0;
+    
+    // A batch staged before the switch to histogram mode precedes the bin;
+    // one staged since the switch back follows it
+    if (stage_next + stage_skipped == bin->muon_number) {
+        append_readings();
+    }
+    
+    memcpy(line, "H,", 2);
+    p = put_timestamp(&line[2], bin->start.year, bin->start.month, bin->start.day,
+                      bin->start.hour, bin->start.minute, bin->start.second);
+    *p++ = ',';
+    uint_to_string(bin->seconds, p);
+    p += strlen(p);
+    for (i = 0; i < 4; i++) {
+        *p++ = ',';
+        uint_to_string(bin->band[i], p);
+        p += strlen(p);
+        total += bin->band[i];
+    }
+    *p++ = ',';
+    uint_to_string(hist_coinc_total(bin), p);
+    p += strlen(p);
+    for (i = 0; i < HIST_COINC_MASKS; i++) {
+        *p++ = ',';
+        uint_to_string(bin->coincidence[i], p);
+        p += strlen(p);
+    }
+    *p++ = '\n';
+    append_bytes(line, p - line);
+    
+#if BOARD_HAS_UART
+    tlm_send_histogram(bin);
+#endif
+    
+    TRACE_EVENT(TR_HIST_BIN, total);
+}
+
+// Log the cause of the last reset (RS record, recovery.h)
+// Format: "RS,YYYY-MM-DD,HH:MM:SS,Cause\n", Cause the SYSRSTIV value
+void log_reset(unsigned int cause) {
+    char line[RS_LINE_MAX];
+    char* p;
+    
+    __disable_interrupt();
+    
+    memcpy(line, "RS,", 3);
+    p = put_timestamp(&line[3], RTCYEAR, RTCMON, RTCDAY, RTCHOUR, RTCMIN, RTCSEC);
+    *p++ = ',';
+    uint_to_string(cause, p);
+    p += strlen(p);
+    *p++ = '\n';
+    append_bytes(line, p - line);
+    
+    __enable_interrupt();
+    
+    TRACE_EVENT(TR_RESET, cause);
+}
+
+// Log the band enables, prescales and holdoffs (PS record), so the event
+// lines that follow can be weighted
+void log_band_config(void) {
+    char line[PS_LINE_MAX];
+    char* p;
+    unsigned char i;
+    
+    __disable_interrupt();
+    
+    // Staged events were logged under the previous settings
+    append_readings();
+    
+    memcpy(line, "PS,", 3);
+    p = put_timestamp(&line[3], RTCYEAR, RTCMON, RTCDAY, RTCHOUR, RTCMIN, RTCSEC);
+    *p++ = ',';
+    uint_to_string(band_config.enable, p);
+    p += strlen(p);
+    for (i = 0; i < 4; i++) {
+        *p++ = ',';
+        uint_to_string(band_config.prescale[i], p);
+        p += strlen(p);
+    }
+    for (i = 0; i < 4; i++) {
+        *p++ = ',';
+        uint_to_string(holdoff_us[i], p);
+        p += strlen(p);
+    }
+    *p++ = '\n';
+    append_bytes(line, p - line);
+    
+    __enable_interrupt();
+    
+    TRACE_EVENT(TR_BAND_CONFIG, ((unsigned int)band_config.enable << 8) | band_config.prescale[0]);
+}
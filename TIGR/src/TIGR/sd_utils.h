@@ -0,0 +1,124 @@
+// sd_utils.h
+// SD Card data logging interface for TIGR project
+// Handles higher-level data formatting and storage
+
+#ifndef _TIGR_SD_H
+#define _TIGR_SD_H
+
+#include <msp430.h>
+#include "tigr_config.h"
+#include "histogram.h"
+
+// The log is one text stream across sectors: lines may continue into the
+// next sector. Each sector starts with a header the extractor uses to put
+// the stream back together:
+//   [0-1] 'T','G'   [2-5] sequence number   [6-7] used
+// (little-endian). The low bits of used are the payload bytes; only a
+// partial flush writes fewer than SECTOR_PAYLOAD. The top four bits say
+// why the sector was written.
+#define SECTOR_MAGIC0       'T'
+#define SECTOR_MAGIC1       'G'
+#define SECTOR_HEADER_LEN   8
+#define SECTOR_PAYLOAD      (SD_BUFFER_SIZE - SECTOR_HEADER_LEN)
+#define SECTOR_USED_MASK    0x03FF
+#define SECTOR_REASON_SHIFT 12
+
+// Flush reasons (sector header, TR_SD_FLUSH)
+#define FLUSH_FULL          0    // Payload filled
+#define FLUSH_MAX_AGE       1    // Oldest unwritten data reached flush_policy.max_age_s
+#define FLUSH_READOUT       2    // Committed before a UART readout
+#define FLUSH_BOOT          3    // Partial sector carried over a reset, committed at boot
+#define FLUSH_SESSION       4    // Session header sector, no log text
+
+// Each boot starts its log with a session header sector (FLUSH_SESSION).
+// Its payload is binary, not log text, and says how the run that follows
+// was set up (little-endian):
+//   [0-1]   'T','S'   [2] version   [3] board (tigr_config.h)
+//   [4-5]   firmware version   [6-7] detector id (DETECTOR_ID)
+//   [8-14]  RTC at boot: year (2), month, day, hour, minute, second, BCD
+//   [15]    log policy (log_manager.h)
+//   [16-17] reset cause (SYSRSTIV)   [18-19] muon number at boot
+//   [20]    band enables   [21-24] prescales N1-N4   [25] build flags
+//   [26-33] holdoffs H1-H4 in microseconds
+//   [34-39] flush policy: high water, max age s, lookahead s
+//   [40-45] histogram policy: bin s, enter rate, exit rate
+//   [46-49] supply thresholds: low mV, ok mV   [50-51] HK interval s
+// The extractor lists the runs on a card by reading only the first sector
+// of each session in the metadata table (log_manager.h).
+#define SESSION_MAGIC0      'T'
+#define SESSION_MAGIC1      'S'
+#define SESSION_VERSION     1
+#define SESSION_LEN         52
+#define SESSION_LOG_FRAM    0x01 // Build flags: LOG_FRAM
+#define SESSION_TLM_EVENTS  0x02 //              TLM_EVENTS
+
+// Card state (sd_state). Logging never waits for the card: card detect
+// interrupts on insertion and removal, the card is initialized from the
+// main loop in the background, and until it is ready whole sectors are
+// held in FRAM and written in order once it is.
+#define SD_NO_CARD          0    // Card detect open
+#define SD_SETTLING         1    // Inserted, waiting before the next init attempt
+#define SD_INITIALIZING     2    // mmc_init() due or running in the main loop
+#define SD_READY            3    // Writing (sd_initialized set)
+#define SD_FAILED           4    // SD_INIT_TRIES attempts failed, waiting for reinsertion
+#define SD_FULL             5    // No room under LOG_STOP (log_manager.h), waiting for another card
+
+#define SD_SETTLE_S         1    // Insertion to first init attempt (contacts, card supply)
+#define SD_INIT_TRIES       3    // Attempts, one second apart
+#ifndef SD_HOLD_SECTORS
+#if TIGR_BOARD == BOARD_FR2355
+#define SD_HOLD_SECTORS     8     // Sectors held in FRAM without a card (4 KB of 32 KB)
+#else
+#define SD_HOLD_SECTORS     16    // Sectors held in FRAM without a card (8 KB of 128 KB)
+#endif
+#endif
+
+extern volatile unsigned char sd_state;
+extern volatile unsigned char sd_service_due;
+
+// What the log still has in RAM, checkpointed to FRAM by sd_rescue_save()
+// (recovery.h, supply.h) and taken back after a reset. The sector
+// sequence number and the hold ring are kept in FRAM as they change.
+typedef struct {
+    unsigned int magic;                 // SD_RESCUE_MAGIC while valid
+    unsigned int muon_count;            // Detections counted at the checkpoint
+    unsigned long sector_seq;           // Next sector at the checkpoint
+    unsigned int buffer_position;
+    unsigned int reading_count;
+    StageAnchor stage_anchor;
+    StagedEvent readings[MAX_READINGS];
+    unsigned char buffer[SD_BUFFER_SIZE];   // sd_buffer up to buffer_position
+} SdRescue;
+
+#define SD_RESCUE_MAGIC     0x5243
+
+extern SdRescue sd_rescue;
+
+#define LOG_CSV_HEADER      "Muon#,Band,Date,Time\n"
+
+// Event line "MMMMM,B,YYYY-MM-DD,HH:MM:SS\n" is fixed width
+#define EVENT_LINE_LEN 28
+#define HK_LINE_MAX    84        // "HK,<timestamp>,-273,65535,65535,65535,65535,65535,65535,65535,65535,65535\n"
+#define RS_LINE_MAX    29        // "RS,<timestamp>,65535\n"
+
+// Function prototypes
+void save_reading(unsigned char band);
+void write_readings_to_sd(void);
+void flush_buffer_to_sd(unsigned char reason);
+void sd_log_begin(void);
+char* format_event(char* dst, unsigned int muon_number, unsigned char band, const RtcTime* time);
+void sd_card_start(void);
+void sd_card_detect(void);
+unsigned char sd_card_second(void);
+void sd_service(void);
+void sd_rescue_save(void);
+unsigned char sd_rescue_restore(void);
+void log_housekeeping(void);
+void log_histogram(const HistBin* bin);
+void log_band_config(void);
+void log_reset(unsigned int cause);
+#if BOARD_HAS_UART
+void display_buffer_contents(void);  // Debug function
+#endif
+
+#endif /* _TIGR_SD_H */
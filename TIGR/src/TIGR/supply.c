@@ -0,0 +1,53 @@
+// supply.c
+// Supply monitor and power-fail commit (see supply.h)
+
+#include "supply.h"
+#include "sd_utils.h"
+#include "temp_utils.h"
+#include "trace.h"
+
+volatile unsigned char supply_low = 0;
+volatile unsigned char supply_due = 0;
+
+static unsigned char low_seconds = 0;    // Seconds since the last sample while low
+
+// Keep SVSH on in LPM3 and take the first sample. Called once the log
+// has started (after sd_rescue_restore()), since a low sample commits.
+void supply_init(void) {
+    PMMCTL0_H = PMMPW_H;
+    PMMCTL0_L |= SVSHE;
+    PMMCTL0_H = 0;
+    supply_check(read_supply_voltage());
+}
+
+// A new supply sample from the main loop
+void supply_check(unsigned int supply_mv) {
+    if (!supply_low && supply_mv < SUPPLY_LOW_MV) {
+        supply_low = 1;
+        low_seconds = 0;
+        TRACE_EVENT(TR_SUPPLY_LOW, supply_mv);
+    } else if (supply_low && supply_mv >= SUPPLY_OK_MV) {
+        supply_low = 0;
+        sd_service_due = 1;              // Held sectors to the card
+        TRACE_EVENT(TR_SUPPLY_OK, supply_mv);
+    }
+    if (supply_low) {
+        sd_rescue_save();
+    }
+}
+
+// Called from the 1 Hz RTC tick. Returns nonzero when a sample is
+// due and the main loop has to wake.
+unsigned char supply_second(void) {
+    if (!supply_low || ++low_seconds < SUPPLY_LOW_PERIOD_S) {
+        return 0;
+    }
+    low_seconds = 0;
+    supply_due = 1;
+    return 1;
+}
+
+void supply_service(void) {
+    supply_due = 0;
+    supply_check(read_supply_voltage());
+}
@@ -0,0 +1,45 @@
+// supply.h
+// Supply monitor and power-fail commit
+//
+// A coin cell sags long before it dies, and a card program draws tens of
+// mA it may no longer deliver. The supply is sampled with each
+// housekeeping record (read_supply_voltage(): AVCC/2 on A31 on the
+// FR6989; the FR2355 has no AVCC/2 channel, so AVCC is worked out from the
+// 1.5 V reference on A13). Below SUPPLY_LOW_MV the card takes no more
+// sectors: they go to the hold ring in FRAM (sd_utils.h), which only
+// writes to the card when it is full. What is still in RAM (staged
+// events, the partial sector) is checkpointed to FRAM with
+// sd_rescue_save() at once and then every SUPPLY_LOW_PERIOD_S seconds,
+// when the supply is sampled again, so a brownout reset loses at most
+// that much (recovery.h). At SUPPLY_OK_MV or above the held sectors go to
+// the card.
+// The high-side supervisor (SVSH) only resets the CPU, it cannot warn, so
+// it is kept on in LPM3 as the backstop.
+
+#ifndef _TIGR_SUPPLY_H
+#define _TIGR_SUPPLY_H
+
+#include "tigr_config.h"
+
+// Thresholds, override with -DSUPPLY_LOW_MV=n etc. SD cards are specified
+// down to 2.7 V.
+#ifndef SUPPLY_LOW_MV
+#define SUPPLY_LOW_MV           2750
+#endif
+#ifndef SUPPLY_OK_MV
+#define SUPPLY_OK_MV            2850
+#endif
+#ifndef SUPPLY_LOW_PERIOD_S
+#define SUPPLY_LOW_PERIOD_S     5        // Sampling and commit period while low
+#endif
+
+extern volatile unsigned char supply_low;     // Below SUPPLY_LOW_MV, card writes stopped
+extern volatile unsigned char supply_due;     // Set by the 1 Hz tick when a sample is due
+
+// Function prototypes
+void supply_init(void);
+void supply_check(unsigned int supply_mv);
+unsigned char supply_second(void);
+void supply_service(void);
+
+#endif /* _TIGR_SUPPLY_H */
@@ -0,0 +1,288 @@
+// telemetry.c
+// Binary live telemetry stream over the back channel UART
+// See telemetry.h for the frame format.
+
+#include "telemetry.h"
+#include "tigr_config.h"
+#include "UART.h"
+
+#if BOARD_HAS_UART
+
+volatile unsigned int tlm_dropped = 0;
+static unsigned char tlm_seq = 0;
+
+// Next frame sequence number; frames are sent from ISRs and the main loop
+static unsigned char tlm_next_seq(void) {
+    unsigned short state = __get_interrupt_state();
+    unsigned char seq;
+    
+    __disable_interrupt();
+    seq = tlm_seq++;
+    __set_interrupt_state(state);
+    return seq;
+}
+
+// CRC16-CCITT (poly 0x1021), bitwise to keep the table out of FRAM
+unsigned int crc16_ccitt(unsigned int crc, const unsigned char* data, unsigned int length) {
+    unsigned int i;
+    unsigned char bit;
+    
+    for (i = 0; i < length; i++) {
+        crc ^= (unsigned int)data[i] << 8;
+        for (bit = 0; bit < 8; bit++) {
+            if (crc & 0x8000) {
+                crc = (crc << 1) ^ 0x1021;
+            } else {
+                crc <<= 1;
+            }
+        }
+    }
+    return crc & 0xFFFF;                       // Keep 16 bits where int is wider
+}
+
+// COBS encode src into dst (dst needs length + length/254 + 1 bytes)
+// Returns the encoded length. No trailing delimiter is added.
+unsigned int cobs_encode(const unsigned char* src, unsigned int length, unsigned char* dst) {
+    unsigned int read_index = 0;
+    unsigned int write_index = 1;
+    unsigned int code_index = 0;
+    unsigned char code = 1;
+    
+    while (read_index < length) {
+        if (src[read_index] == 0) {
+            dst[code_index] = code;
+            code = 1;
+            code_index = write_index++;
+            read_index++;
+        } else {
+            dst[write_index++] = src[read_index++];
+            code++;
+            if (code == 0xFF) {
+                dst[code_index] = code;
+                code = 1;
+                code_index = write_index++;
+            }
+        }
+    }
+    dst[code_index] = code;
+    return write_index;
+}
+
+// COBS decode src into dst (dst needs length bytes)
+// Returns the decoded length, or 0 if the input is malformed.
+unsigned int cobs_decode(const unsigned char* src, unsigned int length, unsigned char* dst) {
+    unsigned int read_index = 0;
+    unsigned int write_index = 0;
+    unsigned char code;
+    unsigned char i;
+    
+    while (read_index < length) {
+        code = src[read_index];
+        if (code == 0 || read_index + code > length + 1) {
+            return 0;
+        }
+        read_index++;
+        for (i = 1; i < code; i++) {
+            dst[write_index++] = src[read_index++];
+        }
+        if (code != 0xFF && read_index < length) {
+            dst[write_index++] = 0;
+        }
+    }
+    return write_index;
+}
+
+// Decode and check a received frame (without delimiters) into frame[]
+// Returns the length of type + seq + payload, or 0 if the frame is bad.
+unsigned int tlm_decode_frame(const unsigned char* encoded, unsigned int length, unsigned char* frame) {
+    unsigned int n = cobs_decode(encoded, length, frame);
+    unsigned int crc;
+    
+    if (n < 4) {
+        return 0;
+    }
+    n -= 2;
+    crc = frame[n] | ((unsigned int)frame[n + 1] << 8);
+    if (crc16_ccitt(0xFFFF, frame, n) != crc) {
+        return 0;
+    }
+    return n;
+}
+
+// Build, encode and queue one frame. The frame is queued whole or
+// dropped whole so a full TX ring never produces a truncated frame.
+void tlm_send_frame(unsigned char type, const unsigned char* payload, unsigned char length) {
+    unsigned char raw[TLM_MAX_PAYLOAD + 4];
+    unsigned char encoded[TLM_MAX_PAYLOAD + 7];
+    unsigned int crc;
+    unsigned int n;
+    unsigned char i;
+    
+    if (length > TLM_MAX_PAYLOAD) {
+        return;
+    }
+    
+    raw[0] = type;
+    raw[1] = tlm_next_seq();
+    for (i = 0; i < length; i++) {
+        raw[2 + i] = payload[i];
+    }
+    crc = crc16_ccitt(0xFFFF, raw, length + 2);
+    raw[length + 2] = crc & 0xFF;
+    raw[length + 3] = crc >> 8;
+    
+    // Leading and trailing delimiters isolate the frame from other output
+    encoded[0] = 0x00;
+    n = cobs_encode(raw, length + 4, &encoded[1]) + 1;
+    encoded[n++] = 0x00;
+    
+    if (!UART1write(encoded, n)) {
+        tlm_dropped++;
+    }
+}
+
+// Send a large frame (header + data) without a frame buffer. COBS is
+// encoded on the fly by scanning ahead in the source, and bytes are
+// queued with UART1put() so nothing is dropped. Main loop context only.
+// The frame holds uart_exclusive while it is queued, so frames from the
+// detection ISR are dropped (tlm_dropped) instead of spliced into it.
+void tlm_send_frame_blocking(unsigned char type, const unsigned char* header, unsigned char header_length,
+                             const unsigned char* data, unsigned int data_length) {
+    unsigned char head[8];
+    unsigned char crc_bytes[2];
+    unsigned int head_length = header_length + 2;
+    unsigned int total;
+    unsigned int crc;
+    unsigned int i, j, k;
+    unsigned char c;
+    unsigned char exclusive = uart_exclusive;   // Set already during READ
+    
+    head[0] = type;
+    head[1] = tlm_next_seq();
+    for (i = 0; i < header_length && i < sizeof(head) - 2; i++) {
+        head[2 + i] = header[i];
+    }
+    crc = crc16_ccitt(0xFFFF, head, head_length);
+    crc = crc16_ccitt(crc, data, data_length);
+    crc_bytes[0] = crc & 0xFF;
+    crc_bytes[1] = crc >> 8;
+    total = head_length + data_length + 2;
+    
+    // Byte i of the unencoded frame: head, then data, then CRC
+    #define FRAME_BYTE(n) ((n) < head_length ? head[(n)] : \
+                           (n) < head_length + data_length ? data[(n) - head_length] : \
+                           crc_bytes[(n) - head_length - data_length])
+    
+    uart_exclusive = 1;
+    UART1put(0x00);
+    i = 0;
+    for (;;) {
+        // Find the run of non-zero bytes starting at i (max 254)
+        j = i;
+        while (j < total && FRAME_BYTE(j) != 0 && j - i < 254) {
+            j++;
+        }
+        UART1put((unsigned char)(j - i + 1));
+        for (k = i; k < j; k++) {
+            c = FRAME_BYTE(k);
+            UART1put(c);
+        }
+        if (j >= total) {
+            break;
+        }
+        i = (j - i == 254) ? j : j + 1;      // Full block has no implied zero
+    }
+    UART1put(0x00);
+    uart_exclusive = exclusive;
+    
+    #undef FRAME_BYTE
+}
+
+// Store BCD timestamp fields into a payload (7 bytes)
+static void put_timestamp(unsigned char* p, unsigned int year, unsigned char month,
+                          unsigned char day, unsigned char hour,
+                          unsigned char minute, unsigned char second) {
+    p[0] = year & 0xFF;
+    p[1] = year >> 8;
+    p[2] = month;
+    p[3] = day;
+    p[4] = hour;
+    p[5] = minute;
+    p[6] = second;
+}
+
+// Event payload: muon# (2), band (1), timestamp (7)
+void tlm_send_event(unsigned int muon_number, unsigned char band) {
+    unsigned char p[10];
+    
+    p[0] = muon_number & 0xFF;
+    p[1] = muon_number >> 8;
+    p[2] = band;
+    put_timestamp(&p[3], RTCYEAR, RTCMON, RTCDAY, RTCHOUR, RTCMIN, RTCSEC);
+    tlm_send_frame(TLM_TYPE_EVENT, p, sizeof(p));
+}
+
+// Housekeeping payload: timestamp (7), temperature (2, signed),
+// supply mV (2), dead ms (2), event count (2)
+void tlm_send_housekeeping(int temperature, unsigned int supply_mv,
+                           unsigned int dead_ms, unsigned int events) {
+    unsigned char p[15];
+    
+    put_timestamp(p, RTCYEAR, RTCMON, RTCDAY, RTCHOUR, RTCMIN, RTCSEC);
+    p[7]  = (unsigned int)temperature & 0xFF;
+    p[8]  = (unsigned int)temperature >> 8;
+    p[9]  = supply_mv & 0xFF;
+    p[10] = supply_mv >> 8;
+    p[11] = dead_ms & 0xFF;
+    p[12] = dead_ms >> 8;
+    p[13] = events & 0xFF;
+    p[14] = events >> 8;
+    tlm_send_frame(TLM_TYPE_HOUSEKEEPING, p, sizeof(p));
+}
+
+// Stats payload: muon count (2), current sector (4), staged readings (1),
+// SD initialized (1), UART bytes dropped (2), telemetry frames dropped (2)
+void tlm_send_stats(void) {
+    unsigned char p[12];
+    
+    p[0]  = muon_count & 0xFF;
+    p[1]  = muon_count >> 8;
+    p[2]  = current_sector & 0xFF;
+    p[3]  = (current_sector >> 8) & 0xFF;
+    p[4]  = (current_sector >> 16) & 0xFF;
+    p[5]  = (current_sector >> 24) & 0xFF;
+    p[6]  = (unsigned char)reading_count;
+    p[7]  = sd_initialized;
+    p[8]  = uart_tx_dropped & 0xFF;
+    p[9]  = uart_tx_dropped >> 8;
+    p[10] = tlm_dropped & 0xFF;
+    p[11] = tlm_dropped >> 8;
+    tlm_send_frame(TLM_TYPE_STATS, p, sizeof(p));
+}
+
+// Histogram payload: bin start timestamp (7), seconds (2), band 1-4
+// counts (2 each), coincidences (2), coincidences per multi-band mask
+// (2 each, in histogram.h order)
+void tlm_send_histogram(const HistBin* bin) {
+    unsigned char p[19 + 2 * HIST_COINC_MASKS];
+    unsigned int total = hist_coinc_total(bin);
+    unsigned char i;
+    
+    put_timestamp(p, bin->start.year, bin->start.month, bin->start.day,
+                  bin->start.hour, bin->start.minute, bin->start.second);
+    p[7] = bin->seconds & 0xFF;
+    p[8] = bin->seconds >> 8;
+    for (i = 0; i < 4; i++) {
+        p[9 + 2 * i] = bin->band[i] & 0xFF;
+        p[10 + 2 * i] = bin->band[i] >> 8;
+    }
+    p[17] = total & 0xFF;
+    p[18] = total >> 8;
+    for (i = 0; i < HIST_COINC_MASKS; i++) {
+        p[19 + 2 * i] = bin->coincidence[i] & 0xFF;
+        p[20 + 2 * i] = bin->coincidence[i] >> 8;
+    }
+    tlm_send_frame(TLM_TYPE_HISTOGRAM, p, sizeof(p));
+}
+
+#endif /* BOARD_HAS_UART */
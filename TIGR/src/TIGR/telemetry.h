@@ -0,0 +1,68 @@
+// telemetry.h
+// Binary live telemetry stream over the back channel UART
+//
+// Frame layout before encoding:
+//   [type][seq][payload ...][crc16 lo][crc16 hi]
+// CRC16-CCITT (poly 0x1021, init 0xFFFF) covers type, seq and payload.
+// The frame is COBS encoded and sent between 0x00 delimiters, so a
+// receiver can resynchronise on any zero byte and text output on the
+// same UART is rejected as a bad frame.
+// All multi-byte fields are little-endian; date/time fields are BCD.
+
+#ifndef _TIGR_TELEMETRY_H
+#define _TIGR_TELEMETRY_H
+
+#include "tigr_config.h"
+#include "histogram.h"
+
+// Frame types
+#define TLM_TYPE_EVENT          0x01   // One muon event
+#define TLM_TYPE_HOUSEKEEPING   0x02   // Housekeeping record
+#define TLM_TYPE_STATS          0x03   // Logger statistics
+#define TLM_TYPE_HISTOGRAM      0x04   // Histogram bin record (histogram.h)
+
+// Bulk readout (see readout.h): host -> MCU commands
+#define TLM_CMD_PING            0x10   // Echo request, any payload
+#define TLM_CMD_SET_BAUD        0x12   // Switch baud rate: baud (4)
+#define TLM_CMD_READ            0x14   // Read sectors: start (4), count (4), window (1)
+#define TLM_CMD_ACK             0x15   // Sectors received in order so far (4)
+#define TLM_CMD_ABORT           0x16   // Stop a running readout
+#define TLM_CMD_TRACE_DUMP      0x18   // Send the trace ring (trace.h)
+#define TLM_CMD_SET_FLUSH       0x1A   // Flush policy: high water (2), max age s (2), lookahead s (2); empty = query
+#define TLM_CMD_SET_BANDS       0x1C   // Band enables (1), prescales (4)[, holdoffs us (2 each)]; empty = query
+#define TLM_CMD_SET_LOG         0x1E   // Log ring policy (1, log_manager.h); empty = query
+#define TLM_CMD_FRAM_LOG        0x24   // Empty the FRAM log if it holds used bytes (4, fram_log.h); empty = query
+
+// Bulk readout: MCU -> host responses
+#define TLM_TYPE_PONG           0x11   // Echo of a PING payload
+#define TLM_TYPE_BAUD_ACK       0x13   // SET_BAUD accepted (1) or rejected (0)
+#define TLM_TYPE_SECTOR         0x20   // sector number (4), data (512)
+#define TLM_TYPE_READ_DONE      0x21   // status (1), sectors sent (4)
+#define TLM_TYPE_TRACE          0x22   // total recorded (2), entries (6 each)
+#define TLM_TYPE_FLUSH_POLICY   0x1B   // high water (2), max age s (2), lookahead s (2), event rate x16 (2)
+#define TLM_TYPE_BANDS          0x1D   // enables (1), prescales (4), counts since the last HK record (2 each),
+                                       // holdoffs us (2 each), retriggers since the last HK record (2 each)
+#define TLM_TYPE_LOG            0x1F   // policy (1), card state (1), capacity (4), head (4), tail (4),
+                                       // sessions (2), free sectors (4), hours left (2)
+#define TLM_TYPE_FRAM_LOG       0x25   // used (4), capacity (4), dropped (2), hours left (2), emptied (1)
+
+#define TLM_MAX_PAYLOAD         41     // Largest payload of any frame type (histogram)
+
+// Frames dropped because the UART TX ring could not hold them
+extern volatile unsigned int tlm_dropped;
+
+// Function prototypes
+unsigned int crc16_ccitt(unsigned int crc, const unsigned char* data, unsigned int length);
+unsigned int cobs_encode(const unsigned char* src, unsigned int length, unsigned char* dst);
+unsigned int cobs_decode(const unsigned char* src, unsigned int length, unsigned char* dst);
+unsigned int tlm_decode_frame(const unsigned char* encoded, unsigned int length, unsigned char* frame);
+void tlm_send_frame(unsigned char type, const unsigned char* payload, unsigned char length);
+void tlm_send_frame_blocking(unsigned char type, const unsigned char* header, unsigned char header_length,
+                             const unsigned char* data, unsigned int data_length);
+void tlm_send_event(unsigned int muon_number, unsigned char band);
+void tlm_send_housekeeping(int temperature, unsigned int supply_mv,
+                           unsigned int dead_ms, unsigned int events);
+void tlm_send_stats(void);
+void tlm_send_histogram(const HistBin* bin);
+
+#endif /* _TIGR_TELEMETRY_H */
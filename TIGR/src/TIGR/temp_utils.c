@@ -0,0 +1,282 @@
+// temp_utils.c
+// Temperature sensor implementation for TIGR project
+// Internal temperature sensor on the ADC of each board:
+//
+//              FR2355                 FR6989
+// ADC          ADC (ADCCTL0...)       ADC12 (ADC12CTL0...)
+// Temperature  A12                    A30
+// Reference    1.5V, PMMCTL2          1.2V, REFCTL0
+// Supply       1.5V ref on A13        AVCC/2 on A31
+
+#include "temp_utils.h"
+#include "tigr_hal.h"
+
+#if TIGR_BOARD == BOARD_FR2355
+
+// Temperature calibration addresses for FR2355 (from TLV)
+// These are for 1.5V reference at 30°C and 85°C
+#define CALADC_15V_30C  hal_tlv_word(0x1A1A)
+#define CALADC_15V_85C  hal_tlv_word(0x1A1C)
+
+// Initialize ADC for temperature sensing
+void adc_init(void) {
+    // Configure reference and temperature sensor via PMM
+    // Unlock PMM registers
+    PMMCTL0_H = PMMPW_H;
+    
+    // Enable internal reference (1.5V) and temperature sensor
+    PMMCTL2 |= INTREFEN | TSENSOREN;
+    
+    // Wait for reference to settle (minimum 400us)
+    __delay_cycles(8000);                      // ~1ms at 8MHz
+    
+    // Configure ADC
+    // ADCSHT_8 = 256 ADCCLK cycles sample time (temperature sensor needs >30us)
+    // ADCON = Turn on ADC
+    ADCCTL0 = ADCSHT_8 | ADCON;
+    
+    // ADCSHP = Use sampling timer (pulse mode)
+    // Default: ADCCONSEQ = 0 (single-channel single-conversion)
+    // Default: ADCSSEL = MODCLK
+    ADCCTL1 = ADCSHP;
+    
+    // Clear resolution bits and set to 12-bit
+    ADCCTL2 &= ~ADCRES;
+    ADCCTL2 |= ADCRES_2;                       // 12-bit resolution
+    
+    // Configure input channel
+    // ADCSREF_1 = VR+ = VREF, VR- = AVSS
+    // ADCINCH_12 = Channel A12 (internal temperature sensor on FR2355)
+    ADCMCTL0 = ADCSREF_1 | ADCINCH_12;
+    
+    // Disable ADC interrupt (we'll poll)
+    ADCIE = 0x0000;
+    
+    // Additional settling time
+    __delay_cycles(8000);
+}
+
+// Read temperature from internal sensor
+// Returns temperature in degrees Celsius
+int read_temperature(void) {
+    unsigned int adc_value;
+    long temp;
+    
+    // Ensure reference and temp sensor are enabled
+    // (in case they were disabled for power saving)
+    PMMCTL0_H = PMMPW_H;
+    if(!(PMMCTL2 & INTREFEN)) {
+        PMMCTL2 |= INTREFEN | TSENSOREN;
+        __delay_cycles(400);                   // Wait for reference to settle
+    }
+    
+    // Enable conversions
+    ADCCTL0 |= ADCENC;
+    
+    // Start conversion
+    ADCCTL0 |= ADCSC;
+    
+    // Wait for conversion to complete
+    while(ADCCTL1 & ADCBUSY);
+    
+    // Read result
+    adc_value = ADCMEM0;
+    
+    // Disable conversions
+    ADCCTL0 &= ~ADCENC;
+    
+    // Get calibration values from TLV
+    // These are factory-calibrated values for 30°C and 85°C at 1.5V reference
+    unsigned int cal_30 = CALADC_15V_30C;
+    unsigned int cal_85 = CALADC_15V_85C;
+    
+    // Verify calibration data is valid (not erased flash = 0xFFFF)
+    if (cal_30 == 0xFFFF || cal_85 == 0xFFFF || cal_85 == cal_30) {
+        // No valid calibration data, return error value
+        return -273;  // Absolute zero as error indicator
+    }
+    
+    // Calculate temperature using two-point calibration
+    // Temp = ((ADC - CAL30) * (85 - 30)) / (CAL85 - CAL30) + 30
+    temp = (long)adc_value - (long)cal_30;
+    temp = temp * 55;  // (85 - 30)
+    temp = temp / ((long)cal_85 - (long)cal_30);
+    temp = temp + 30;
+    
+    return (int)temp;
+}
+
+// Read supply voltage (AVCC) in millivolts
+// FR2355 has no AVCC/2 divider channel, so the internal 1.5V reference
+// (channel A13) is converted against AVCC and the supply is back-calculated:
+// AVCC = 1.5V * 4096 / ADC
+unsigned int read_supply_voltage(void) {
+    unsigned int adc_value;
+    
+    // Ensure reference is enabled
+    PMMCTL0_H = PMMPW_H;
+    if(!(PMMCTL2 & INTREFEN)) {
+        PMMCTL2 |= INTREFEN | TSENSOREN;
+        __delay_cycles(400);                   // Wait for reference to settle
+    }
+    
+    // VR+ = AVCC, VR- = AVSS, Channel A13 (internal 1.5V reference)
+    ADCMCTL0 = ADCSREF_0 | ADCINCH_13;
+    
+    ADCCTL0 |= ADCENC | ADCSC;
+    while(ADCCTL1 & ADCBUSY);
+    adc_value = ADCMEM0;
+    ADCCTL0 &= ~ADCENC;
+    
+    // Restore temperature sensor channel
+    ADCMCTL0 = ADCSREF_1 | ADCINCH_12;
+    
+    if (adc_value == 0) {
+        return 0;
+    }
+    return (unsigned int)((1500UL * 4096UL) / adc_value);
+}
+
+// Optional: Power down temperature sensor and reference to save power
+void adc_power_down(void) {
+    // Disable ADC
+    ADCCTL0 &= ~(ADCENC | ADCON);
+    
+    // Disable reference and temperature sensor
+    PMMCTL0_H = PMMPW_H;
+    PMMCTL2 &= ~(INTREFEN | TSENSOREN);
+}
+
+// Optional: Read raw ADC value (for debugging)
+unsigned int read_raw_adc(void) {
+    // Ensure reference and temp sensor are enabled
+    PMMCTL0_H = PMMPW_H;
+    if(!(PMMCTL2 & INTREFEN)) {
+        PMMCTL2 |= INTREFEN | TSENSOREN;
+        __delay_cycles(400);
+    }
+    
+    // Enable and start conversion
+    ADCCTL0 |= ADCENC | ADCSC;
+    
+    // Wait for conversion
+    while(ADCCTL1 & ADCBUSY);
+    
+    // Read and return result
+    unsigned int result = ADCMEM0;
+    
+    // Disable conversions
+    ADCCTL0 &= ~ADCENC;
+    
+    return result;
+}
+
+#else
+
+// Initialize ADC for temperature sensing
+void adc_init(void) {
+    // Configure REF module first
+    while(REFCTL0 & REFGENBUSY);               // Wait if reference generator is busy
+    REFCTL0 = REFVSEL_0 | REFON;               // Enable internal 1.2V reference
+    
+    // Wait for reference to settle (minimum 75us at 1MHz = 75 cycles)
+    __delay_cycles(8000);
+    
+    // Configure ADC12 - Use longest sampling time for temp sensor
+    ADC12CTL0 = ADC12SHT0_15 | ADC12ON;        // 512 ADC12CLK cycles sampling, ADC12 on
+    ADC12CTL1 = ADC12SHP;                      // Use sampling timer, MODCLK source
+    ADC12CTL2 = ADC12RES_2;                    // 12-bit resolution
+    ADC12CTL3 = ADC12TCMAP | ADC12BATMAP;      // Enable internal temperature sensor and AVCC/2 divider
+    ADC12MCTL0 = ADC12VRSEL_1 | ADC12INCH_30;  // VR+ = VREF, VR- = AVSS, Channel A30 (temp sensor)
+    ADC12MCTL1 = ADC12VRSEL_1 | ADC12INCH_31;  // VR+ = VREF, VR- = AVSS, Channel A31 (AVCC/2)
+    ADC12IER0 = 0x0000;                        // Disable interrupts
+    
+    // Additional settling time for temperature sensor
+    __delay_cycles(8000);
+}
+
+// Read temperature from internal sensor
+int read_temperature(void) {
+    unsigned int adc_value;
+    long temp;
+    
+    // Wait for reference to be ready
+    while(!(REFCTL0 & REFGENRDY));
+    
+    // Enable conversions
+    ADC12CTL0 |= ADC12ENC;
+    
+    // Start conversion
+    ADC12CTL0 |= ADC12SC;
+    
+    // Wait for conversion to complete
+    while (ADC12CTL1 & ADC12BUSY);
+    
+    // Read result
+    adc_value = ADC12MEM0;
+    
+    // Disable conversions
+    ADC12CTL0 &= ~ADC12ENC;
+    
+    // Get calibration values from TLV for FR6989
+    // These are factory-calibrated values for 30°C and 85°C at 1.2V ref
+    unsigned int cal_30 = hal_tlv_word(0x1A1A);   // CAL_ADC_12T30
+    unsigned int cal_85 = hal_tlv_word(0x1A1C);   // CAL_ADC_12T85
+    
+    // Verify calibration data is valid (not erased flash = 0xFFFF)
+    if (cal_30 == 0xFFFF || cal_85 == 0xFFFF || cal_85 == cal_30) {
+        // No valid calibration data, return error value
+        return -273;  // Absolute zero as error indicator
+    }
+    
+    // Calculate temperature using calibration
+    // Temp = ((ADC - CAL30) * (85 - 30)) / (CAL85 - CAL30) + 30
+    temp = (long)adc_value - (long)cal_30;
+    temp = temp * 55;  // (85 - 30)
+    temp = temp / ((long)cal_85 - (long)cal_30);
+    temp = temp + 30;
+    
+    return (int)temp;
+}
+
+// Read supply voltage (AVCC) in millivolts
+// Converts the internal AVCC/2 divider (A31) against the 2.0V reference,
+// then restores the 1.2V reference used by the temperature calibration.
+// AVCC = 2 * ADC * 2000mV / 4096 = ADC * 125 / 128
+unsigned int read_supply_voltage(void) {
+    unsigned int adc_value;
+    
+    // Switch reference to 2.0V (AVCC/2 exceeds 1.2V on a 3V supply)
+    while(REFCTL0 & REFGENBUSY);
+    REFCTL0 = REFVSEL_1 | REFON;
+    while(!(REFCTL0 & REFGENRDY));
+    
+    // Convert ADC12MEM1 (A31) in single-channel mode
+    ADC12CTL3 = (ADC12CTL3 & ~ADC12CSTARTADD_31) | ADC12CSTARTADD_1;
+    ADC12CTL0 |= ADC12ENC | ADC12SC;
+    while (ADC12CTL1 & ADC12BUSY);
+    adc_value = ADC12MEM1;
+    ADC12CTL0 &= ~ADC12ENC;
+    ADC12CTL3 &= ~ADC12CSTARTADD_31;
+    
+    // Restore 1.2V reference for the temperature sensor
+    while(REFCTL0 & REFGENBUSY);
+    REFCTL0 = REFVSEL_0 | REFON;
+    
+    return (unsigned int)(((unsigned long)adc_value * 125UL) >> 7);
+}
+
+// Optional: Read raw ADC value (for debugging)
+unsigned int read_raw_adc(void) {
+    unsigned int result;
+    
+    while(!(REFCTL0 & REFGENRDY));             // Wait for reference
+    ADC12CTL0 |= ADC12ENC | ADC12SC;
+    while (ADC12CTL1 & ADC12BUSY);
+    result = ADC12MEM0;
+    ADC12CTL0 &= ~ADC12ENC;
+    
+    return result;
+}
+
+#endif
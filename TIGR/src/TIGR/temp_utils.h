@@ -1,16 +1,20 @@
 // temp_utils.h
 // Temperature sensor interface for TIGR project
-// Adapted for MSP430FR2355 internal temperature sensor
+// Uses the MSP430 internal temperature sensor (FR2355 or FR6989)
 
 #ifndef _TIGR_TEMP_H
 #define _TIGR_TEMP_H
 
 #include <msp430.h>
+#include "board.h"
 
 // Function prototypes
 void adc_init(void);
 int read_temperature(void);
-void adc_power_down(void);
+unsigned int read_supply_voltage(void);
 unsigned int read_raw_adc(void);
+#if TIGR_BOARD == BOARD_FR2355
+void adc_power_down(void);
+#endif
 
 #endif /* _TIGR_TEMP_H */
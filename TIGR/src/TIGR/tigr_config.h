@@ -0,0 +1,135 @@
+// tigr_config.h
+// Common configuration and definitions for TIGR project
+
+#ifndef _TIGR_CONFIG_H
+#define _TIGR_CONFIG_H
+
+#include <msp430.h>
+#include "board.h"
+
+// Calendar time, BCD fields as read from the RTC
+typedef struct {
+    unsigned int year;           // Year
+    unsigned char month;         // Month (1-12)
+    unsigned char day;           // Day (1-31)
+    unsigned char hour;          // Hour (0-23)
+    unsigned char minute;        // Minute (0-59)
+    unsigned char second;        // Second (0-59)
+} RtcTime;
+
+// Staged detection, packed to 4 bytes (a fully timestamped reading took 12).
+// The muon number and time are kept once per batch in stage_anchor: each
+// staged event is the muon after the previous one plus those prescaled
+// away in between (prescale.h), detected second_offset seconds after
+// stage_anchor.time.
+typedef struct {
+    unsigned int tick_delta;     // Ticks since the previous event, TICK_DELTA_LONG if 15 s or more
+    unsigned char band_mask;     // Bit n-1 set for band n; high nibble: events prescaled away before it
+    unsigned char second_offset; // Seconds after the batch anchor
+} StagedEvent;
+
+typedef struct {
+    unsigned int muon_number;    // Muon number of the first staged event
+    unsigned int uptime;         // uptime_s at the first staged event
+    RtcTime time;                // RTC at the first staged event
+} StageAnchor;
+
+#define TICK_DELTA_LONG   0xFFFF
+#define STAGE_MAX_OFFSET  255     // Largest second_offset; a later event starts a new batch
+#define STAGE_SKIP_SHIFT  4       // band_mask >> STAGE_SKIP_SHIFT = skipped muon numbers
+#define STAGE_MAX_SKIP    15      // More skipped than this starts a new batch
+
+// P2 inputs of the four energy bands
+#define BAND_FLAGS (BIT1 | BIT2 | BIT3 | BIT4)
+
+// Configuration Constants
+#ifndef MAX_READINGS
+#define MAX_READINGS 48           // Events staged before SD write (192 bytes)
+#endif
+#define SD_BUFFER_SIZE 512       // SD card sector size
+#define HK_INTERVAL_S 60         // Seconds between housekeeping records
+
+// Identification for the session header sector (sd_utils.h), with
+// TIGR_BOARD (board.h). Give each unit its own id with -DDETECTOR_ID=n.
+#define TIGR_FW_VERSION     0x0204   // Major << 8 | minor
+#ifndef DETECTOR_ID
+#define DETECTOR_ID         0
+#endif
+
+// Trace level (see trace.h), override with -DTRACE_LEVEL=n
+#ifndef TRACE_LEVEL
+#if TIGR_BOARD == BOARD_FR2355
+#define TRACE_LEVEL 0            // Flight: trace points compile out
+#else
+#define TRACE_LEVEL 2            // Development board: trace everything
+#endif
+#endif
+
+// Live telemetry event frame per detection (telemetry.h). Override with
+// -DTLM_EVENTS=0 to keep the UART out of the detection ISR.
+#ifndef TLM_EVENTS
+#define TLM_EVENTS 1
+#endif
+
+// Log to FRAM only, the SD card is never used (fram_log.h). Override with
+// -DLOG_FRAM=1 for flights where a card is the bigger risk. The log sits
+// above 64 KB, so such a build also needs the large data model:
+// --data_model=large with cl430 (TIGR/Makefile picks it), -mlarge with
+// msp430-elf-gcc.
+#ifndef LOG_FRAM
+#define LOG_FRAM 0
+#endif
+
+// Both need the back channel: the FR2355 has none, and its FRAM has no
+// room for the log region besides
+#if !BOARD_HAS_UART
+#undef TLM_EVENTS
+#define TLM_EVENTS 0
+#undef LOG_FRAM
+#define LOG_FRAM 0
+#endif
+
+// Free-running tick counter (TICK_NOW(), board.h) at ACLK/8 used to
+// measure time spent inside the detection ISR (dead time)
+#define TICK_HZ 4096
+
+// Global Variables (extern declarations)
+extern StagedEvent readings[MAX_READINGS];
+extern StageAnchor stage_anchor;
+extern volatile unsigned int reading_count;
+extern volatile unsigned int muon_count;
+extern unsigned char sd_buffer[SD_BUFFER_SIZE];
+extern volatile unsigned char sd_initialized;
+extern unsigned long current_sector;
+extern unsigned long sector_seq;          // Sequence number of the next log sector
+extern unsigned int buffer_position;
+
+// Housekeeping state
+extern volatile unsigned char hk_due;       // Set by RTC tick when a record is due
+extern volatile unsigned int uptime_s;     // Seconds since boot, advanced with the RTC
+extern volatile unsigned long dead_ticks;   // Ticks spent in ISRP2 since last record
+
+// SD writer pause (UART readout or card initialization in progress)
+extern volatile unsigned char sd_paused;
+extern volatile unsigned int events_dropped;
+
+#if !BOARD_HAS_RTC_C
+// Software RTC (TIGR.c) in place of RTC_C. The macros let the rest of the
+// firmware read it by the RTC_C register names.
+extern volatile unsigned int rtc_year;      // Year (e.g., 2025)
+extern volatile unsigned char rtc_month;    // Month (1-12)
+extern volatile unsigned char rtc_day;      // Day (1-31)
+extern volatile unsigned char rtc_hour;     // Hour (0-23)
+extern volatile unsigned char rtc_minute;   // Minute (0-59)
+extern volatile unsigned char rtc_second;   // Second (0-59)
+extern volatile unsigned int rtc_ms;        // Milliseconds counter (0-999)
+
+#define RTCYEAR   rtc_year
+#define RTCMON    rtc_month
+#define RTCDAY    rtc_day
+#define RTCHOUR   rtc_hour
+#define RTCMIN    rtc_minute
+#define RTCSEC    rtc_second
+#endif
+
+#endif /* _TIGR_CONFIG_H */
@@ -0,0 +1,38 @@
+// tigr_hal.h
+// Hardware access points for TIGR project
+//
+// The few places where the firmware touches hardware in ways a register
+// model cannot follow (SPI byte exchange, TLV calibration reads, the P2IV
+// read that clears the flag it returns) go through
+// these macros. On the target they compile to the same code as before;
+// with -DTIGR_SIM the host simulator (TIGR/sim) supplies them instead, and
+// with -DTIGR_PROFILE the cycle-profiling harness (TIGR/sim/isa).
+
+#ifndef _TIGR_HAL_H
+#define _TIGR_HAL_H
+
+#include <msp430.h>
+
+#if defined(TIGR_SIM)
+#include "sim_hal.h"
+#elif defined(TIGR_PROFILE)
+#include "profile_hal.h"
+#else
+
+// Exchange one byte on eUSCI_B0 SPI
+static inline unsigned char hal_spi_xfer(unsigned char data) {
+    while (!(UCB0IFG & UCTXIFG));              // Wait for TX buffer ready
+    UCB0TXBUF = data;                          // Send byte
+    while (!(UCB0IFG & UCRXIFG));              // Wait for RX complete
+    return UCB0RXBUF;                          // Return received byte
+}
+
+// Read a 16-bit word from the TLV (device descriptor) area
+#define hal_tlv_word(address)   (*((const unsigned int *)(address)))
+
+// Highest priority pending PORT2 interrupt; clears that flag
+#define hal_port2_iv()          P2IV
+
+#endif /* TIGR_SIM, TIGR_PROFILE */
+
+#endif /* _TIGR_HAL_H */
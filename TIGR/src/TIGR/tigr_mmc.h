@@ -1,34 +1,29 @@
 // tigr_mmc.h
 // MMC/SD Card Interface Header for TIGR Project
-// MSP430FR6989 Implementation
+// MSP430FR2355 and MSP430FR6989
 
 #ifndef _TIGR_MMC_H
 #define _TIGR_MMC_H
 
 #include <msp430.h>
+#include "board.h"
 
 ///-----------------------------------------------------------------------------
-// Pin Definitions for MSP430FR6989 (Updated)
+// Pin Definitions (board.h)
 //-----------------------------------------------------------------------------
 // Using eUSCI_B0 for SPI:
-// P1.4 = SCLK
-// P1.6 = MOSI (SIMO)
-// P1.7 = MISO (SOMI)
-// P1.3 = CS (Chip Select) - GPIO
-// P1.5 = Card Detect - GPIO (optional)
-
-#define SD_CS_OUT       P1OUT
-#define SD_CS_DIR       P1DIR
-#define SD_CS_PIN       BIT3
-
-#define SD_CD_IN        P1IN
-#define SD_CD_DIR       P1DIR
-#define SD_CD_PIN       BIT5
+//               FR2355   FR6989
+// SCLK           P1.1     P1.4
+// MOSI (SIMO)    P1.2     P1.6
+// MISO (SOMI)    P1.3     P1.7
+// CS             P1.0     P1.3   Chip Select - GPIO
+// Card Detect    P3.7     P1.5   GPIO, low with a card inserted; interrupts
+//                                on both edges (see mmc_detect_arm())
 
 // Chip Select Macros
 #define CS_HIGH()       SD_CS_OUT |= SD_CS_PIN
 #define CS_LOW()        SD_CS_OUT &= ~SD_CS_PIN
-#define CARD_PRESENT()  ((SD_CD_IN & SD_CD_PIN))
+#define CARD_PRESENT()  (!(SD_CD_IN & SD_CD_PIN))   // Switch closes to ground
 
 //-----------------------------------------------------------------------------
 // MMC/SD Commands (SPI Mode)
@@ -87,6 +82,8 @@
 #define MMC_BLOCK_SIZE        512    // Standard SD card block size
 #define MMC_INIT_TIMEOUT      1000   // Initialization timeout loops
 #define MMC_RESPONSE_TIMEOUT  64     // Response timeout loops
+#define MMC_BUSY_TIMEOUT_MS   500    // Write busy limit (SD spec: 250 ms SDSC, 500 ms SDHC)
+#define SD_SPI_MAX_HZ         8000000UL  // Fastest SPI bit clock used
 
 //-----------------------------------------------------------------------------
 // Function Prototypes
@@ -94,6 +91,7 @@
 
 // SPI Functions
 void spi_init(void);
+void spi_set_clock(unsigned char point);
 unsigned char spi_send_byte(unsigned char data);
 void spi_send_frame(unsigned char* buffer, unsigned int length);
 void spi_read_frame(unsigned char* buffer, unsigned int length);
@@ -111,14 +109,22 @@ unsigned char mmc_set_block_length(unsigned long length);
 unsigned char mmc_read_block(unsigned long address, unsigned char *buffer);
 unsigned char mmc_write_block(unsigned long address, unsigned char *buffer);
 
+// Multi-block read (CMD18): begin, read N blocks with next(), then end
+unsigned char mmc_read_multiple_begin(unsigned long address);
+unsigned char mmc_read_multiple_next(unsigned char *buffer);
+unsigned char mmc_read_multiple_end(void);
+
 // Utility Functions
 unsigned char mmc_read_register(unsigned char cmd_register, unsigned char length, unsigned char *buffer);
-unsigned long mmc_read_card_size(void);
+unsigned long mmc_read_card_size(void);  // Capacity in sectors, 0 on error
 unsigned char mmc_ping(void);  // Check if card is present
+unsigned char mmc_detect_arm(void);  // Interrupt on the next card-detect change
 
 // Sector-based Operations (512 bytes per sector)
-#define mmc_read_sector(sector, buffer)  mmc_read_block((sector)*512UL, buffer)
-#define mmc_write_sector(sector, buffer) mmc_write_block((sector)*512UL, buffer)
+unsigned long mmc_sector_address(unsigned long sector);  // Byte or block address per card type
+unsigned char mmc_read_sector_head(unsigned long sector, unsigned char *buffer, unsigned int length);
+#define mmc_read_sector(sector, buffer)  mmc_read_block(mmc_sector_address(sector), buffer)
+#define mmc_write_sector(sector, buffer) mmc_write_block(mmc_sector_address(sector), buffer)
 
 //-----------------------------------------------------------------------------
 // Data Structure for Card Information
@@ -0,0 +1,147 @@
+// tigr_utils.c
+// Utility functions implementation for TIGR project
+// Mainly for UART communication
+//
+// Decimal conversion subtracts powers of ten instead of dividing: the
+// MSP430 has no divider, and each % 10 / 10 pair is a library call.
+
+#include "tigr_utils.h"
+
+static const unsigned int powers_of_ten[4] = { 10000, 1000, 100, 10 };
+
+// Write num as exactly five digits ("00042") at dst
+char* put_uint5(char* dst, unsigned int num) {
+    unsigned int i;
+    char digit;
+    
+    for (i = 0; i < 4; i++) {
+        digit = '0';
+        while (num >= powers_of_ten[i]) {
+            num -= powers_of_ten[i];
+            digit++;
+        }
+        *dst++ = digit;
+    }
+    *dst++ = '0' + num;
+    return dst;
+}
+
+// Helper function to convert unsigned int to string
+void uint_to_string(unsigned int num, char* str) {
+    char digits[5];
+    char* p = digits;
+    
+    put_uint5(digits, num);
+    
+    // Drop leading zeros, keeping at least one digit
+    while (p < &digits[4] && *p == '0') {
+        p++;
+    }
+    while (p < &digits[5]) {
+        *str++ = *p++;
+    }
+    *str = '\0';
+}
+
+// Helper function to convert signed int to string (for temperature)
+void int_to_string(int num, char* str) {
+    if (num < 0) {
+        *str++ = '-';
+        uint_to_string(0U - (unsigned int)num, str);
+    } else {
+        uint_to_string((unsigned int)num, str);
+    }
+}
+
+// Helper to convert 2-digit BCD to string
+void bcd_to_string(unsigned char bcd, char* str) {
+    *put_bcd2(str, bcd) = '\0';
+}
+
+// Helper to convert 4-digit hex to string (for year)
+void hex_to_string_4(unsigned int hex, char* str) {
+    *put_bcd4(str, hex) = '\0';
+}
+
+// Days in each month (index 0 unused, 1=Jan, etc.)
+static const unsigned char days_in_month[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+// Helper function to check if year is leap year (BCD format)
+static unsigned char is_leap_year(unsigned int year_bcd) {
+    // Convert BCD to decimal
+    unsigned int year = ((year_bcd >> 12) & 0xF) * 1000 +
+                        ((year_bcd >> 8) & 0xF) * 100 +
+                        ((year_bcd >> 4) & 0xF) * 10 +
+                        (year_bcd & 0xF);
+    return ((year % 4 == 0) && (year % 100 != 0)) || (year % 400 == 0);
+}
+
+// Helper to get max days in current month (BCD values)
+unsigned char get_max_days(unsigned char month_bcd, unsigned int year_bcd) {
+    unsigned char month = ((month_bcd >> 4) & 0xF) * 10 + (month_bcd & 0xF);
+    if (month == 2 && is_leap_year(year_bcd)) {
+        return 29;
+    }
+    if (month >= 1 && month <= 12) {
+        return days_in_month[month];
+    }
+    return 31;
+}
+
+// Increment BCD value with rollover
+unsigned char bcd_increment(unsigned char bcd, unsigned char max_val) {
+    unsigned char low = bcd & 0x0F;
+    unsigned char high = (bcd >> 4) & 0x0F;
+    
+    low++;
+    if (low > 9) {
+        low = 0;
+        high++;
+    }
+    
+    unsigned char result = (high << 4) | low;
+    unsigned char decimal = high * 10 + low;
+    
+    if (decimal > max_val) {
+        return (max_val == 59 || max_val == 23) ? 0x00 : 0x01;
+    }
+    return result;
+}
+
+// Increment BCD year
+unsigned int bcd_year_increment(unsigned int year_bcd) {
+    unsigned int y = ((year_bcd >> 12) & 0xF) * 1000 +
+                     ((year_bcd >> 8) & 0xF) * 100 +
+                     ((year_bcd >> 4) & 0xF) * 10 +
+                     (year_bcd & 0xF);
+    y++;
+    return ((y / 1000) << 12) | (((y / 100) % 10) << 8) | 
+           (((y / 10) % 10) << 4) | (y % 10);
+}
+
+// Advance a BCD calendar time with the same rollover as the RTC. Costs a
+// few cycles per second unless a minute boundary is crossed.
+void rtc_time_add_seconds(RtcTime* time, unsigned int seconds) {
+    while (seconds--) {
+        time->second = bcd_increment(time->second, 59);
+        if (time->second != 0x00) {
+            continue;
+        }
+        time->minute = bcd_increment(time->minute, 59);
+        if (time->minute != 0x00) {
+            continue;
+        }
+        time->hour = bcd_increment(time->hour, 23);
+        if (time->hour != 0x00) {
+            continue;
+        }
+        time->day = bcd_increment(time->day, get_max_days(time->month, time->year));
+        if (time->day != 0x01) {
+            continue;
+        }
+        time->month = bcd_increment(time->month, 12);
+        if (time->month == 0x01) {
+            time->year = bcd_year_increment(time->year);
+        }
+    }
+}
@@ -0,0 +1,40 @@
+// tigr_utils.h
+// Utility functions for TIGR project
+// String conversion and helper functions
+
+#ifndef _TIGR_UTILS_H
+#define _TIGR_UTILS_H
+
+#include "tigr_config.h"
+
+// String conversion functions
+void uint_to_string(unsigned int num, char* str);
+void int_to_string(int num, char* str);
+void bcd_to_string(unsigned char bcd, char* str);
+void hex_to_string_4(unsigned int hex, char* str);
+
+// Fixed-width field writers for formatting in place. Each writes its
+// digits at dst without a terminator and returns the next free position.
+char* put_uint5(char* dst, unsigned int num);   // "00000" to "65535"
+
+// Two BCD digits, nibbles straight to ASCII
+static inline char* put_bcd2(char* dst, unsigned char bcd) {
+    dst[0] = '0' + (bcd >> 4);
+    dst[1] = '0' + (bcd & 0x0F);
+    return dst + 2;
+}
+
+// Four BCD digits (year)
+static inline char* put_bcd4(char* dst, unsigned int bcd) {
+    dst = put_bcd2(dst, (unsigned char)(bcd >> 8));
+    return put_bcd2(dst, (unsigned char)bcd);
+}
+
+// BCD calendar arithmetic, shared by the FR2355 software RTC and the
+// staging formatter (which rebuilds event times from a batch anchor)
+unsigned char get_max_days(unsigned char month_bcd, unsigned int year_bcd);
+unsigned char bcd_increment(unsigned char bcd, unsigned char max_val);
+unsigned int bcd_year_increment(unsigned int year_bcd);
+void rtc_time_add_seconds(RtcTime* time, unsigned int seconds);
+
+#endif /* _TIGR_UTILS_H */
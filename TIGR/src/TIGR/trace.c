@@ -0,0 +1,49 @@
+// trace.c
+// Compile-time trace facility for TIGR project
+
+#include <string.h>
+#include "trace.h"
+
+#if TRACE_LEVEL > TRACE_LEVEL_FLIGHT
+
+TraceEntry trace_ring[TRACE_RING_SIZE];
+unsigned int trace_head = 0;
+unsigned int trace_total = 0;
+
+// Record one trace entry (safe from ISRs and the main loop)
+void trace_record(unsigned int id, unsigned int arg) {
+    unsigned short state = __get_interrupt_state();
+    TraceEntry* entry;
+    
+    __disable_interrupt();
+    entry = &trace_ring[trace_head];
+    entry->id = id;
+    entry->tick = TICK_NOW();
+    entry->arg = arg;
+    trace_head = (trace_head + 1) % TRACE_RING_SIZE;
+    trace_total++;
+    __set_interrupt_state(state);
+}
+
+// Copy the ring into out (TRACE_RING_SIZE entries), oldest first
+// Returns the number of valid entries
+unsigned int trace_snapshot(TraceEntry* out) {
+    unsigned short state = __get_interrupt_state();
+    unsigned int count;
+    unsigned int first;
+    
+    __disable_interrupt();
+    count = (trace_total < TRACE_RING_SIZE) ? trace_total : TRACE_RING_SIZE;
+    first = (trace_head + TRACE_RING_SIZE - count) % TRACE_RING_SIZE;
+    if (first + count <= TRACE_RING_SIZE) {
+        memcpy(out, &trace_ring[first], count * sizeof(TraceEntry));
+    } else {
+        memcpy(out, &trace_ring[first], (TRACE_RING_SIZE - first) * sizeof(TraceEntry));
+        memcpy(&out[TRACE_RING_SIZE - first], trace_ring,
+               (count - (TRACE_RING_SIZE - first)) * sizeof(TraceEntry));
+    }
+    __set_interrupt_state(state);
+    return count;
+}
+
+#endif
@@ -0,0 +1,85 @@
+// trace.h
+// Compile-time trace facility for TIGR project
+//
+// Trace points record a 4-byte header (trace ID, TICK_NOW timestamp) plus a
+// 16-bit argument into a RAM ring. The oldest entries are overwritten.
+// The ring is dumped over UART on a TRACE_DUMP command (see readout.h) on
+// the FR6989, and read with the debugger (trace_ring, trace_head,
+// trace_total) on the FR2355.
+//
+// TRACE_LEVEL selects what is compiled in:
+//   TRACE_LEVEL_FLIGHT   nothing - trace points compile to no code
+//   TRACE_LEVEL_EVENT    sector writes, housekeeping, errors
+//   TRACE_LEVEL_VERBOSE  also every detection (ISR hot path)
+// Set it in tigr_config.h or with -DTRACE_LEVEL=n.
+
+#ifndef _TIGR_TRACE_H
+#define _TIGR_TRACE_H
+
+#include "tigr_config.h"
+
+#define TRACE_LEVEL_FLIGHT   0
+#define TRACE_LEVEL_EVENT    1
+#define TRACE_LEVEL_VERBOSE  2
+
+#define TRACE_RING_SIZE      32       // Entries (6 bytes each)
+
+// Trace IDs: high byte = module, low byte = event
+// Keep in sync with TRACE_NAMES in TIGRAnalyzer/tigr_telemetry.py
+#define TR_MUON              0x0101   // arg: P2IFG
+#define TR_READING_SAVED     0x0102   // arg: muon number
+#define TR_STAGING_FULL      0x0103   // arg: staged readings
+#define TR_EVENT_DROPPED     0x0104   // arg: events dropped so far
+#define TR_LOG_MODE          0x0105   // arg: new log mode (histogram.h)
+#define TR_RETRIGGER         0x0106   // arg: band whose holdoff window saw an edge
+#define TR_SD_FLUSH          0x0201   // arg: sector header used field (reason, bytes)
+#define TR_SD_WRITE_OK       0x0202   // arg: sector (low 16 bits)
+#define TR_SD_WRITE_FAIL     0x0203   // arg: sector (low 16 bits)
+#define TR_SD_NO_CARD        0x0204   // arg: bytes discarded
+#define TR_FLUSH_DEFERRED    0x0205   // arg: age of unwritten data (s)
+#define TR_SD_STATE          0x0206   // arg: new card state (sd_utils.h)
+#define TR_SD_HELD           0x0207   // arg: sectors now held without a card
+#define TR_LOG_OPEN          0x0208   // arg: sessions on the card (log_manager.h)
+#define TR_LOG_DROP          0x0209   // arg: sessions left after the tail moved
+#define TR_SD_RESCUED        0x020A   // arg: partial sector bytes committed to FRAM
+#define TR_SD_RESTORED       0x020B   // arg: held sectors after taking back a commit
+#define TR_FRAM_FULL         0x020C   // arg: FRAM log bytes used when the first record was dropped
+#define TR_HOUSEKEEPING      0x0301   // arg: muon count
+#define TR_SUPPLY_MV         0x0302   // arg: supply voltage (mV)
+#define TR_HIST_BIN          0x0303   // arg: detections in the bin
+#define TR_BAND_CONFIG       0x0304   // arg: band enables << 8 | band 1 prescale
+#define TR_SUPPLY_LOW        0x0305   // arg: supply voltage (mV)
+#define TR_SUPPLY_OK         0x0306   // arg: supply voltage (mV)
+#define TR_RESET             0x0307   // arg: reset cause (SYSRSTIV)
+#define TR_READOUT_START     0x0401   // arg: sectors requested (low 16 bits)
+#define TR_READOUT_DONE      0x0402   // arg: status
+
+typedef struct {
+    unsigned int id;             // Trace ID
+    unsigned int tick;           // TICK_NOW() when recorded
+    unsigned int arg;            // Trace point argument
+} TraceEntry;
+
+#if TRACE_LEVEL >= TRACE_LEVEL_EVENT
+#define TRACE_EVENT(id, arg)     trace_record((id), (unsigned int)(arg))
+#else
+#define TRACE_EVENT(id, arg)     ((void)0)
+#endif
+
+#if TRACE_LEVEL >= TRACE_LEVEL_VERBOSE
+#define TRACE_VERBOSE(id, arg)   trace_record((id), (unsigned int)(arg))
+#else
+#define TRACE_VERBOSE(id, arg)   ((void)0)
+#endif
+
+#if TRACE_LEVEL > TRACE_LEVEL_FLIGHT
+extern TraceEntry trace_ring[TRACE_RING_SIZE];
+extern unsigned int trace_head;             // Next slot to write
+extern unsigned int trace_total;            // Entries recorded (wraps)
+
+// Function prototypes
+void trace_record(unsigned int id, unsigned int arg);
+unsigned int trace_snapshot(TraceEntry* out);
+#endif
+
+#endif /* _TIGR_TRACE_H */
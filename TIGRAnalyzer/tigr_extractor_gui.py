@@ -11,6 +11,397 @@ import sys
 import os
 import webbrowser
 import ctypes
+import struct
+from datetime import datetime, timedelta
+
+SECTOR_SIZE = 512
+DEFAULT_SECTORS = 1000
+SERIAL_PREFIX = "serial:"
+IMAGE_PREFIX = "image:"
+
+# Log sector header: magic, sequence number, used (sd_utils.h). The low
+# bits of used are the payload bytes, the top four the flush reason.
+SECTOR_MAGIC = b"TG"
+SECTOR_HEADER = struct.Struct('<2sIH')
+SECTOR_PAYLOAD = SECTOR_SIZE - SECTOR_HEADER.size
+SECTOR_USED_MASK = 0x03FF
+FLUSH_REASONS = {0: "full", 1: "max age", 2: "readout", 3: "boot", 4: "session"}
+FLUSH_SESSION = 4
+LOG_CSV_HEADER = b"Muon#,Band,Date,Time\n"
+
+# Session header (sd_utils.h), the payload of the FLUSH_SESSION sector
+# each boot starts with: how the run that follows was set up
+SESSION = struct.Struct('<2sBBHH7sBHHB4sB4H3H3H2HH')
+SESSION_MAGIC = b"TS"
+SESSION_VERSION = 1
+SESSION_BOARDS = {1: "FR2355", 2: "FR6989"}
+SESSION_LOG_FRAM = 0x01
+SESSION_TLM_EVENTS = 0x02
+
+# Log ring metadata sector (log_manager.h): magic, version, policy,
+# capacity, head, tail, sequence number at the head, sessions, then the
+# first sector of each session, oldest first
+LOG_META_SECTOR = 0
+LOG_FIRST_SECTOR = 1
+LOG_META = struct.Struct('<2sBBIIIIH2x')
+LOG_META_MAGIC = b"TM"
+LOG_META_VERSION = 1
+LOG_META_SUM = SECTOR_SIZE - 2
+LOG_META_INTERVAL = 64
+LOG_SEQ_SLACK = 8
+LOG_POLICIES = {0: "stop", 1: "wrap"}
+
+# FRAM log dump (TIGR/src/TIGR/fram_log.h): a header block with
+# magic, version, record bytes used and capacity, records dropped; the
+# records follow from the second block
+FRAM_LOG_HEADER = struct.Struct('<2sBxIIH')
+FRAM_LOG_MAGIC = b"TF"
+FRAM_LOG_VERSION = 1
+FRAM_LOG_ANCHOR = ord('A')
+FRAM_LOG_LINE = ord('L')
+FRAM_LOG_SESSION = ord('S')
+
+def parse_log_meta(sector):
+    """Log ring metadata from the first card sector, None if it has none"""
+    if len(sector) < SECTOR_SIZE:
+        return None
+    magic, version, policy, capacity, head, tail, seq, sessions = LOG_META.unpack_from(sector)
+    if magic != LOG_META_MAGIC or version != LOG_META_VERSION:
+        return None
+    if sum(sector[:LOG_META_SUM]) & 0xFFFF != struct.unpack_from('<H', sector, LOG_META_SUM)[0]:
+        return None
+    return {'policy': LOG_POLICIES.get(policy, policy), 'capacity': capacity,
+            'head': head, 'tail': tail, 'seq': seq,
+            'sessions': list(struct.unpack_from(f'<{sessions}I', sector, LOG_META.size))}
+
+def parse_fram_header(block):
+    """FRAM log dump header from the first block, None if it is not one"""
+    if len(block) < FRAM_LOG_HEADER.size:
+        return None
+    magic, version, used, capacity, dropped = FRAM_LOG_HEADER.unpack_from(block)
+    if magic != FRAM_LOG_MAGIC or version != FRAM_LOG_VERSION or used > capacity:
+        return None
+    return {'used': used, 'capacity': capacity, 'dropped': dropped}
+
+def bcd(value):
+    return (value >> 4) * 10 + (value & 0x0F)
+
+def parse_session(payload):
+    """Session header from a session sector payload or FRAM record, None if it is not one"""
+    if len(payload) < SESSION.size:
+        return None
+    (magic, version, board, firmware, detector, rtc, policy, reset, muon, enable, prescale,
+     flags, *rest) = SESSION.unpack_from(payload)
+    if magic != SESSION_MAGIC or version != SESSION_VERSION:
+        return None
+    try:
+        start = datetime(bcd(rtc[1]) * 100 + bcd(rtc[0]), *(bcd(b) for b in rtc[2:]))
+    except ValueError:
+        start = None
+    return {'board': SESSION_BOARDS.get(board, f"board {board}"),
+            'firmware': f"{firmware >> 8}.{firmware & 0xFF}", 'detector': detector,
+            'start': start, 'log_policy': LOG_POLICIES.get(policy, policy),
+            'reset_cause': reset, 'muon_number': muon, 'enable': enable,
+            'prescale': list(prescale), 'log_fram': bool(flags & SESSION_LOG_FRAM),
+            'tlm_events': bool(flags & SESSION_TLM_EVENTS), 'holdoff_us': rest[0:4],
+            'flush': {'high_water': rest[4], 'max_age_s': rest[5], 'lookahead_s': rest[6]},
+            'histogram': {'bin_s': rest[7], 'enter_rate': rest[8], 'exit_rate': rest[9]},
+            'supply_mv': {'low': rest[10], 'ok': rest[11]}, 'hk_interval_s': rest[12]}
+
+def format_session(session):
+    """One line describing a session header"""
+    start = f"{session['start']:%Y-%m-%d %H:%M:%S}" if session['start'] else "no RTC"
+    prescale = ','.join(str(n) for n in session['prescale'])
+    holdoff = ','.join(str(us) for us in session['holdoff_us'])
+    return (f"{start}  {session['board']} fw {session['firmware']} detector "
+            f"{session['detector']}  reset 0x{session['reset_cause']:04X}  from muon "
+            f"{session['muon_number']}  bands 0x{session['enable']:X} 1 in {prescale} "
+            f"holdoff {holdoff} us  flush {session['flush']['max_age_s']} s  "
+            f"{session['log_policy']}{' FRAM' if session['log_fram'] else ''}")
+
+def decode_fram_log(data):
+    """
+    Turn a FRAM log dump into the text stream a card would hold: event
+    records become event lines, line records are copied as they are and
+    session records are left out.
+    Records past the used bytes in the header were still being written.
+    """
+    header = parse_fram_header(data)
+    records = data[SECTOR_SIZE:SECTOR_SIZE + header['used']]
+    stream = bytearray()
+    anchor = None
+    i = 0
+    while i < len(records):
+        kind = records[i]
+        if kind == FRAM_LOG_LINE and i + 2 <= len(records):
+            length = records[i + 1]
+            stream += records[i + 2:i + 2 + length]
+            i += 2 + length
+        elif kind == FRAM_LOG_SESSION and i + 2 <= len(records):
+            i += 2 + records[i + 1]   # See session_headers()
+        elif kind == FRAM_LOG_ANCHOR and i + 8 <= len(records):
+            year = bcd(records[i + 2]) * 100 + bcd(records[i + 1])
+            anchor = datetime(year, *(bcd(b) for b in records[i + 3:i + 8]))
+            i += 8
+        elif 1 <= kind <= 4 and i + 4 <= len(records):
+            offset = records[i + 1]
+            muon = struct.unpack_from('<H', records, i + 2)[0]
+            if anchor is not None:
+                stamp = anchor + timedelta(seconds=offset)
+                stream += f"{muon:05d},{kind},{stamp:%Y-%m-%d,%H:%M:%S}\n".encode('ascii')
+            i += 4
+        else:
+            break                  # Not a record: the dump is damaged from here
+    if header['dropped']:
+        print(f"FRAM log full: {header['dropped']} records dropped")  # Debug
+    return bytes(stream)
+
+def read_log(read):
+    """
+    Read the log sectors of a card, one bytes object per session, oldest
+    first. read(start, count) returns count sectors from start. Cards with
+    log ring metadata are read from the tail round to the head; older
+    cards are read as one session of DEFAULT_SECTORS from sector 0. A
+    FRAM log (read over the UART or a saved dump) is read up to its head
+    as one session.
+    """
+    first = read(LOG_META_SECTOR, 1)
+    fram = parse_fram_header(first)
+    if fram is not None:
+        print(f"FRAM log: {fram['used']} of {fram['capacity']} bytes")  # Debug
+        return [read(0, 1 + (fram['used'] + SECTOR_SIZE - 1) // SECTOR_SIZE)]
+    meta = parse_log_meta(first)
+    if meta is None:
+        return [read(0, DEFAULT_SECTORS)]
+    
+    def read_range(first, end):
+        return read(first, end - first) if end > first else b''
+    
+    def read_ring(first, end):
+        if first <= end:
+            return read_range(first, end)
+        return read_range(first, meta['capacity']) + read_range(LOG_FIRST_SECTOR, end)
+    
+    # The metadata is rewritten every LOG_META_INTERVAL sectors; sectors
+    # after the recorded head carry on its sequence numbers
+    ring = meta['capacity'] - LOG_FIRST_SECTOR
+    head = meta['head']
+    seq = meta['seq']
+    count = min(LOG_META_INTERVAL, (meta['tail'] + ring - head - 1) % ring)
+    end = head + count if head + count < meta['capacity'] else head + count - ring
+    newer = read_ring(head, end)
+    for offset in range(0, len(newer) - SECTOR_SIZE + 1, SECTOR_SIZE):
+        magic, sector_seq, used = SECTOR_HEADER.unpack_from(newer, offset)
+        if magic != SECTOR_MAGIC or not 0 <= sector_seq - seq < LOG_SEQ_SLACK:
+            break
+        seq = sector_seq + 1
+        head = head + 1 if head + 1 < meta['capacity'] else LOG_FIRST_SECTOR
+    print(f"Log ring: {meta['policy']} policy, {len(meta['sessions'])} sessions, "
+          f"tail {meta['tail']}, head {head} of {meta['capacity']} sectors")  # Debug
+    
+    bounds = meta['sessions'] + [head]
+    sessions = []
+    for first, end in zip(bounds, bounds[1:]):
+        sessions.append(read_ring(first, end))
+    return sessions
+
+def join_sessions(sessions):
+    """
+    Merge each session that does not start at sequence number 0 into the
+    one before it: the card was reinserted without a reset and the log
+    carries on. The oldest session may not start at 0 either, when the
+    ring has overwritten its beginning.
+    """
+    joined = []
+    for data in sessions:
+        if len(data) < SECTOR_SIZE:
+            continue
+        magic, seq, used = SECTOR_HEADER.unpack_from(data)
+        if joined and magic == SECTOR_MAGIC and seq != 0:
+            joined[-1] += data
+        else:
+            joined.append(bytes(data))
+    return joined
+
+
+def reassemble_log(data):
+    """
+    Join the payloads of framed log sectors back into one text stream.
+    Lines may continue from one sector into the next. The log ends at the
+    first sector without the magic or whose sequence number does not
+    increase (an older session further along the card). A skipped sequence
+    number is a lost sector; the line it cut is dropped, as is the
+    unfinished line at the end and, when the first sector is not sequence
+    number 0 (overwritten by the log ring), the partial line it starts with.
+    Session header sectors hold no text. Returns None for cards written before sectors were framed.
+    """
+    stream = bytearray()
+    last_seq = None
+    
+    for offset in range(0, len(data) - SECTOR_SIZE + 1, SECTOR_SIZE):
+        magic, seq, used = SECTOR_HEADER.unpack_from(data, offset)
+        reason = used >> 12
+        used &= SECTOR_USED_MASK
+        if magic != SECTOR_MAGIC or used > SECTOR_PAYLOAD:
+            break
+        if last_seq is not None and seq <= last_seq:
+            break
+        payload = data[offset + SECTOR_HEADER.size:offset + SECTOR_HEADER.size + used]
+        if reason == FLUSH_SESSION:
+            # Sectors before it end on a line, so nothing is cut
+            payload = b''
+        elif last_seq is None and seq != 0:
+            payload = payload[payload.find(b'\n') + 1:]
+        elif last_seq is not None and seq != last_seq + 1:
+            del stream[stream.rfind(b'\n') + 1:]
+            payload = payload[payload.find(b'\n') + 1:]
+        stream += payload
+        last_seq = seq
+    
+    if last_seq is None:
+        return None
+    # The end of the last line is still in the logger's RAM
+    return bytes(stream[:stream.rfind(b'\n') + 1])
+
+def flush_reasons(sessions):
+    """Count the framed log sectors by the reason they were written"""
+    counts = {}
+    for data in sessions:
+        last_seq = None
+        for offset in range(0, len(data) - SECTOR_SIZE + 1, SECTOR_SIZE):
+            magic, seq, used = SECTOR_HEADER.unpack_from(data, offset)
+            if magic != SECTOR_MAGIC or (last_seq is not None and seq <= last_seq):
+                break
+            reason = FLUSH_REASONS.get(used >> 12, f"reason {used >> 12}")
+            counts[reason] = counts.get(reason, 0) + 1
+            last_seq = seq
+    return counts
+
+def session_headers(sessions):
+    """
+    The session headers in log data read by read_log(), one per boot,
+    oldest first: from the session sectors of a card, or the session
+    records of a FRAM log dump.
+    """
+    headers = []
+    if sessions and parse_fram_header(sessions[0]) is not None:
+        data = sessions[0]
+        records = data[SECTOR_SIZE:SECTOR_SIZE + parse_fram_header(data)['used']]
+        i = 0
+        while i + 2 <= len(records):
+            kind = records[i]
+            if kind == FRAM_LOG_SESSION:
+                headers.append(parse_session(records[i + 2:i + 2 + records[i + 1]]))
+            if kind == FRAM_LOG_SESSION or kind == FRAM_LOG_LINE:
+                i += 2 + records[i + 1]
+            elif kind == FRAM_LOG_ANCHOR:
+                i += 8
+            elif 1 <= kind <= 4:
+                i += 4
+            else:
+                break
+        return [header for header in headers if header is not None]
+    for data in sessions:
+        for offset in range(0, len(data) - SECTOR_SIZE + 1, SECTOR_SIZE):
+            magic, seq, used = SECTOR_HEADER.unpack_from(data, offset)
+            if magic == SECTOR_MAGIC and used >> 12 == FLUSH_SESSION:
+                header = parse_session(data[offset + SECTOR_HEADER.size:offset + SECTOR_SIZE])
+                if header is not None:
+                    header['seq'] = seq
+                    headers.append(header)
+    return headers
+
+def index_sessions(read):
+    """
+    The session headers of a log without reading its events: on a card
+    with log ring metadata only the first sector of each session is read
+    (a boot starts a session with its header sector; a session opened by
+    reinserting the card has none). Other logs are read in full.
+    """
+    first = read(LOG_META_SECTOR, 1)
+    meta = parse_log_meta(first)
+    if meta is None:
+        return session_headers(read_log(read))
+    headers = []
+    for start in meta['sessions']:
+        headers += session_headers([read(start, 1)])
+    return headers
+
+def sectors_to_csv_lines(sessions):
+    """
+    Convert raw TIGR card sectors, one bytes object per session (see
+    read_log()) or a single one, to CSV lines (header first).
+    Shared by the raw disk and serial port sources.
+    """
+    if isinstance(sessions, (bytes, bytearray)):
+        sessions = [sessions]
+    
+    # A FRAM log dump is decoded; framed sectors are joined by sequence
+    # number; older cards are zero-padded text
+    streams = [reassemble_log(session) for session in join_sessions(sessions)]
+    if sessions and parse_fram_header(sessions[0]) is not None:
+        data = decode_fram_log(sessions[0])
+    elif streams and None not in streams:
+        data = b''.join(streams)
+        # A log ring that wrapped has overwritten the oldest header
+        if not data.startswith(LOG_CSV_HEADER):
+            data = LOG_CSV_HEADER + data
+    else:
+        data = b''.join(sessions)
+    
+    # Convert to text
+    text = data.decode('ascii', errors='ignore').replace('\x00', '')
+    
+    # Find CSV data
+    if "Muon#,Band" not in text:
+        raise ValueError("No TIGR data found on this device")
+    
+    # Extract CSV
+    start_idx = text.find("Muon#,Band")
+    csv_data = text[start_idx:]
+    
+    # Parse valid lines
+    lines = csv_data.split('\n')
+    valid_lines = []
+    
+    for line in lines:
+        if ',' in line and line.strip():
+            parts = line.split(',')
+            # Event lines have 4 fields (5 in pre-housekeeping logs),
+            # housekeeping lines start with "HK", histogram bins with "H",
+            # band settings with "PS"
+            if len(parts) >= 4 or 'Muon#' in line:
+                valid_lines.append(line)
+    
+    return valid_lines
+
+def file_reader(f):
+    """read(start, count) for read_log() over an open image or raw device"""
+    def read(start, count):
+        f.seek(start * SECTOR_SIZE)
+        return f.read(count * SECTOR_SIZE)
+    return read
+
+def count_detections(lines):
+    """
+    Detections in extracted CSV lines: the band counts of histogram bin
+    records ("H,Date,Time,Secs,B1,B2,B3,B4,Coinc[,C12,..,C1234]") plus each event line
+    weighted by the prescale of its band from the last band settings
+    record ("PS,Date,Time,Enable,N1,N2,N3,N4[,H1,H2,H3,H4]"). Reset records
+    ("RS,Date,Time,Cause") count nothing
+    """
+    count = 0
+    prescale = [1, 1, 1, 1]
+    for line in lines:
+        parts = line.split(',')
+        if parts[0] == 'H' and len(parts) >= 8:
+            count += sum(int(n) for n in parts[4:8])
+        elif parts[0] == 'PS' and len(parts) >= 8:
+            prescale = [max(int(n), 1) for n in parts[4:8]]
+        elif parts[0] not in ('HK', 'H', 'PS', 'RS') and 'Muon#' not in line:
+            band = int(parts[1]) if parts[1].strip().isdigit() else 0
+            count += prescale[band - 1] if 1 <= band <= 4 else 1
+    return count
 
 class TIGRExtractorGUI:
     def __init__(self, root):
@@ -127,6 +518,14 @@ class TIGRExtractorGUI:
         )
         refresh_btn.pack(side=tk.LEFT)
         
+        image_btn = tk.Button(
+            drive_frame,
+            text="Image...",
+            command=self.browse_image,
+            font=("Dubai", 10)
+        )
+        image_btn.pack(side=tk.LEFT, padx=(5, 0))
+        
         # Step 2: Output file
         step2_label = tk.Label(
             main_frame,
@@ -231,6 +630,12 @@ class TIGRExtractorGUI:
                             drives.append(display_text)
                             self.drive_map[display_text] = device_id
             
+            # TIGR boards on a serial port (read over UART, no admin needed)
+            for port in self.list_serial_ports():
+                display_text = f"{port} - TIGR over serial port"
+                drives.append(display_text)
+                self.drive_map[display_text] = SERIAL_PREFIX + port
+            
             self.drive_combo['values'] = drives
             if drives:
                 self.drive_combo.current(len(drives) - 1)  # Select last drive (usually SD card)
@@ -238,6 +643,28 @@ class TIGRExtractorGUI:
         except Exception as e:
             messagebox.showerror("Error", f"Could not list drives: {e}")
     
+    def list_serial_ports(self):
+        """List serial ports (pyserial when installed)"""
+        try:
+            from serial.tools import list_ports
+            return [p.device for p in list_ports.comports()]
+        except ImportError:
+            return []
+    
+    def browse_image(self):
+        """Add a card image file (dd dump, simulator card or FRAM log dump) as a source"""
+        filename = filedialog.askopenfilename(
+            filetypes=[("Card images", "*.img *.bin"), ("All files", "*.*")]
+        )
+        if filename:
+            display_text = f"{os.path.basename(filename)} - card image"
+            self.drive_map[display_text] = IMAGE_PREFIX + filename
+            values = list(self.drive_combo['values'])
+            if display_text not in values:
+                values.append(display_text)
+                self.drive_combo['values'] = values
+            self.drive_combo.set(display_text)
+    
     def browse_output(self):
         """Browse for output file location"""
         filename = filedialog.asksaveasfilename(
@@ -263,7 +690,12 @@ class TIGRExtractorGUI:
     
     def extract_data(self):
         """Extract data from SD card"""
-        if not self.is_admin:
+        drive_selection = self.drive_var.get()
+        device_id = self.drive_map.get(drive_selection, "")
+        from_serial = device_id.startswith(SERIAL_PREFIX)
+        from_image = device_id.startswith(IMAGE_PREFIX)
+        
+        if not self.is_admin and not from_serial and not from_image:
             messagebox.showwarning(
                 "Admin Required",
                 "Administrator privileges are required to read raw disk data.\n\n"
@@ -271,13 +703,10 @@ class TIGRExtractorGUI:
             )
             return
         
-        drive_selection = self.drive_var.get()
         if not drive_selection:
             messagebox.showwarning("No Drive", "Please select a drive first")
             return
         
-        # Get actual device ID from mapping
-        device_id = self.drive_map.get(drive_selection)
         if not device_id:
             messagebox.showerror("Error", "Could not determine device path")
             return
@@ -306,37 +735,27 @@ class TIGRExtractorGUI:
             
             print(f"Opening device: {device_path}")  # Debug
             
-            with open(device_path, 'rb') as device:
-                data = device.read(512 * 1000)  # Read 1000 sectors
+            if from_serial:
+                sessions = self.read_serial(device_path[len(SERIAL_PREFIX):])
+            elif from_image:
+                with open(device_path[len(IMAGE_PREFIX):], 'rb') as image:
+                    sessions = read_log(file_reader(image))
+            else:
+                with open(device_path, 'rb') as device:
+                    sessions = read_log(file_reader(device))
             
-            print(f"Read {len(data)} bytes")  # Debug
+            print(f"Read {sum(len(data) for data in sessions)} bytes")  # Debug
+            print(f"Sectors by flush reason: {flush_reasons(sessions)}")  # Debug
+            for header in session_headers(sessions):
+                print(f"Session: {format_session(header)}")  # Debug
             
-            # Convert to text
-            text = data.decode('ascii', errors='ignore').replace('\x00', '')
-            
-            # Find CSV data
-            if "Muon#,Band" not in text:
-                raise ValueError("No TIGR data found on this device")
-            
-            # Extract CSV
-            start_idx = text.find("Muon#,Band")
-            csv_data = text[start_idx:]
-            
-            # Parse valid lines
-            lines = csv_data.split('\n')
-            valid_lines = []
-            
-            for line in lines:
-                if ',' in line and line.strip():
-                    parts = line.split(',')
-                    if len(parts) >= 5 or 'Muon#' in line:
-                        valid_lines.append(line)
+            valid_lines = sectors_to_csv_lines(sessions)
             
             # Write to file
             with open(output_file, 'w') as f:
                 f.write('\n'.join(valid_lines))
             
-            count = len(valid_lines) - 1  # Exclude header
+            count = count_detections(valid_lines)
             
             self.status_label.config(
                 text=f"✅ Success! Extracted {count} readings",
@@ -374,6 +793,16 @@ class TIGRExtractorGUI:
         finally:
             self.extract_btn.config(state=tk.NORMAL)
     
+    def read_serial(self, port):
+        """Read the card through a running TIGR's UART"""
+        from tigr_uart_readout import read_card_log
+        
+        def progress(done, total):
+            self.status_label.config(text=f"Reading sector {done}/{total}...")
+            self.root.update()
+        
+        return read_card_log(port, progress=progress)
+    
     def open_analyzer(self, csv_file):
         """Open the web analyzer"""
         # Try auto-loading version first, fall back to regular
@@ -0,0 +1,301 @@
+#!/usr/bin/env python3
+"""
+TIGR Live Telemetry Receiver
+Decodes the COBS framed binary telemetry stream sent by the TIGR firmware
+over the back channel UART (see TIGR/src/TIGR/telemetry.h).
+
+Frame layout before COBS encoding:
+    [type][seq][payload ...][crc16 lo][crc16 hi]
+Frames are separated by 0x00 bytes. CRC16-CCITT (poly 0x1021, init 0xFFFF)
+covers type, seq and payload.
+
+Usage:
+    python tigr_telemetry.py /dev/ttyACM0 --csv tigr_data.csv
+    python tigr_telemetry.py /dev/pts/3          # pty stand-in for testing
+"""
+
+import argparse
+import os
+import struct
+import sys
+from collections import namedtuple
+
+# Frame types
+TYPE_EVENT = 0x01
+TYPE_HOUSEKEEPING = 0x02
+TYPE_STATS = 0x03
+TYPE_HISTOGRAM = 0x04
+TYPE_TRACE = 0x22
+
+# Band sets counted per coincidence in histogram bins, in payload order
+# (TIGR/src/TIGR/histogram.h)
+COINC_MASKS = ('12', '13', '23', '123', '14', '24', '124', '34', '134', '234', '1234')
+
+# Trace IDs (TIGR/src/*/trace.h)
+TRACE_NAMES = {
+    0x0101: 'MUON', 0x0102: 'READING_SAVED', 0x0103: 'STAGING_FULL',
+    0x0104: 'EVENT_DROPPED', 0x0105: 'LOG_MODE', 0x0106: 'RETRIGGER', 0x0201: 'SD_FLUSH',
+    0x0202: 'SD_WRITE_OK', 0x0203: 'SD_WRITE_FAIL', 0x0204: 'SD_NO_CARD',
+    0x0205: 'FLUSH_DEFERRED', 0x0206: 'SD_STATE', 0x0207: 'SD_HELD',
+    0x0208: 'LOG_OPEN', 0x0209: 'LOG_DROP', 0x020A: 'SD_RESCUED', 0x020B: 'SD_RESTORED',
+    0x020C: 'FRAM_FULL',
+    0x0301: 'HOUSEKEEPING', 0x0302: 'SUPPLY_MV', 0x0303: 'HIST_BIN', 0x0304: 'BAND_CONFIG',
+    0x0305: 'SUPPLY_LOW', 0x0306: 'SUPPLY_OK', 0x0307: 'RESET',
+    0x0401: 'READOUT_START', 0x0402: 'READOUT_DONE',
+}
+TRACE_TICK_HZ = 4096
+
+Frame = namedtuple('Frame', ['type', 'seq', 'fields'])
+
+
+def _make_crc_table():
+    table = []
+    for i in range(256):
+        crc = i << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+        table.append(crc & 0xFFFF)
+    return table
+
+
+_CRC_TABLE = _make_crc_table()
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    """CRC16-CCITT matching crc16_ccitt() in the firmware"""
+    for b in data:
+        crc = ((crc << 8) & 0xFFFF) ^ _CRC_TABLE[(crc >> 8) ^ b]
+    return crc
+
+
+def cobs_encode(data):
+    """COBS encode (used by tools and stand-ins that emulate the firmware)"""
+    out = bytearray(b'\x00')
+    code_index = 0
+    code = 1
+    for b in data:
+        if b == 0:
+            out[code_index] = code
+            code_index = len(out)
+            out.append(0)
+            code = 1
+        else:
+            out.append(b)
+            code += 1
+            if code == 0xFF:
+                out[code_index] = code
+                code_index = len(out)
+                out.append(0)
+                code = 1
+    out[code_index] = code
+    return bytes(out)
+
+
+def cobs_decode(data):
+    """COBS decode one frame (without delimiters). Raises ValueError if malformed."""
+    out = bytearray()
+    i = 0
+    n = len(data)
+    while i < n:
+        code = data[i]
+        if code == 0:
+            raise ValueError("zero byte inside COBS frame")
+        end = i + code
+        if end > n + 1:
+            raise ValueError("COBS block overruns frame")
+        out += data[i + 1:end]
+        i = end
+        if code != 0xFF and i < n:
+            out.append(0)
+    return bytes(out)
+
+
+def build_frame(frame_type, seq, payload):
+    """Build a delimited frame exactly as the firmware does"""
+    raw = bytes([frame_type, seq & 0xFF]) + bytes(payload)
+    raw += struct.pack('<H', crc16_ccitt(raw))
+    return b'\x00' + cobs_encode(raw) + b'\x00'
+
+
+def _bcd(value):
+    return (value >> 4) * 10 + (value & 0x0F)
+
+
+def _timestamp(p):
+    year_bcd = p[0] | (p[1] << 8)
+    year = _bcd(year_bcd >> 8) * 100 + _bcd(year_bcd & 0xFF)
+    return (f"{year:04d}-{_bcd(p[2]):02d}-{_bcd(p[3]):02d}",
+            f"{_bcd(p[4]):02d}:{_bcd(p[5]):02d}:{_bcd(p[6]):02d}")
+
+
+def parse_payload(frame_type, payload):
+    """Convert a frame payload to a dict of named fields"""
+    if frame_type == TYPE_EVENT and len(payload) >= 10:
+        muon, band = struct.unpack_from('<HB', payload, 0)
+        date, time = _timestamp(payload[3:10])
+        return {'muon': muon, 'band': band, 'date': date, 'time': time}
+    if frame_type == TYPE_HOUSEKEEPING and len(payload) >= 15:
+        date, time = _timestamp(payload[0:7])
+        temp, mv, dead, events = struct.unpack_from('<hHHH', payload, 7)
+        return {'date': date, 'time': time, 'temperature': temp,
+                'supply_mv': mv, 'dead_ms': dead, 'events': events}
+    if frame_type == TYPE_STATS and len(payload) >= 12:
+        muon, sector, staged, sd_ok, uart_drop, tlm_drop = \
+            struct.unpack_from('<HIBBHH', payload, 0)
+        return {'muon_count': muon, 'current_sector': sector,
+                'staged': staged, 'sd_initialized': sd_ok,
+                'uart_dropped': uart_drop, 'frames_dropped': tlm_drop}
+    if frame_type == TYPE_HISTOGRAM and len(payload) >= 19:
+        date, time = _timestamp(payload[0:7])
+        seconds, b1, b2, b3, b4, coinc = struct.unpack_from('<6H', payload, 7)
+        masks = ()
+        if len(payload) >= 19 + 2 * len(COINC_MASKS):
+            masks = struct.unpack_from(f'<{len(COINC_MASKS)}H', payload, 19)
+        return {'date': date, 'time': time, 'seconds': seconds,
+                'bands': (b1, b2, b3, b4), 'coincidence': coinc,
+                'coincidence_masks': dict(zip(COINC_MASKS, masks))}
+    if frame_type == TYPE_TRACE and len(payload) >= 2:
+        total = struct.unpack_from('<H', payload, 0)[0]
+        entries = [(TRACE_NAMES.get(i, f'0x{i:04X}'), tick, arg)
+                   for i, tick, arg in struct.iter_unpack('<HHH', payload[2:2 + (len(payload) - 2) // 6 * 6])]
+        return {'total': total, 'entries': entries}
+    return {'raw': bytes(payload)}
+
+
+def decode_frame(encoded):
+    """Decode one delimited-out frame. Returns a Frame or None if invalid."""
+    try:
+        raw = cobs_decode(encoded)
+    except ValueError:
+        return None
+    if len(raw) < 4:
+        return None
+    body, crc = raw[:-2], struct.unpack('<H', raw[-2:])[0]
+    if crc16_ccitt(body) != crc:
+        return None
+    return Frame(body[0], body[1], parse_payload(body[0], body[2:]))
+
+
+class TelemetryReceiver:
+    """Incremental decoder: feed() raw bytes, get Frames back"""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.last_seq = None
+        self.frames = 0
+        self.bad_frames = 0      # CRC/COBS failures (includes text output)
+        self.lost_frames = 0     # Gaps in the sequence number
+
+    def feed(self, data):
+        """Feed received bytes, return the list of complete valid frames"""
+        self.buffer += data
+        frames = []
+        start = 0
+        while True:
+            end = self.buffer.find(b'\x00', start)
+            if end < 0:
+                break
+            chunk = self.buffer[start:end]
+            start = end + 1
+            if not chunk:
+                continue
+            frame = decode_frame(bytes(chunk))
+            if frame is None:
+                self.bad_frames += 1
+                continue
+            if self.last_seq is not None:
+                self.lost_frames += (frame.seq - self.last_seq - 1) & 0xFF
+            self.last_seq = frame.seq
+            self.frames += 1
+            frames.append(frame)
+        del self.buffer[:start]
+        return frames
+
+
+def open_port(path, baud=115200):
+    """
+    Open a serial port or pty and return a file-like object with read().
+    Uses pyserial when installed, otherwise raw termios (Linux/macOS).
+    """
+    try:
+        import serial
+        return serial.Serial(path, baudrate=baud, timeout=0.1)
+    except ImportError:
+        pass
+
+    import termios
+    import tty
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    if os.isatty(fd):
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, f'B{baud}', termios.B115200)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return os.fdopen(fd, 'r+b', buffering=0)
+
+
+def receive(port, on_frame, chunk_size=4096):
+    """Read from port until EOF/KeyboardInterrupt, calling on_frame(frame)"""
+    receiver = TelemetryReceiver()
+    try:
+        while True:
+            data = port.read(chunk_size)
+            if not data:
+                if hasattr(port, 'in_waiting'):
+                    continue        # pyserial timeout, keep waiting
+                break               # EOF on pty/file
+            for frame in receiver.feed(data):
+                on_frame(frame)
+    except KeyboardInterrupt:
+        pass
+    return receiver
+
+
+class CSVWriter:
+    """Writes frames in the same CSV layout the extractor produces"""
+
+    def __init__(self, f):
+        self.f = f
+        self.f.write("Muon#,Band,Date,Time\n")
+
+    def __call__(self, frame):
+        d = frame.fields
+        if frame.type == TYPE_EVENT:
+            self.f.write(f"{d['muon']},{d['band']},{d['date']},{d['time']}\n")
+        elif frame.type == TYPE_HOUSEKEEPING:
+            self.f.write(f"HK,{d['date']},{d['time']},{d['temperature']},"
+                         f"{d['supply_mv']},{d['dead_ms']},{d['events']}\n")
+        elif frame.type == TYPE_HISTOGRAM:
+            bands = ",".join(str(n) for n in d['bands'])
+            masks = "".join(f",{n}" for n in d['coincidence_masks'].values())
+            self.f.write(f"H,{d['date']},{d['time']},{d['seconds']},{bands},"
+                         f"{d['coincidence']}{masks}\n")
+        self.f.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TIGR live telemetry receiver")
+    parser.add_argument('port', help="serial port or pty path")
+    parser.add_argument('--baud', type=int, default=115200)
+    parser.add_argument('--csv', help="write events and housekeeping to this CSV file")
+    args = parser.parse_args()
+
+    port = open_port(args.port, args.baud)
+    csv_file = open(args.csv, 'w') if args.csv else None
+    writer = CSVWriter(csv_file) if csv_file else None
+
+    def on_frame(frame):
+        if writer:
+            writer(frame)
+        print(f"[{frame.seq:3d}] type {frame.type}: {frame.fields}")
+
+    receiver = receive(port, on_frame)
+    if csv_file:
+        csv_file.close()
+    print(f"{receiver.frames} frames, {receiver.bad_frames} bad, "
+          f"{receiver.lost_frames} lost", file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,498 @@
+#!/usr/bin/env python3
+"""
+TIGR UART Card Readout
+Pulls raw SD card sectors from a running TIGR (FR6989) over the back channel
+UART, so the card does not have to be removed. Protocol in
+TIGR/src/TIGR/readout.h; framing shared with tigr_telemetry.py.
+
+Session:
+    PING -> PONG                  link check at 115200
+    SET_BAUD -> BAUD_ACK, PING    try the fastest rate first, fall back
+    READ -> SECTOR ... READ_DONE  host ACKs each in-order sector
+    SET_FLUSH -> FLUSH_POLICY     change or query the flush policy
+    SET_BANDS -> BANDS            change or query band enables, prescales and
+                                  retrigger holdoffs
+    SET_LOG -> LOG                change the log ring policy or query the ring
+    FRAM_LOG -> FRAM_LOG          query or empty the FRAM log (LOG_FRAM builds,
+                                  whose READ streams the FRAM log instead)
+
+Usage:
+    python tigr_uart_readout.py COM5 --sectors 1000 --csv tigr_data.csv
+    python tigr_uart_readout.py /dev/ttyACM0 --raw card.img --sectors 4096
+    python tigr_uart_readout.py COM5 --flush 48,600,120
+    python tigr_uart_readout.py COM5 --bands 15,10,1,1,1
+    python tigr_uart_readout.py COM5 --holdoff 100,100,100,100
+    python tigr_uart_readout.py COM5 --log wrap
+    python tigr_uart_readout.py COM5 --fram clear
+    python tigr_uart_readout.py COM5 --sessions
+"""
+
+import argparse
+import os
+import select
+import struct
+import sys
+import time
+
+from tigr_telemetry import (TRACE_TICK_HZ, TelemetryReceiver, build_frame,
+                            open_port)
+
+# Commands (host -> MCU)
+CMD_PING = 0x10
+CMD_SET_BAUD = 0x12
+CMD_READ = 0x14
+CMD_ACK = 0x15
+CMD_ABORT = 0x16
+CMD_TRACE_DUMP = 0x18
+CMD_SET_FLUSH = 0x1A
+CMD_SET_BANDS = 0x1C
+CMD_SET_LOG = 0x1E
+CMD_FRAM_LOG = 0x24
+
+# Responses (MCU -> host)
+TYPE_PONG = 0x11
+TYPE_BAUD_ACK = 0x13
+TYPE_FLUSH_POLICY = 0x1B
+TYPE_BANDS = 0x1D
+TYPE_LOG = 0x1F
+TYPE_SECTOR = 0x20
+TYPE_READ_DONE = 0x21
+TYPE_TRACE = 0x22
+TYPE_FRAM_LOG = 0x25
+
+DEFAULT_BAUD = 115200
+BAUD_RATES = (921600, 460800, 230400, 115200)
+DEFAULT_WINDOW = 8
+
+READ_STATUS = {0: "ok", 1: "aborted", 2: "ACK timeout", 3: "card error"}
+LOG_POLICIES = ("stop", "wrap")
+CARD_STATES = ("no card", "settling", "initializing", "ready", "failed", "full")
+
+
+class ReadoutError(Exception):
+    pass
+
+
+class ReadoutClient:
+    """Drives one readout session over an open port"""
+
+    def __init__(self, port, verbose=False):
+        self.port = port
+        self.receiver = TelemetryReceiver()
+        self.pending = []
+        self.seq = 0
+        self.verbose = verbose
+
+    def log(self, msg):
+        if self.verbose:
+            print(msg, file=sys.stderr)
+
+    def send(self, frame_type, payload=b''):
+        self.port.write(build_frame(frame_type, self.seq, payload))
+        self.seq = (self.seq + 1) & 0xFF
+        if hasattr(self.port, 'flush'):
+            self.port.flush()
+
+    def read(self, timeout=0.1):
+        """Read whatever is available within timeout (pyserial or raw fd)"""
+        if hasattr(self.port, 'in_waiting'):
+            return self.port.read(4096)
+        ready, _, _ = select.select([self.port], [], [], timeout)
+        return os.read(self.port.fileno(), 4096) if ready else b''
+
+    def frames(self, timeout):
+        """Yield frames until timeout seconds pass with nothing received"""
+        while self.pending:
+            yield self.pending.pop(0)
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            data = self.read()
+            if not data:
+                continue
+            deadline = time.monotonic() + timeout
+            self.pending.extend(self.receiver.feed(data))
+            while self.pending:
+                yield self.pending.pop(0)
+
+    def wait_for(self, types, timeout):
+        """Return the next frame whose type is in types, or None on timeout"""
+        deadline = time.monotonic() + timeout
+        for frame in self.frames(timeout):
+            if frame.type in types:
+                return frame
+            if time.monotonic() > deadline:
+                break
+        return None
+
+    def reset(self):
+        """Drop partial input after a baud rate change"""
+        self.receiver = TelemetryReceiver()
+        self.pending = []
+
+    def ping(self, timeout=1.0, token=b'TIGR'):
+        self.send(CMD_PING, token)
+        frame = self.wait_for((TYPE_PONG,), timeout)
+        return frame is not None and frame.fields.get('raw') == token
+
+    def set_port_baud(self, baud):
+        if hasattr(self.port, 'baudrate'):
+            self.port.baudrate = baud
+            return
+        import termios
+        fd = self.port.fileno()
+        attrs = termios.tcgetattr(fd)
+        attrs[4] = attrs[5] = getattr(termios, f'B{baud}')
+        termios.tcsetattr(fd, termios.TCSADRAIN, attrs)
+
+    def negotiate_baud(self, rates=BAUD_RATES):
+        """Switch to the fastest rate the link carries reliably"""
+        for baud in rates:
+            if baud == DEFAULT_BAUD:
+                return baud
+            self.send(CMD_SET_BAUD, struct.pack('<I', baud))
+            ack = self.wait_for((TYPE_BAUD_ACK,), 1.0)
+            if ack is None or ack.fields.get('raw', b'\x00')[:1] != b'\x01':
+                continue
+            time.sleep(0.05)                # let the MCU drain and switch
+            try:
+                self.set_port_baud(baud)
+            except (AttributeError, ValueError, OSError):
+                # Host UART cannot do this rate; MCU reverts on its own
+                time.sleep(1.2)
+                continue
+            self.reset()
+            if self.ping(0.5):
+                self.log(f"Link running at {baud} baud")
+                return baud
+            # MCU falls back after its 1 s timeout
+            self.set_port_baud(DEFAULT_BAUD)
+            time.sleep(1.2)
+            self.reset()
+            if not self.ping():
+                raise ReadoutError("lost contact after failed baud switch")
+        return DEFAULT_BAUD
+
+    def read_sectors(self, start=0, count=0, window=DEFAULT_WINDOW, progress=None):
+        """
+        Read count sectors from start (count 0 = up to the log head).
+        Returns the sector data as bytes, in order.
+        """
+        self.send(CMD_READ, struct.pack('<IIB', start, count, window))
+        data = bytearray()
+        received = 0
+        for frame in self.frames(3.0):
+            raw = frame.fields.get('raw', b'')
+            if frame.type == TYPE_SECTOR and len(raw) >= 4:
+                sector = struct.unpack_from('<I', raw)[0]
+                if sector != start + received:
+                    self.send(CMD_ABORT)
+                    raise ReadoutError(f"expected sector {start + received}, got {sector}")
+                data += raw[4:]
+                received += 1
+                self.send(CMD_ACK, struct.pack('<I', received))
+                if progress:
+                    progress(received, count)
+            elif frame.type == TYPE_READ_DONE and len(raw) >= 5:
+                status, sent = struct.unpack_from('<BI', raw)
+                if status != 0:
+                    raise ReadoutError(f"readout ended: {READ_STATUS.get(status, status)}")
+                if sent != received:
+                    raise ReadoutError(f"MCU sent {sent} sectors, received {received}")
+                return bytes(data)
+        raise ReadoutError("readout timed out")
+
+    def trace_dump(self, timeout=1.0):
+        """Fetch the firmware trace ring: (total recorded, [(name, tick, arg)])"""
+        self.send(CMD_TRACE_DUMP)
+        frame = self.wait_for((TYPE_TRACE,), timeout)
+        if frame is None:
+            raise ReadoutError("no trace response")
+        return frame.fields['total'], frame.fields['entries']
+
+    def flush_policy(self, policy=None, timeout=1.0):
+        """Set (high_water, max_age_s, lookahead_s) if given; return the
+        policy in effect and the logger's event rate estimate (events/s)"""
+        payload = struct.pack('<HHH', *policy) if policy else b''
+        self.send(CMD_SET_FLUSH, payload)
+        frame = self.wait_for((TYPE_FLUSH_POLICY,), timeout)
+        if frame is None or len(frame.fields['raw']) < 8:
+            raise ReadoutError("no flush policy response")
+        high_water, max_age, lookahead, rate = struct.unpack_from('<HHHH', frame.fields['raw'])
+        return {'high_water': high_water, 'max_age_s': max_age,
+                'lookahead_s': lookahead, 'event_rate': rate / 16.0}
+
+    def bands(self, settings=None, holdoff=None, timeout=1.0):
+        """Set (enable_mask, n1, n2, n3, n4) if given, and the holdoffs in
+        us (h1, h2, h3, h4) with them; return the band settings in effect
+        and the per-band counts and retriggers since the last housekeeping
+        record"""
+        payload = struct.pack('<5B', *settings) if settings else b''
+        if settings and holdoff:
+            payload += struct.pack('<4H', *holdoff)
+        self.send(CMD_SET_BANDS, payload)
+        frame = self.wait_for((TYPE_BANDS,), timeout)
+        if frame is None or len(frame.fields['raw']) < 13:
+            raise ReadoutError("no band settings response")
+        raw = frame.fields['raw']
+        values = struct.unpack_from('<5B4H', raw)
+        result = {'enable': values[0], 'prescale': values[1:5], 'counts': values[5:9],
+                  'holdoff': None, 'retriggers': None}
+        if len(raw) >= 29:
+            extra = struct.unpack_from('<4H4H', raw, 13)
+            result['holdoff'] = extra[0:4]
+            result['retriggers'] = extra[4:8]
+        return result
+
+    def log_ring(self, policy=None, timeout=1.0):
+        """Set the log ring policy (0 stop, 1 wrap) if given; return the
+        policy in effect, the card state and the ring positions"""
+        payload = bytes([policy]) if policy is not None else b''
+        self.send(CMD_SET_LOG, payload)
+        frame = self.wait_for((TYPE_LOG,), timeout)
+        if frame is None or len(frame.fields['raw']) < 22:
+            raise ReadoutError("no log ring response")
+        values = struct.unpack_from('<BBIIIHIH', frame.fields['raw'])
+        return dict(zip(('policy', 'state', 'capacity', 'head', 'tail', 'sessions',
+                         'free', 'hours_left'), values))
+
+    def fram_log(self, clear_used=None, timeout=1.0):
+        """Empty the FRAM log if it still holds clear_used bytes; return
+        its use and whether it was emptied"""
+        payload = struct.pack('<I', clear_used) if clear_used is not None else b''
+        self.send(CMD_FRAM_LOG, payload)
+        frame = self.wait_for((TYPE_FRAM_LOG,), timeout)
+        if frame is None or len(frame.fields['raw']) < 13:
+            raise ReadoutError("no FRAM log response (not a LOG_FRAM build?)")
+        values = struct.unpack_from('<IIHHB', frame.fields['raw'])
+        return dict(zip(('used', 'capacity', 'dropped', 'hours_left', 'emptied'), values))
+
+    def restore_baud(self):
+        """Put both ends back to 115200 so the next session can connect"""
+        self.send(CMD_SET_BAUD, struct.pack('<I', DEFAULT_BAUD))
+        self.wait_for((TYPE_BAUD_ACK,), 1.0)
+        time.sleep(0.05)
+        self.set_port_baud(DEFAULT_BAUD)
+        self.reset()
+        self.ping()
+
+
+def read_card(port_path, sectors=1000, start=0, window=DEFAULT_WINDOW,
+              negotiate=True, progress=None, verbose=False):
+    """Open port_path, read sectors from the TIGR card and return the bytes"""
+    port = open_port(port_path, DEFAULT_BAUD)
+    try:
+        client = ReadoutClient(port, verbose)
+        if not client.ping():
+            raise ReadoutError(f"no response from TIGR on {port_path}")
+        baud = client.negotiate_baud() if negotiate else DEFAULT_BAUD
+        try:
+            return client.read_sectors(start, sectors, window, progress)
+        finally:
+            if baud != DEFAULT_BAUD:
+                client.restore_baud()
+    finally:
+        port.close()
+
+
+def read_card_log(port_path, window=DEFAULT_WINDOW, negotiate=True, progress=None,
+                  verbose=False, extract=None):
+    """Open port_path and read the log on the TIGR card, one bytes object
+    per session (see read_log() in tigr_extractor_gui.py), or what
+    extract(read) takes from it"""
+    from tigr_extractor_gui import read_log
+    extract = extract or read_log
+    port = open_port(port_path, DEFAULT_BAUD)
+    try:
+        client = ReadoutClient(port, verbose)
+        if not client.ping():
+            raise ReadoutError(f"no response from TIGR on {port_path}")
+        baud = client.negotiate_baud() if negotiate else DEFAULT_BAUD
+        try:
+            return extract(lambda start, count: client.read_sectors(start, count, window, progress))
+        finally:
+            if baud != DEFAULT_BAUD:
+                client.restore_baud()
+    finally:
+        port.close()
+
+
+def print_trace(port_path):
+    """Print the trace ring with times relative to the oldest entry"""
+    port = open_port(port_path, DEFAULT_BAUD)
+    try:
+        client = ReadoutClient(port)
+        total, entries = client.trace_dump()
+    finally:
+        port.close()
+    print(f"{total} trace entries recorded, last {len(entries)}:")
+    elapsed = 0
+    previous = entries[0][1] if entries else 0
+    for name, tick, arg in entries:
+        # 16-bit tick; assumes consecutive entries are < 16 s apart
+        elapsed += (tick - previous) & 0xFFFF
+        previous = tick
+        print(f"  +{elapsed * 1000 / TRACE_TICK_HZ:9.1f} ms  {name:<14} {arg}")
+
+
+def flush_policy(port_path, policy=None):
+    """Set or query the flush policy and print the one in effect"""
+    port = open_port(port_path, DEFAULT_BAUD)
+    try:
+        result = ReadoutClient(port).flush_policy(policy)
+    finally:
+        port.close()
+    print(f"high water {result['high_water']} events, max age {result['max_age_s']} s, "
+          f"lookahead {result['lookahead_s']} s (event rate {result['event_rate']:.2f}/s)")
+
+
+def band_settings(port_path, settings=None, holdoff=None):
+    """Set or query the band enables, prescales and holdoffs and print them"""
+    port = open_port(port_path, DEFAULT_BAUD)
+    try:
+        client = ReadoutClient(port)
+        if holdoff and not settings:
+            # Holdoffs go with the band settings, keep the ones in effect
+            current = client.bands()
+            settings = (current['enable'],) + tuple(current['prescale'])
+        result = client.bands(settings, holdoff)
+    finally:
+        port.close()
+    for band in range(1, 5):
+        state = 'on ' if result['enable'] & (1 << (band - 1)) else 'off'
+        line = (f"band {band}: {state} 1 in {result['prescale'][band - 1]:<3} "
+                f"{result['counts'][band - 1]} since last HK")
+        if result['holdoff'] is not None:
+            line += (f", holdoff {result['holdoff'][band - 1]} us, "
+                     f"{result['retriggers'][band - 1]} retriggers")
+        print(line)
+
+
+def log_ring(port_path, policy=None):
+    """Set or query the log ring policy and print the ring"""
+    port = open_port(port_path, DEFAULT_BAUD)
+    try:
+        result = ReadoutClient(port).log_ring(policy)
+    finally:
+        port.close()
+    state = CARD_STATES[result['state']] if result['state'] < len(CARD_STATES) else result['state']
+    print(f"{LOG_POLICIES[result['policy']]} policy, card {state}, "
+          f"{result['sessions']} sessions, tail {result['tail']}, head {result['head']} "
+          f"of {result['capacity']} sectors")
+    print(f"{result['free']} sectors free, {result['hours_left']} h at the current rate")
+
+
+def fram_log(port_path, clear=False):
+    """Print the FRAM log use; with clear, empty it unless something was
+    logged since the query"""
+    port = open_port(port_path, DEFAULT_BAUD)
+    try:
+        client = ReadoutClient(port)
+        result = client.fram_log()
+        if clear:
+            result = client.fram_log(result['used'])
+    finally:
+        port.close()
+    print(f"FRAM log {result['used']} of {result['capacity']} bytes, "
+          f"{result['dropped']} records dropped, {result['hours_left']} h at the current rate")
+    if clear:
+        print("emptied" if result['emptied'] else "not emptied: new records arrived, try again")
+
+
+def list_sessions(port_path, window=DEFAULT_WINDOW, negotiate=True):
+    """Print one line per boot from the session headers, reading only the
+    first sector of each session"""
+    from tigr_extractor_gui import format_session, index_sessions
+    headers = read_card_log(port_path, window, negotiate, extract=index_sessions)
+    for n, header in enumerate(headers, 1):
+        print(f"{n:3}  {format_session(header)}")
+    if not headers:
+        print("no session headers: the log predates them")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TIGR SD card readout over UART")
+    parser.add_argument('port', help="serial port (COM5, /dev/ttyACM0)")
+    parser.add_argument('--start', type=int, default=0, help="first sector")
+    parser.add_argument('--sectors', type=int, default=0,
+                        help="sectors to read (0 = up to the log head); without "
+                             "--start or --sectors the log ring is read session by session")
+    parser.add_argument('--window', type=int, default=DEFAULT_WINDOW,
+                        help="unacknowledged sectors in flight")
+    parser.add_argument('--no-baud', action='store_true',
+                        help="stay at 115200")
+    parser.add_argument('--raw', help="write the raw sectors from --start to this file")
+    parser.add_argument('--csv', help="write extracted CSV to this file")
+    parser.add_argument('--trace', action='store_true',
+                        help="print the firmware trace ring and exit")
+    parser.add_argument('--flush', nargs='?', const='', metavar="HW,AGE,LOOKAHEAD",
+                        help="set the flush policy (high water events, max age s, "
+                             "lookahead s), or print it when no value is given, and exit")
+    parser.add_argument('--bands', nargs='?', const='', metavar="MASK,N1,N2,N3,N4",
+                        help="set the band enable mask and prescales (log 1 in N), "
+                             "or print them when no value is given, and exit")
+    parser.add_argument('--holdoff', metavar="US1,US2,US3,US4",
+                        help="set the retrigger holdoff of each band in us (0 = off), "
+                             "with --bands or keeping the band settings in effect, and exit")
+    parser.add_argument('--log', nargs='?', const='', choices=('', *LOG_POLICIES),
+                        help="set the log ring policy, or print the ring and the card "
+                             "time left when no value is given, and exit")
+    parser.add_argument('--fram', nargs='?', const='', choices=('', 'clear'),
+                        help="print the FRAM log use (LOG_FRAM builds), or empty it "
+                             "after a readout with 'clear', and exit")
+    parser.add_argument('--sessions', action='store_true',
+                        help="list the runs on the card from their session headers and exit")
+    args = parser.parse_args()
+
+    if args.trace:
+        print_trace(args.port)
+        return
+    if args.flush is not None:
+        policy = tuple(int(v) for v in args.flush.split(',')) if args.flush else None
+        if policy is not None and len(policy) != 3:
+            parser.error("--flush takes three values: HW,AGE,LOOKAHEAD")
+        flush_policy(args.port, policy)
+        return
+    if args.bands is not None or args.holdoff:
+        settings = tuple(int(v) for v in args.bands.split(',')) if args.bands else None
+        if settings is not None and (len(settings) != 5 or not all(0 <= v <= 255 for v in settings)):
+            parser.error("--bands takes five values 0-255: MASK,N1,N2,N3,N4")
+        holdoff = tuple(int(v) for v in args.holdoff.split(',')) if args.holdoff else None
+        if holdoff is not None and (len(holdoff) != 4 or not all(0 <= v <= 50000 for v in holdoff)):
+            parser.error("--holdoff takes four values 0-50000: US1,US2,US3,US4")
+        band_settings(args.port, settings, holdoff)
+        return
+    if args.log is not None:
+        log_ring(args.port, LOG_POLICIES.index(args.log) if args.log else None)
+        return
+    if args.fram is not None:
+        fram_log(args.port, args.fram == 'clear')
+        return
+    if args.sessions:
+        list_sessions(args.port, args.window, not args.no_baud)
+        return
+
+    def progress(done, total):
+        print(f"\r{done}/{total or '?'} sectors", end='', file=sys.stderr)
+
+    began = time.monotonic()
+    if args.raw or args.start or args.sectors:
+        sessions = [read_card(args.port, args.sectors, args.start, args.window,
+                              not args.no_baud, progress, verbose=True)]
+    else:
+        sessions = read_card_log(args.port, args.window, not args.no_baud, progress, verbose=True)
+    elapsed = time.monotonic() - began
+    size = sum(len(data) for data in sessions)
+    print(f"\n{size // 512} sectors in {elapsed:.1f} s "
+          f"({size / max(elapsed, 1e-6) / 1024:.1f} KiB/s)", file=sys.stderr)
+
+    if args.raw:
+        with open(args.raw, 'wb') as f:
+            f.write(sessions[0])
+    if args.csv:
+        from tigr_extractor_gui import sectors_to_csv_lines
+        with open(args.csv, 'w') as f:
+            f.write('\n'.join(sectors_to_csv_lines(sessions)))
+
+
+if __name__ == '__main__':
+    main()